@@ -0,0 +1,754 @@
+// -------------------------- includes -------------------------
+
+#include "GenericDFSInternal.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -------------------------- macros -------------------------
+
+//-----conflict sets, see BackjumpSearch.
+//number of levels a conflict set word holds.
+#define SET_WORD_BITS 64
+//number of levels the conflict sets have room for before they first grow; they double whenever
+//they are full.
+#define INITIAL_SET_LEVELS 64
+
+//-----learned nogoods, see NogoodStore.
+//the largest number of moves of a learned nogood; longer ones are seldom completed again, and
+//are not learned.
+#define MAX_NOGOOD_MOVES 8
+
+//-----move tables, see MoveTable.
+//number of slots of a table before it first grows; it doubles whenever it is half full.
+#define INITIAL_TABLE_SLOTS 64
+//value of an empty slot of a table, and the end of a list of nogood slots.
+#define NO_ENTRY SIZE_MAX
+//multiplier spreading the moves over the slots (Fibonacci hashing), and the number of low bits
+//of the product dropped.
+#define MOVE_HASH_MULTIPLIER 0x9e3779b97f4a7c15ULL
+#define MOVE_HASH_SHIFT 32
+
+// -------------------------- structs -------------------------
+
+/**
+ * @brief An open addressing table from moves to values, probed linearly.
+ */
+typedef struct MoveTable
+{
+    Move* keys;
+    //the value of every slot; NO_ENTRY if the slot is empty.
+    size_t* values;
+    //the number of slots, a power of two, minus one; the table has no slots while it is empty.
+    size_t mask;
+    size_t count;
+} MoveTable;
+
+/**
+ * @brief The nogoods a search learned: sets of moves that lead to no node with the best value
+ * once they are all applied, whatever else is. Nogood g takes the MAX_NOGOOD_MOVES move slots
+ * from g * MAX_NOGOOD_MOVES, of which it uses lengths[g]; the slots holding each move are listed
+ * by the index, so the nogoods a move may complete are found without scanning the others.
+ */
+typedef struct NogoodStore
+{
+    Move* moves;
+    unsigned char* lengths;
+    size_t count;
+    size_t capacity;
+    //the first slot holding each move, and for every slot the next one holding the same move.
+    MoveTable index;
+    size_t* nextSlot;
+} NogoodStore;
+
+/**
+ * @brief The state of a single backjumping search. Besides the moves of a level, the search
+ * keeps its conflict set: the earlier levels whose moves, as far as the level's dead ends were
+ * explained, are to blame for them. Level l's set is a bitset of setWords words, starting at
+ * sets + l * setWords.
+ */
+typedef struct BackjumpSearch
+{
+    getNodeMovesFunc getMoves;
+    applyMoveFunc applyMove;
+    undoMoveFunc undoMove;
+    explainConflictFunc explainConflict;
+    getNodeValFunc getVal;
+    freeNodeFunc freeNode;
+    copyNodeFunc copy;
+    unsigned int best;
+    MoveStack stack;
+    pNode bestCandidate;
+    unsigned int bestVal;
+    DfsStats* stats;
+    //the search's budget; NULL for no limits.
+    SearchBudget* budget;
+    //the subtrees known to hold no node with the best value; NULL for no table.
+    TranspositionTable* table;
+    uint64_t* sets;
+    size_t setWords;
+    //the number of levels the sets, and the scratch space for the ages of an explanation, have
+    //room for.
+    size_t setLevels;
+    unsigned int* ages;
+    //with learned nogoods: the nogoods, and the level each move on the current path was applied
+    //on; NULL for none.
+    NogoodStore* nogoods;
+    MoveTable path;
+} BackjumpSearch;
+
+// -------------------------- move tables -------------------------
+
+/**
+ * @brief return the first slot the given move is looked for at in the given table.
+ * @param table the given table; must have slots.
+ * @param move the given move.
+ * @return the slot.
+ */
+static size_t homeSlot(const MoveTable* table, Move move)
+{
+    return (size_t)(((unsigned long long)move * MOVE_HASH_MULTIPLIER) >> MOVE_HASH_SHIFT) &
+           table->mask;
+}
+
+/**
+ * @brief looks the given move up in the given table.
+ * @param table the given table.
+ * @param move the given move.
+ * @return the move's value, or NULL if the table does not hold it.
+ */
+static size_t* findMove(const MoveTable* table, Move move)
+{
+    if (table->count == 0)
+    {
+        return NULL;
+    }
+    for (size_t slot = homeSlot(table, move); table->values[slot] != NO_ENTRY;
+         slot = (slot + 1) & table->mask)
+    {
+        if (table->keys[slot] == move)
+        {
+            return &table->values[slot];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief puts the given move in the given table, which has room for it, or sets its value if the
+ * table already holds it.
+ * @param table the given table.
+ * @param move the given move.
+ * @param value the move's value.
+ */
+static void placeMove(MoveTable* table, Move move, size_t value)
+{
+    size_t slot = homeSlot(table, move);
+    while (table->values[slot] != NO_ENTRY && table->keys[slot] != move)
+    {
+        slot = (slot + 1) & table->mask;
+    }
+    if (table->values[slot] == NO_ENTRY)
+    {
+        table->count++;
+    }
+    table->keys[slot] = move;
+    table->values[slot] = value;
+}
+
+/**
+ * @brief makes room for the given number of moves in the given table, doubling it until it would
+ * be at most half full.
+ * @param table the given table.
+ * @param count the given number.
+ * @return TRUE on success; FALSE if allocation failed, in which case the table is unchanged.
+ */
+static int reserveTable(MoveTable* table, size_t count)
+{
+    size_t slots = table->values == NULL ? 0 : table->mask + 1;
+    size_t grown = slots ? slots : INITIAL_TABLE_SLOTS;
+    while (2 * count > grown)
+    {
+        grown *= 2;
+    }
+    if (grown == slots)
+    {
+        return TRUE;
+    }
+    MoveTable larger = {(Move*)malloc(grown * sizeof(Move)),
+                        (size_t*)malloc(grown * sizeof(size_t)), grown - 1, 0};
+    if (larger.keys == NULL || larger.values == NULL)
+    {
+        free(larger.keys);
+        free(larger.values);
+        return FALSE;
+    }
+    memset(larger.values, 0xff, grown * sizeof(size_t));
+    for (size_t slot = 0; slot < slots; slot++)
+    {
+        if (table->values[slot] != NO_ENTRY)
+        {
+            placeMove(&larger, table->keys[slot], table->values[slot]);
+        }
+    }
+    free(table->keys);
+    free(table->values);
+    *table = larger;
+    return TRUE;
+}
+
+/**
+ * @brief puts the given move in the given table, or sets its value if the table already holds
+ * it, growing the table first if it is half full.
+ * @param table the given table.
+ * @param move the given move.
+ * @param value the move's value.
+ * @return TRUE on success; FALSE if allocation failed, in which case the table is unchanged.
+ */
+static int insertMove(MoveTable* table, Move move, size_t value)
+{
+    if (!reserveTable(table, table->count + 1))
+    {
+        return FALSE;
+    }
+    placeMove(table, move, value);
+    return TRUE;
+}
+
+/**
+ * @brief removes the given move, which the given table holds, from it. The moves probed past its
+ * slot are put back, so that none of them is cut off from its home slot.
+ * @param table the given table.
+ * @param move the given move.
+ */
+static void removeMove(MoveTable* table, Move move)
+{
+    size_t slot = homeSlot(table, move);
+    while (table->values[slot] == NO_ENTRY || table->keys[slot] != move)
+    {
+        slot = (slot + 1) & table->mask;
+    }
+    table->values[slot] = NO_ENTRY;
+    table->count--;
+    for (slot = (slot + 1) & table->mask; table->values[slot] != NO_ENTRY;
+         slot = (slot + 1) & table->mask)
+    {
+        size_t value = table->values[slot];
+        table->values[slot] = NO_ENTRY;
+        table->count--;
+        placeMove(table, table->keys[slot], value);
+    }
+}
+
+/**
+ * @brief releases the memory of the given table and empties it.
+ * @param table the given table.
+ */
+static void freeMoveTable(MoveTable* table)
+{
+    free(table->keys);
+    free(table->values);
+    memset(table, 0, sizeof(MoveTable));
+}
+
+// -------------------------- nogoods -------------------------
+
+/**
+ * @brief creates an empty store for the given number of nogoods.
+ * @param capacity the given number.
+ * @return the new store, or NULL if allocation failed.
+ */
+static NogoodStore* newNogoodStore(size_t capacity)
+{
+    NogoodStore* store = (NogoodStore*)calloc(1, sizeof(NogoodStore));
+    if (store == NULL)
+    {
+        return NULL;
+    }
+    store->capacity = capacity;
+    store->moves = (Move*)malloc(capacity * MAX_NOGOOD_MOVES * sizeof(Move));
+    store->lengths = (unsigned char*)malloc(capacity);
+    store->nextSlot = (size_t*)malloc(capacity * MAX_NOGOOD_MOVES * sizeof(size_t));
+    if (store->moves == NULL || store->lengths == NULL || store->nextSlot == NULL)
+    {
+        free(store->moves);
+        free(store->lengths);
+        free(store->nextSlot);
+        free(store);
+        return NULL;
+    }
+    return store;
+}
+
+/**
+ * @brief releases the given store.
+ * @param store the given store; may be NULL.
+ */
+static void freeNogoodStore(NogoodStore* store)
+{
+    if (store == NULL)
+    {
+        return;
+    }
+    freeMoveTable(&store->index);
+    free(store->moves);
+    free(store->lengths);
+    free(store->nextSlot);
+    free(store);
+}
+
+// -------------------------- conflict sets -------------------------
+
+/**
+ * @brief return the conflict set of the given level of the given search.
+ * @param search the given search.
+ * @param level the given level.
+ * @return the set.
+ */
+static uint64_t* conflictSet(const BackjumpSearch* search, size_t level)
+{
+    return search->sets + level * search->setWords;
+}
+
+/**
+ * @brief adds the given level to the given conflict set.
+ * @param set the given set.
+ * @param level the given level.
+ */
+static void addToSet(uint64_t* set, size_t level)
+{
+    set[level / SET_WORD_BITS] |= (uint64_t)1 << (level % SET_WORD_BITS);
+}
+
+/**
+ * @brief makes room for the conflict sets of the given number of levels, and for the ages of an
+ * explanation at any of them. Growing the sets keeps the ones the search already has.
+ * @param search the given search.
+ * @param numLevels the given number of levels.
+ * @return TRUE on success; FALSE if allocation failed.
+ */
+static int reserveSets(BackjumpSearch* search, size_t numLevels)
+{
+    if (numLevels <= search->setLevels)
+    {
+        return TRUE;
+    }
+    size_t levels = search->setLevels ? search->setLevels : INITIAL_SET_LEVELS;
+    while (levels < numLevels)
+    {
+        levels *= 2;
+    }
+    //a set holds the levels above its own, so the last level's set bounds the words of all.
+    size_t words = (levels + SET_WORD_BITS - 1) / SET_WORD_BITS;
+    uint64_t* sets = (uint64_t*)calloc(levels * words, sizeof(uint64_t));
+    unsigned int* ages = (unsigned int*)malloc(levels * sizeof(unsigned int));
+    if (sets == NULL || ages == NULL)
+    {
+        free(sets);
+        free(ages);
+        return FALSE;
+    }
+    for (size_t level = 0; level < search->setLevels; level++)
+    {
+        memcpy(sets + level * words, conflictSet(search, level),
+               search->setWords * sizeof(uint64_t));
+    }
+    free(search->sets);
+    free(search->ages);
+    search->sets = sets;
+    search->setWords = words;
+    search->setLevels = levels;
+    search->ages = ages;
+    return TRUE;
+}
+
+/**
+ * @brief asks the search's client to explain a dead end at the given level, and adds the levels
+ * whose moves it blames to the level's conflict set; every level above it if the client cannot
+ * explain it.
+ * @param search the given search.
+ * @param node the node the moves were applied to, on the given level.
+ * @param level the given level.
+ * @param rejected the move the node rejected, or NULL, see explainConflictFunc.
+ */
+static void explainDeadEnd(BackjumpSearch* search, pNode node, size_t level, const Move* rejected)
+{
+    uint64_t* set = conflictSet(search, level);
+    int numAges = search->explainConflict(node, rejected, search->ages, (unsigned int)level);
+    if (numAges < 0)
+    {
+        for (size_t above = 0; above < level; above++)
+        {
+            addToSet(set, above);
+        }
+        return;
+    }
+    //the move of age a was applied on the a'th level above.
+    for (int i = 0; i < numAges; i++)
+    {
+        if (search->ages[i] > 0 && search->ages[i] <= level)
+        {
+            addToSet(set, level - search->ages[i]);
+        }
+    }
+}
+
+// -------------------------- search -------------------------
+
+/**
+ * @brief return the move applied on the given level to reach the level below it.
+ * @param search the given search.
+ * @param level the given level; not the deepest one on the path.
+ * @return the move.
+ */
+static Move appliedMove(const BackjumpSearch* search, size_t level)
+{
+    return search->stack.moves[search->stack.levels[level].next - 1];
+}
+
+/**
+ * @brief pops the deepest level of the given search, undoing the move that led to it, if any.
+ * @param search the given search.
+ * @param node the node the moves were applied to.
+ */
+static void popPathLevel(BackjumpSearch* search, pNode node)
+{
+    size_t numLevels = search->stack.numLevels;
+    if (search->nogoods != NULL && numLevels > 1)
+    {
+        removeMove(&search->path, appliedMove(search, numLevels - 2));
+    }
+    popLevel(&search->stack, node, search->undoMove);
+}
+
+/**
+ * @brief checks whether the given move, just applied on the given level and recorded on the
+ * search's path, completes one of the search's nogoods. If it does, the levels the other moves
+ * of the nogood were applied on are added to the level's conflict set.
+ * @param search the given search; learns nogoods.
+ * @param move the given move.
+ * @param level the given level.
+ * @return TRUE if the move completes a nogood; FALSE otherwise.
+ */
+static int completesNogood(BackjumpSearch* search, Move move, size_t level)
+{
+    NogoodStore* store = search->nogoods;
+    const size_t* first = findMove(&store->index, move);
+    for (size_t slot = first != NULL ? *first : NO_ENTRY; slot != NO_ENTRY;
+         slot = store->nextSlot[slot])
+    {
+        size_t nogood = slot / MAX_NOGOOD_MOVES;
+        const Move* moves = store->moves + nogood * MAX_NOGOOD_MOVES;
+        unsigned int i = 0;
+        while (i < store->lengths[nogood] && findMove(&search->path, moves[i]) != NULL)
+        {
+            i++;
+        }
+        if (i < store->lengths[nogood])
+        {
+            continue;
+        }
+        for (i = 0; i < store->lengths[nogood]; i++)
+        {
+            if (moves[i] != move)
+            {
+                addToSet(conflictSet(search, level), *findMove(&search->path, moves[i]));
+            }
+        }
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/**
+ * @brief learns the nogood behind the given level, which ran out of moves: the moves applied on
+ * the levels of its conflict set, if there are at most MAX_NOGOOD_MOVES of them and the store has
+ * room. Nothing is learned if allocation fails; nogoods only speed the search up.
+ * @param search the given search; learns nogoods.
+ * @param level the given level.
+ */
+static void learnNogood(BackjumpSearch* search, size_t level)
+{
+    NogoodStore* store = search->nogoods;
+    if (store->count == store->capacity)
+    {
+        return;
+    }
+    const uint64_t* set = conflictSet(search, level);
+    Move* moves = store->moves + store->count * MAX_NOGOOD_MOVES;
+    unsigned int length = 0;
+    for (size_t above = 0; above < level; above++)
+    {
+        if (set[above / SET_WORD_BITS] & ((uint64_t)1 << (above % SET_WORD_BITS)))
+        {
+            if (length == MAX_NOGOOD_MOVES)
+            {
+                return;
+            }
+            moves[length++] = appliedMove(search, above);
+        }
+    }
+    //with room for every move reserved up front, the nogood is either learned whole or not at all.
+    if (length == 0 || !reserveTable(&store->index, store->index.count + length))
+    {
+        return;
+    }
+    for (unsigned int i = 0; i < length; i++)
+    {
+        size_t slot = store->count * MAX_NOGOOD_MOVES + i;
+        const size_t* first = findMove(&store->index, moves[i]);
+        store->nextSlot[slot] = first != NULL ? *first : NO_ENTRY;
+        placeMove(&store->index, moves[i], slot);
+    }
+    store->lengths[store->count++] = (unsigned char)length;
+}
+
+/**
+ * @brief jumps back from the given level, which ran out of moves, to the deepest level of its
+ * conflict set, which inherits the rest of the set; the levels in between are popped. If the set
+ * is empty, no move of the search is to blame, and every level is popped.
+ * @param search the given search.
+ * @param node the node the moves were applied to.
+ * @param level the given level, the deepest one on the path.
+ */
+static void jumpBack(BackjumpSearch* search, pNode node, size_t level)
+{
+    const uint64_t* set = conflictSet(search, level);
+    size_t target = 0;
+    int found = FALSE;
+    for (size_t word = (level + SET_WORD_BITS - 1) / SET_WORD_BITS; word > 0 && !found; word--)
+    {
+        if (set[word - 1] != 0)
+        {
+            target = (word - 1) * SET_WORD_BITS + (SET_WORD_BITS - 1) -
+                     (size_t)__builtin_clzll(set[word - 1]);
+            found = TRUE;
+        }
+    }
+
+    size_t keep = found ? target + 1 : 0;
+    if (found)
+    {
+        uint64_t* targetSet = conflictSet(search, target);
+        for (size_t word = 0; word <= target / SET_WORD_BITS; word++)
+        {
+            targetSet[word] |= set[word];
+        }
+        targetSet[target / SET_WORD_BITS] &= ~((uint64_t)1 << (target % SET_WORD_BITS));
+    }
+    ADD_STAT(search->stats, backtracks, search->stack.numLevels - keep);
+    ADD_STAT(search->stats, backjumps, search->stack.numLevels - keep - 1);
+    while (search->stack.numLevels > keep)
+    {
+        popPathLevel(search, node);
+    }
+}
+
+/**
+ * @brief visits the current state of the given node: updates the best candidate of the search,
+ * and pushes a level holding the moves of the node unless it has the best value, the search's
+ * budget is exhausted or the state is known to be dead. The new level's conflict set starts out
+ * empty.
+ * @param search the given search.
+ * @param node the given node.
+ * @param depth the level of the node's current state.
+ * @param dead for the result: TRUE if the state is not expanded because the transposition table
+ * knows its subtree holds no node with the best value, FALSE otherwise.
+ * @return SUCCESS_EXIT, or ERROR in case of an error, in which case no level is pushed.
+ */
+static int visitState(BackjumpSearch* search, pNode node, size_t depth, int* dead)
+{
+    *dead = FALSE;
+    if (chargeNode(search->budget))
+    {
+        return SUCCESS_EXIT;
+    }
+    ADD_STAT(search->stats, nodes, 1);
+    ADD_STAT(search->stats, explored, depth > 0);
+    MAX_STAT(search->stats, maxDepth, (unsigned int)depth);
+    unsigned int val = search->getVal(node);
+    if (val > search->bestVal)
+    {
+        ADD_STAT(search->stats, copies, 1);
+        pNode newCandidate = search->copy(node);
+        if (newCandidate == NULL)
+        {
+            return ERROR;
+        }
+        search->freeNode(search->bestCandidate);
+        search->bestCandidate = newCandidate;
+        search->bestVal = val;
+    }
+    if (val == search->best)
+    {
+        return SUCCESS_EXIT;
+    }
+    if (isDeadNode(search->table, node))
+    {
+        ADD_STAT(search->stats, transpositions, 1);
+        *dead = TRUE;
+        return SUCCESS_EXIT;
+    }
+
+    if (!reserveSets(search, depth + 1))
+    {
+        return ERROR;
+    }
+    MoveLevel* level = pushLevel(&search->stack);
+    if (level == NULL)
+    {
+        return ERROR;
+    }
+    int numMoves = search->getMoves(node, search->stack.moves + level->base);
+    if (numMoves < 0)
+    {
+        search->stack.numLevels--;
+        return ERROR;
+    }
+    ADD_STAT(search->stats, generated, (unsigned int)numMoves);
+    level->end = level->base + (size_t)numMoves;
+    memset(conflictSet(search, depth), 0, search->setWords * sizeof(uint64_t));
+    return SUCCESS_EXIT;
+}
+
+/**
+ * @brief searches the tree rooted at the current state of the given node like searchInPlace(),
+ * but once a level runs out of moves, jumps back to the deepest level its conflict set blames.
+ * The node is back in its current state when the function returns.
+ * @param search the given search; its stack holds no level.
+ * @param node the given node.
+ * @return SUCCESS_EXIT, or ERROR in case of an error.
+ */
+static int searchJumping(BackjumpSearch* search, pNode node)
+{
+    MoveStack* stack = &search->stack;
+    int dead;
+    int rc = visitState(search, node, 0, &dead);
+    while (rc == SUCCESS_EXIT && stack->numLevels > 0)
+    {
+        size_t top = stack->numLevels - 1;
+        MoveLevel* level = &stack->levels[top];
+        int exhausted = search->budget != NULL && search->budget->exhausted;
+        //a level left because the search is over, or its budget ran out, is not backtracked from.
+        if (search->bestVal == search->best || exhausted)
+        {
+            popPathLevel(search, node);
+            continue;
+        }
+        if (level->next == level->end)
+        {
+            //the node is back in the state its moves were listed in, so the levels to blame for
+            //the moves it does not have are only looked for now, and never for the levels that
+            //are jumped over.
+            explainDeadEnd(search, node, top, NULL);
+            addDeadNode(search->table, node);
+            if (search->nogoods != NULL)
+            {
+                learnNogood(search, top);
+            }
+            jumpBack(search, node, top);
+            continue;
+        }
+
+        Move move = stack->moves[level->next++];
+        int applied = search->applyMove(node, move);
+        if (applied <= 0)
+        {
+            if (applied < 0)
+            {
+                rc = ERROR;
+                continue;
+            }
+            explainDeadEnd(search, node, top, &move);
+            continue;
+        }
+        if (search->nogoods != NULL)
+        {
+            if (!insertMove(&search->path, move, top))
+            {
+                search->undoMove(node, move);
+                rc = ERROR;
+                continue;
+            }
+            if (completesNogood(search, move, top))
+            {
+                ADD_STAT(search->stats, nogoods, 1);
+                removeMove(&search->path, move);
+                search->undoMove(node, move);
+                continue;
+            }
+        }
+        size_t numLevels = stack->numLevels;
+        rc = visitState(search, node, numLevels, &dead);
+        if (stack->numLevels == numLevels)
+        {
+            //no level was pushed for the new state, so the search is done with it; a dead state
+            //comes with no explanation, so every level above is blamed for it.
+            if (search->nogoods != NULL)
+            {
+                removeMove(&search->path, move);
+            }
+            search->undoMove(node, move);
+            for (size_t above = 0; dead && above < top; above++)
+            {
+                addToSet(conflictSet(search, top), above);
+            }
+        }
+    }
+
+    //after an error, the moves applied along the path are undone.
+    while (stack->numLevels > 0)
+    {
+        popPathLevel(search, node);
+    }
+    return rc;
+}
+
+pNode searchBackjumping(pNode head, getNodeMovesFunc getMoves, applyMoveFunc applyMove,
+                        undoMoveFunc undoMove, getNodeValFunc getVal, freeNodeFunc freeNode,
+                        copyNodeFunc copy, unsigned int maxMoves, unsigned int best,
+                        const DfsBackjumping* backjumping, SearchBudget* budget)
+{
+    BackjumpSearch search;
+    memset(&search, 0, sizeof(BackjumpSearch));
+    search.getMoves = getMoves;
+    search.applyMove = applyMove;
+    search.undoMove = undoMove;
+    search.explainConflict = backjumping->explainConflict;
+    search.getVal = getVal;
+    search.freeNode = freeNode;
+    search.copy = copy;
+    search.best = best;
+    search.stack.maxMoves = maxMoves;
+    search.stats = getActiveStats();
+    search.budget = budget;
+    if (backjumping->nogoodCapacity > 0)
+    {
+        search.nogoods = newNogoodStore(backjumping->nogoodCapacity);
+        if (search.nogoods == NULL)
+        {
+            return NULL;
+        }
+    }
+    if (newTable(copy, freeNode, &search.table) != SUCCESS_EXIT)
+    {
+        freeNogoodStore(search.nogoods);
+        return NULL;
+    }
+    ADD_STAT(search.stats, copies, 1);
+    search.bestCandidate = copy(head);
+    search.bestVal = search.bestCandidate != NULL ? getVal(head) : 0;
+
+    if (search.bestCandidate != NULL && searchJumping(&search, head) != SUCCESS_EXIT)
+    {
+        freeNode(search.bestCandidate);
+        search.bestCandidate = NULL;
+    }
+    freeMoveStack(&search.stack, search.stats);
+    freeTable(search.table);
+    freeNogoodStore(search.nogoods);
+    freeMoveTable(&search.path);
+    free(search.sets);
+    free(search.ages);
+    return search.bestCandidate;
+}
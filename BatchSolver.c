@@ -0,0 +1,330 @@
+// -------------------------- includes -------------------------
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "BatchSolver.h"
+#include "SudokuIO.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// -------------------------- macros -------------------------
+
+//number of puzzles read, solved and written together.
+#define CHUNK_PUZZLES 64
+//number of chunks held in memory per worker thread.
+#define CHUNKS_PER_WORKER 4
+
+// -------------------------- structs -------------------------
+
+/**
+ * @brief The stages a chunk goes through; a free chunk is owned by the reader.
+ */
+typedef enum ChunkState
+{
+    CHUNK_FREE,
+    CHUNK_READ,
+    CHUNK_SOLVED
+} ChunkState;
+
+/**
+ * @brief A run of consecutive puzzles of the batch, and the text of their solutions.
+ */
+typedef struct Chunk
+{
+    ChunkState state;
+    unsigned int count;
+    pBoard boards[CHUNK_PUZZLES];
+    RecordFormat formats[CHUNK_PUZZLES];
+    char* text;
+    size_t length;
+    size_t capacity;
+} Chunk;
+
+/**
+ * @brief The state shared by the reader, the workers and the writer of a batch.
+ * Chunks are used as a ring: chunk number n lives in chunks[n % numChunks]. readCount chunks
+ * were read, solveCount of them were taken by workers and writeCount of them were written.
+ */
+typedef struct Batch
+{
+    SolverOptions options;
+    FILE* outputFile;
+    int binaryOutput;
+    Chunk* chunks;
+    size_t numChunks;
+    size_t readCount;
+    size_t solveCount;
+    size_t writeCount;
+    int inputDone;
+    int failed;
+    pthread_mutex_t lock;
+    pthread_cond_t spaceCond;
+    pthread_cond_t workCond;
+    pthread_cond_t solvedCond;
+} Batch;
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief appends the given bytes to the given chunk's text.
+ * @param chunk the given chunk.
+ * @param bytes the number of bytes to make room for.
+ * @return a pointer to the room made, or NULL if allocation failed.
+ */
+static char* reserveText(Chunk* chunk, size_t bytes)
+{
+    if (chunk->length + bytes > chunk->capacity)
+    {
+        size_t capacity = 2 * chunk->capacity;
+        if (capacity < chunk->length + bytes)
+        {
+            capacity = chunk->length + bytes;
+        }
+        char* text = (char*)realloc(chunk->text, capacity);
+        if (text == NULL)
+        {
+            fprintf(ERROR_DEST, MALLOC_ERROR);
+            return NULL;
+        }
+        chunk->text = text;
+        chunk->capacity = capacity;
+    }
+    return chunk->text + chunk->length;
+}
+
+/**
+ * @brief solves the puzzles of the given chunk, frees them and writes their solutions into the
+ * chunk's text.
+ * @param batch the given batch.
+ * @param chunk the given chunk.
+ * @return SUCCESS_EXIT, or MALLOC_EXIT if allocation failed.
+ */
+static int solveChunk(Batch* batch, Chunk* chunk)
+{
+    int rc = SUCCESS_EXIT;
+    chunk->length = 0;
+    for (unsigned int i = 0; i < chunk->count; i++)
+    {
+        pBoard board = chunk->boards[i];
+        pBoard solution = rc == SUCCESS_EXIT ? solveBoard(board, &batch->options, NULL) : NULL;
+        RecordFormat format = batch->binaryOutput ? BINARY_FORMAT : chunk->formats[i];
+        size_t bytes = maxFormattedBytes(getSize(board), format);
+        char* text = reserveText(chunk, bytes > sizeof(NO_SOLUTION_ERROR) ?
+                                        bytes : sizeof(NO_SOLUTION_ERROR));
+        if (text == NULL)
+        {
+            rc = MALLOC_EXIT;
+        }
+        else if (solution == NULL)
+        {
+            chunk->length += formatFailure(format, text);
+        }
+        else
+        {
+            chunk->length += formatBoard(solution, format, text);
+        }
+        freeBoard(solution);
+        freeBoard(board);
+        chunk->boards[i] = NULL;
+    }
+    return rc;
+}
+
+/**
+ * @brief solves read chunks until the input is done and every chunk was taken.
+ * @param arg the batch.
+ * @return NULL.
+ */
+static void* runWorker(void* arg)
+{
+    Batch* batch = (Batch*)arg;
+    pthread_mutex_lock(&batch->lock);
+    while (TRUE)
+    {
+        while (batch->solveCount == batch->readCount && !batch->inputDone)
+        {
+            pthread_cond_wait(&batch->workCond, &batch->lock);
+        }
+        if (batch->solveCount == batch->readCount)
+        {
+            pthread_mutex_unlock(&batch->lock);
+            return NULL;
+        }
+        Chunk* chunk = &batch->chunks[batch->solveCount++ % batch->numChunks];
+        pthread_mutex_unlock(&batch->lock);
+
+        int rc = solveChunk(batch, chunk);
+
+        pthread_mutex_lock(&batch->lock);
+        if (rc != SUCCESS_EXIT)
+        {
+            batch->failed = rc;
+        }
+        chunk->state = CHUNK_SOLVED;
+        pthread_cond_broadcast(&batch->solvedCond);
+    }
+}
+
+/**
+ * @brief writes the solved chunks in order until the input is done and every chunk was written.
+ * @param arg the batch.
+ * @return NULL.
+ */
+static void* runWriter(void* arg)
+{
+    Batch* batch = (Batch*)arg;
+    pthread_mutex_lock(&batch->lock);
+    while (TRUE)
+    {
+        Chunk* chunk = &batch->chunks[batch->writeCount % batch->numChunks];
+        while (!(batch->writeCount < batch->readCount && chunk->state == CHUNK_SOLVED) &&
+               !(batch->inputDone && batch->writeCount == batch->readCount))
+        {
+            pthread_cond_wait(&batch->solvedCond, &batch->lock);
+        }
+        if (batch->writeCount == batch->readCount)
+        {
+            pthread_mutex_unlock(&batch->lock);
+            fflush(batch->outputFile);
+            return NULL;
+        }
+        pthread_mutex_unlock(&batch->lock);
+
+        fwrite(chunk->text, 1, chunk->length, batch->outputFile);
+
+        pthread_mutex_lock(&batch->lock);
+        chunk->state = CHUNK_FREE;
+        batch->writeCount++;
+        pthread_cond_signal(&batch->spaceCond);
+    }
+}
+
+/**
+ * @brief reads the puzzles of the input into chunks and hands them to the workers, waiting for
+ * chunks to be written whenever all of them are in use.
+ * @param batch the given batch.
+ * @param inputFile the given input.
+ * @param inputFileName the name of the given input.
+ * @return SUCCESS_EXIT, or an error code if the input holds an invalid puzzle.
+ */
+static int readChunks(Batch* batch, FILE* inputFile, const char* inputFileName)
+{
+    InputReader* reader = openReader(inputFile);
+    if (reader == NULL)
+    {
+        fprintf(ERROR_DEST, MALLOC_ERROR);
+        return MALLOC_EXIT;
+    }
+    unsigned long record = 0;
+    int rc = SUCCESS_EXIT;
+    while (rc == SUCCESS_EXIT)
+    {
+        pthread_mutex_lock(&batch->lock);
+        while (batch->readCount - batch->writeCount == batch->numChunks)
+        {
+            pthread_cond_wait(&batch->spaceCond, &batch->lock);
+        }
+        Chunk* chunk = &batch->chunks[batch->readCount % batch->numChunks];
+        pthread_mutex_unlock(&batch->lock);
+
+        assert(chunk->state == CHUNK_FREE);
+        chunk->count = 0;
+        while (chunk->count < CHUNK_PUZZLES)
+        {
+            rc = scanRecord(reader, inputFileName, ++record, &chunk->boards[chunk->count],
+                            &chunk->formats[chunk->count]);
+            if (rc != SUCCESS_EXIT)
+            {
+                break;
+            }
+            chunk->count++;
+        }
+        if (chunk->count == 0)
+        {
+            break;
+        }
+
+        pthread_mutex_lock(&batch->lock);
+        chunk->state = CHUNK_READ;
+        batch->readCount++;
+        pthread_cond_signal(&batch->workCond);
+        pthread_mutex_unlock(&batch->lock);
+    }
+    closeReader(reader);
+    return rc == END_OF_INPUT ? SUCCESS_EXIT : rc;
+}
+
+int solveBatch(FILE* inputFile, const char* inputFileName, FILE* outputFile,
+               const SolverOptions* options, unsigned int numThreads, int binaryOutput)
+{
+    assert(inputFile != NULL && inputFileName != NULL && outputFile != NULL && options != NULL);
+
+    if (numThreads == 0)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        numThreads = online > 0 ? (unsigned int)online : 1;
+    }
+
+    Batch batch;
+    memset(&batch, 0, sizeof(batch));
+    batch.options = *options;
+    batch.options.numThreads = 1;
+    batch.outputFile = outputFile;
+    batch.binaryOutput = binaryOutput;
+    batch.numChunks = (size_t)numThreads * CHUNKS_PER_WORKER;
+    batch.chunks = (Chunk*)calloc(batch.numChunks, sizeof(Chunk));
+    pthread_t* threads = (pthread_t*)malloc((numThreads + 1) * sizeof(pthread_t));
+    if (batch.chunks == NULL || threads == NULL)
+    {
+        fprintf(ERROR_DEST, MALLOC_ERROR);
+        free(batch.chunks);
+        free(threads);
+        return MALLOC_EXIT;
+    }
+    pthread_mutex_init(&batch.lock, NULL);
+    pthread_cond_init(&batch.spaceCond, NULL);
+    pthread_cond_init(&batch.workCond, NULL);
+    pthread_cond_init(&batch.solvedCond, NULL);
+
+    //threads[0] is the writer; the rest are workers.
+    unsigned int started = 0;
+    for (; started <= numThreads; started++)
+    {
+        if (pthread_create(&threads[started], NULL, started == 0 ? runWriter : runWorker,
+                           &batch) != 0)
+        {
+            break;
+        }
+    }
+
+    int rc = started > 1 ? readChunks(&batch, inputFile, inputFileName) : MALLOC_EXIT;
+
+    pthread_mutex_lock(&batch.lock);
+    batch.inputDone = TRUE;
+    pthread_cond_broadcast(&batch.workCond);
+    pthread_cond_broadcast(&batch.solvedCond);
+    pthread_mutex_unlock(&batch.lock);
+    for (unsigned int i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    if (rc == SUCCESS_EXIT && batch.failed != SUCCESS_EXIT)
+    {
+        rc = batch.failed;
+    }
+    for (size_t i = 0; i < batch.numChunks; i++)
+    {
+        free(batch.chunks[i].text);
+    }
+    pthread_mutex_destroy(&batch.lock);
+    pthread_cond_destroy(&batch.spaceCond);
+    pthread_cond_destroy(&batch.workCond);
+    pthread_cond_destroy(&batch.solvedCond);
+    free(batch.chunks);
+    free(threads);
+    return rc;
+}
@@ -0,0 +1,28 @@
+#ifndef EX3_BATCHSOLVER_H
+#define EX3_BATCHSOLVER_H
+
+#include "SudokuEngine.h"
+#include <stdio.h>
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief Solves every puzzle of the given input, on a pool of worker threads, and writes the
+ * solutions to the given output in input order. Each solution is written in the format its
+ * puzzle was read in, or in BINARY_FORMAT, and a puzzle that could not be solved is answered as
+ * written by formatFailure(). Puzzles are streamed: only a bounded number of them is held in
+ * memory at any time.
+ * @param inputFile the given input, holding puzzles as read by scanRecord().
+ * @param inputFileName the name of the given input, for error messages.
+ * @param outputFile the given output.
+ * @param options the settings each puzzle is solved with; a single thread solves each puzzle.
+ * @param numThreads the number of worker threads; 0 for one per online processor.
+ * @param binaryOutput TRUE to write every solution in BINARY_FORMAT; FALSE to write each in the
+ * format of its puzzle.
+ * @return SUCCESS_EXIT, or an error code if the input holds an invalid puzzle, in which case the
+ * solutions of the puzzles before it are still written.
+ */
+int solveBatch(FILE* inputFile, const char* inputFileName, FILE* outputFile,
+               const SolverOptions* options, unsigned int numThreads, int binaryOutput);
+
+#endif //EX3_BATCHSOLVER_H
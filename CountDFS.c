@@ -0,0 +1,407 @@
+// -------------------------- includes -------------------------
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "GenericDFSInternal.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -------------------------- macros -------------------------
+
+//deepest tree level that is still split into subtrees.
+#define MAX_SPLIT_DEPTH 32
+//number of subtrees per worker the top of the tree is split into.
+#define SUBTREES_PER_WORKER 8
+
+// -------------------------- structs -------------------------
+
+/**
+ * @brief The totals shared by all the threads of a count.
+ */
+typedef struct CountTotals
+{
+    unsigned long limit;
+    visitNodeFunc visit;
+    void* data;
+    unsigned long count;
+    int stopped;
+    //serializes visit and the updates of count; NULL for a single threaded count.
+    pthread_mutex_t* lock;
+} CountTotals;
+
+/**
+ * @brief The state of a single thread of a count.
+ */
+typedef struct CountSearch
+{
+    getNodeMovesFunc getMoves;
+    applyMoveFunc applyMove;
+    undoMoveFunc undoMove;
+    getNodeValFunc getVal;
+    unsigned int best;
+    MoveStack stack;
+    CountTotals* totals;
+    //the statistics the thread counts into, and the number of nodes the thread counted.
+    DfsStats* stats;
+    unsigned long found;
+} CountSearch;
+
+/**
+ * @brief The state shared by the workers of a parallel count.
+ */
+typedef struct ParallelCount
+{
+    CountSearch prototype;
+    freeNodeFunc freeNode;
+    pNode* subtrees;
+    size_t numSubtrees;
+    //the level of the subtrees' roots.
+    unsigned int depth;
+    size_t next;
+    int failed;
+} ParallelCount;
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief checks whether the given count was stopped.
+ * @param totals the count's totals.
+ * @return TRUE if the count was stopped; FALSE otherwise.
+ */
+static int isStopped(CountTotals* totals)
+{
+    return __atomic_load_n(&totals->stopped, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief counts the given node, which has the best value, unless the count was stopped, and
+ * stops the count if it reached its limit or visit asks it to.
+ * @param totals the count's totals.
+ * @param node the given node.
+ */
+static void countNode(CountTotals* totals, pNode node)
+{
+    if (totals->lock != NULL)
+    {
+        pthread_mutex_lock(totals->lock);
+    }
+    if (!isStopped(totals))
+    {
+        totals->count++;
+        if ((totals->visit != NULL && totals->visit(node, totals->data)) ||
+            totals->count == totals->limit)
+        {
+            __atomic_store_n(&totals->stopped, TRUE, __ATOMIC_RELAXED);
+        }
+    }
+    if (totals->lock != NULL)
+    {
+        pthread_mutex_unlock(totals->lock);
+    }
+}
+
+/**
+ * @brief visits the current state of the given node: counts it if it has the best value, and
+ * otherwise pushes a level holding the moves of the node.
+ * @param search the given search.
+ * @param node the given node.
+ * @param depth the level of the node's current state in the whole tree.
+ * @return SUCCESS_EXIT, or ERROR in case of an error, in which case no level is pushed.
+ */
+static int visitState(CountSearch* search, pNode node, unsigned int depth)
+{
+    ADD_STAT(search->stats, nodes, 1);
+    MAX_STAT(search->stats, maxDepth, depth);
+    if (search->getVal(node) == search->best)
+    {
+        countNode(search->totals, node);
+        search->found++;
+        return SUCCESS_EXIT;
+    }
+
+    MoveLevel* level = pushLevel(&search->stack);
+    if (level == NULL)
+    {
+        return ERROR;
+    }
+    int numMoves = search->getMoves(node, search->stack.moves + level->base);
+    if (numMoves < 0)
+    {
+        search->stack.numLevels--;
+        return ERROR;
+    }
+    ADD_STAT(search->stats, generated, (unsigned int)numMoves);
+    level->end = level->base + (size_t)numMoves;
+    level->found = search->found;
+    return SUCCESS_EXIT;
+}
+
+/**
+ * @brief counts the nodes with the best value in the subtree rooted at the current state of the
+ * given node, keeping the path on the search's explicit stack. The node is back in its current
+ * state when the function returns.
+ * @param search the given search; its stack holds no level.
+ * @param node the given node.
+ * @param depth the level of the node's current state in the whole tree.
+ * @return SUCCESS_EXIT, or ERROR in case of an error.
+ */
+static int countInPlace(CountSearch* search, pNode node, unsigned int depth)
+{
+    MoveStack* stack = &search->stack;
+    int rc = visitState(search, node, depth);
+    while (rc == SUCCESS_EXIT && stack->numLevels > 0)
+    {
+        MoveLevel* level = &stack->levels[stack->numLevels - 1];
+        if (level->next == level->end || isStopped(search->totals))
+        {
+            if (search->found == level->found)
+            {
+                ADD_STAT(search->stats, backtracks, 1);
+            }
+            popLevel(stack, node, search->undoMove);
+            continue;
+        }
+
+        Move move = stack->moves[level->next++];
+        int applied = search->applyMove(node, move);
+        if (applied <= 0)
+        {
+            rc = applied < 0 ? ERROR : rc;
+            continue;
+        }
+        ADD_STAT(search->stats, explored, 1);
+        size_t numLevels = stack->numLevels;
+        rc = visitState(search, node, depth + (unsigned int)numLevels);
+        if (stack->numLevels == numLevels)
+        {
+            //no level was pushed for the new state, so the count is done with it.
+            search->undoMove(node, move);
+        }
+    }
+
+    //after an error, the moves applied along the path are undone.
+    while (stack->numLevels > 0)
+    {
+        popLevel(stack, node, search->undoMove);
+    }
+    return rc;
+}
+
+int countBest(pNode head, getNodeMovesFunc getMoves, applyMoveFunc applyMove,
+              undoMoveFunc undoMove, getNodeValFunc getVal, unsigned int maxMoves,
+              unsigned int best, unsigned long limit, visitNodeFunc visit, void* data,
+              unsigned long* count)
+{
+    if (head == NULL || getMoves == NULL || applyMove == NULL || undoMove == NULL ||
+        getVal == NULL || count == NULL)
+    {
+        return ERROR;
+    }
+
+    CountTotals totals = {limit, visit, data, 0, FALSE, NULL};
+    CountSearch search = {getMoves, applyMove, undoMove, getVal, best,
+                          {NULL, 0, maxMoves, NULL, 0, 0}, &totals, getActiveStats(), 0};
+    int rc = countInPlace(&search, head, 0);
+    freeMoveStack(&search.stack, search.stats);
+    *count = totals.count;
+    return rc;
+}
+
+/**
+ * @brief replaces the given subtrees by the subtrees of their children, counting the subtrees
+ * whose root has the best value instead.
+ * @param count the given count; its subtrees are replaced.
+ * @param copy a function copying a node.
+ * @return SUCCESS_EXIT, or ERROR in case of an error.
+ */
+static int splitSubtrees(ParallelCount* count, copyNodeFunc copy)
+{
+    CountSearch* search = &count->prototype;
+    pNode* children = NULL;
+    size_t numChildren = 0, capacity = 0;
+    int rc = reserveMoves(&search->stack, 0) ? SUCCESS_EXIT : ERROR;
+
+    for (size_t k = 0; k < count->numSubtrees; k++)
+    {
+        pNode node = count->subtrees[k];
+        int numMoves = 0;
+        if (rc == SUCCESS_EXIT && !isStopped(search->totals))
+        {
+            ADD_STAT(search->stats, nodes, 1);
+            ADD_STAT(search->stats, explored, count->depth > 0);
+            MAX_STAT(search->stats, maxDepth, count->depth);
+            if (search->getVal(node) == search->best)
+            {
+                countNode(search->totals, node);
+            }
+            else if ((numMoves = search->getMoves(node, search->stack.moves)) < 0)
+            {
+                rc = ERROR;
+            }
+            else
+            {
+                ADD_STAT(search->stats, generated, (unsigned int)numMoves);
+            }
+        }
+        for (int i = 0; i < numMoves && rc == SUCCESS_EXIT; i++)
+        {
+            if (numChildren == capacity)
+            {
+                capacity = capacity ? 2 * capacity : count->numSubtrees * search->stack.maxMoves;
+                pNode* grown = (pNode*)realloc(children, capacity * sizeof(pNode));
+                if (grown == NULL)
+                {
+                    rc = ERROR;
+                    break;
+                }
+                children = grown;
+            }
+            ADD_STAT(search->stats, copies, 1);
+            pNode child = copy(node);
+            int applied = child == NULL ? ERROR : search->applyMove(child, search->stack.moves[i]);
+            if (applied > 0)
+            {
+                children[numChildren++] = child;
+                continue;
+            }
+            if (child != NULL)
+            {
+                count->freeNode(child);
+            }
+            rc = applied < 0 ? ERROR : rc;
+        }
+        count->freeNode(node);
+    }
+
+    free(count->subtrees);
+    count->subtrees = children;
+    count->numSubtrees = numChildren;
+    return rc;
+}
+
+/**
+ * @brief counts the subtrees of the given count until none are left.
+ * @param arg the parallel count.
+ * @return NULL.
+ */
+static void* runCounter(void* arg)
+{
+    ParallelCount* count = (ParallelCount*)arg;
+    CountSearch search = count->prototype;
+    search.stack = (MoveStack){NULL, 0, search.stack.maxMoves, NULL, 0, 0};
+    DfsStats stats;
+    memset(&stats, 0, sizeof(stats));
+    search.stats = count->prototype.stats != NULL ? &stats : NULL;
+
+    size_t k;
+    while ((k = __atomic_fetch_add(&count->next, 1, __ATOMIC_RELAXED)) < count->numSubtrees)
+    {
+        if (isStopped(search.totals))
+        {
+            continue;
+        }
+        ADD_STAT(search.stats, explored, count->depth > 0);
+        if (countInPlace(&search, count->subtrees[k], count->depth) != SUCCESS_EXIT)
+        {
+            __atomic_store_n(&count->failed, TRUE, __ATOMIC_RELAXED);
+            __atomic_store_n(&search.totals->stopped, TRUE, __ATOMIC_RELAXED);
+        }
+    }
+    freeMoveStack(&search.stack, search.stats);
+    pthread_mutex_lock(search.totals->lock);
+    addDfsStats(count->prototype.stats, &stats);
+    pthread_mutex_unlock(search.totals->lock);
+    return NULL;
+}
+
+int countBestParallel(pNode head, getNodeMovesFunc getMoves, applyMoveFunc applyMove,
+                      undoMoveFunc undoMove, getNodeValFunc getVal, freeNodeFunc freeNode,
+                      copyNodeFunc copy, unsigned int maxMoves, unsigned int best,
+                      unsigned long limit, visitNodeFunc visit, void* data,
+                      unsigned int numThreads, unsigned long* count)
+{
+    if (head == NULL || getMoves == NULL || applyMove == NULL || undoMove == NULL ||
+        getVal == NULL || freeNode == NULL || copy == NULL || count == NULL)
+    {
+        return ERROR;
+    }
+    if (numThreads == 0)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        numThreads = online > 0 ? (unsigned int)online : 1;
+    }
+    if (numThreads == 1)
+    {
+        pNode root = copy(head);
+        if (root == NULL)
+        {
+            return ERROR;
+        }
+        int rc = countBest(root, getMoves, applyMove, undoMove, getVal, maxMoves, best, limit,
+                           visit, data, count);
+        freeNode(root);
+        return rc;
+    }
+
+    pthread_mutex_t lock;
+    pthread_mutex_init(&lock, NULL);
+    CountTotals totals = {limit, visit, data, 0, FALSE, &lock};
+    ParallelCount parallel;
+    memset(&parallel, 0, sizeof(parallel));
+    parallel.prototype = (CountSearch){getMoves, applyMove, undoMove, getVal, best,
+                                       {NULL, 0, maxMoves, NULL, 0, 0}, &totals,
+                                       getActiveStats(), 0};
+    parallel.freeNode = freeNode;
+    parallel.subtrees = (pNode*)malloc(sizeof(pNode));
+    ADD_STAT(parallel.prototype.stats, copies, 1);
+    pNode root = copy(head);
+    int rc = parallel.subtrees == NULL || root == NULL ? ERROR : SUCCESS_EXIT;
+    if (rc == SUCCESS_EXIT)
+    {
+        parallel.subtrees[parallel.numSubtrees++] = root;
+    }
+    else if (root != NULL)
+    {
+        freeNode(root);
+    }
+
+    //split the top of the tree until every worker has several subtrees to take.
+    for (; rc == SUCCESS_EXIT && parallel.depth < MAX_SPLIT_DEPTH && parallel.numSubtrees > 0 &&
+           parallel.numSubtrees < (size_t)numThreads * SUBTREES_PER_WORKER; parallel.depth++)
+    {
+        rc = splitSubtrees(&parallel, copy);
+    }
+    freeMoveStack(&parallel.prototype.stack, parallel.prototype.stats);
+
+    if (rc == SUCCESS_EXIT)
+    {
+        //the calling thread counts along with the started threads.
+        pthread_t* threads = (pthread_t*)malloc(numThreads * sizeof(pthread_t));
+        unsigned int started = 1;
+        for (; threads != NULL && started < numThreads; started++)
+        {
+            if (pthread_create(&threads[started], NULL, runCounter, &parallel) != 0)
+            {
+                break;
+            }
+        }
+        runCounter(&parallel);
+        for (unsigned int i = 1; i < started; i++)
+        {
+            pthread_join(threads[i], NULL);
+        }
+        free(threads);
+        rc = parallel.failed ? ERROR : SUCCESS_EXIT;
+    }
+
+    for (size_t k = 0; k < parallel.numSubtrees; k++)
+    {
+        freeNode(parallel.subtrees[k]);
+    }
+    free(parallel.subtrees);
+    pthread_mutex_destroy(&lock);
+    *count = totals.count;
+    return rc;
+}
@@ -0,0 +1,383 @@
+// -------------------------- includes -------------------------
+
+#include "DancingLinks.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// -------------------------- macros -------------------------
+
+//number of constraint kinds: cell, row-value, column-value and block-value.
+#define NUM_CONSTRAINTS 4
+//index of the root header node.
+#define ROOT 0
+//marks a constraint that the filled cells already cover.
+#define COVERED -1
+
+// -------------------------- structs -------------------------
+
+/**
+ * @brief A sparse exact cover matrix, stored as circular doubly linked lists in index arrays.
+ * Node 0 is the root, nodes 1..numColumns are the column headers and the rest are the ones of
+ * the matrix, NUM_CONSTRAINTS consecutive nodes per matrix row.
+ */
+typedef struct DancingLinks
+{
+    unsigned int numColumns;
+    unsigned int numNodes;
+    unsigned int* left;
+    unsigned int* right;
+    unsigned int* up;
+    unsigned int* down;
+    unsigned int* column;
+    unsigned int* columnSize;
+    unsigned int* rowOf;
+} DancingLinks;
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief allocates the arrays of a matrix with the given number of columns and rows.
+ * @param links the given matrix.
+ * @param numColumns the number of columns.
+ * @param numRows the number of matrix rows.
+ * @return SUCCESS_EXIT, or ERROR if allocation failed.
+ */
+static int allocateLinks(DancingLinks* links, unsigned int numColumns, unsigned int numRows)
+{
+    links->numColumns = numColumns;
+    links->numNodes = 1 + numColumns + NUM_CONSTRAINTS * numRows;
+    //one block holds the six per-node arrays followed by the column sizes.
+    links->left = (unsigned int*)malloc((6 * links->numNodes + numColumns + 1) *
+                                        sizeof(unsigned int));
+    if (links->left == NULL)
+    {
+        fprintf(ERROR_DEST, MALLOC_ERROR);
+        return ERROR;
+    }
+    links->right = links->left + links->numNodes;
+    links->up = links->right + links->numNodes;
+    links->down = links->up + links->numNodes;
+    links->column = links->down + links->numNodes;
+    links->rowOf = links->column + links->numNodes;
+    links->columnSize = links->rowOf + links->numNodes;
+
+    for (unsigned int c = ROOT; c <= numColumns; c++)
+    {
+        links->left[c] = c == ROOT ? numColumns : c - 1;
+        links->right[c] = c == numColumns ? ROOT : c + 1;
+        links->up[c] = c;
+        links->down[c] = c;
+        links->column[c] = c;
+        links->columnSize[c] = 0;
+    }
+    return SUCCESS_EXIT;
+}
+
+/**
+ * @brief appends a matrix row with a one in each of the given columns.
+ * @param links the given matrix.
+ * @param first the index of the row's first node.
+ * @param columns the NUM_CONSTRAINTS column headers of the row.
+ * @param row the identifier of the row.
+ */
+static void addRow(DancingLinks* links, unsigned int first, const unsigned int* columns,
+                   unsigned int row)
+{
+    for (unsigned int k = 0; k < NUM_CONSTRAINTS; k++)
+    {
+        unsigned int node = first + k, c = columns[k];
+        links->left[node] = k == 0 ? first + NUM_CONSTRAINTS - 1 : node - 1;
+        links->right[node] = k == NUM_CONSTRAINTS - 1 ? first : node + 1;
+        links->column[node] = c;
+        links->rowOf[node] = row;
+        links->up[node] = links->up[c];
+        links->down[node] = c;
+        links->down[links->up[c]] = node;
+        links->up[c] = node;
+        links->columnSize[c]++;
+    }
+}
+
+/**
+ * @brief removes the given column and every row with a one in it from the matrix.
+ * @param links the given matrix.
+ * @param c the column header.
+ */
+static void cover(DancingLinks* links, unsigned int c)
+{
+    links->right[links->left[c]] = links->right[c];
+    links->left[links->right[c]] = links->left[c];
+    for (unsigned int i = links->down[c]; i != c; i = links->down[i])
+    {
+        for (unsigned int j = links->right[i]; j != i; j = links->right[j])
+        {
+            links->down[links->up[j]] = links->down[j];
+            links->up[links->down[j]] = links->up[j];
+            links->columnSize[links->column[j]]--;
+        }
+    }
+}
+
+/**
+ * @brief restores the given column, which must be the last one covered; the reverse of cover().
+ * @param links the given matrix.
+ * @param c the column header.
+ */
+static void uncover(DancingLinks* links, unsigned int c)
+{
+    for (unsigned int i = links->up[c]; i != c; i = links->up[i])
+    {
+        for (unsigned int j = links->left[i]; j != i; j = links->left[j])
+        {
+            links->columnSize[links->column[j]]++;
+            links->down[links->up[j]] = j;
+            links->up[links->down[j]] = j;
+        }
+    }
+    links->right[links->left[c]] = c;
+    links->left[links->right[c]] = c;
+}
+
+/**
+ * @brief return the uncovered column with the fewest ones.
+ * @param links the given matrix; must have an uncovered column.
+ * @return the column header.
+ */
+static unsigned int chooseColumn(const DancingLinks* links)
+{
+    unsigned int best = links->right[ROOT];
+    for (unsigned int c = links->right[best]; c != ROOT && links->columnSize[best] > 1;
+         c = links->right[c])
+    {
+        if (links->columnSize[c] < links->columnSize[best])
+        {
+            best = c;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief searches the matrix for an exact cover, iteratively, keeping the row nodes chosen at
+ * each level on the given stack.
+ * @param links the given matrix.
+ * @param chosen a stack with room for one node per column.
+ * @param bestRows for the result: the rows of the deepest partial cover found; a full cover if
+ * one exists.
+ * @return the number of rows in bestRows.
+ */
+static unsigned int searchCover(DancingLinks* links, unsigned int* chosen, unsigned int* bestRows)
+{
+    unsigned int bestDepth = 0;
+    unsigned int level = 0;
+    while (TRUE)
+    {
+        //enter a new level.
+        if (level > bestDepth)
+        {
+            bestDepth = level;
+            for (unsigned int l = 0; l < level; l++)
+            {
+                bestRows[l] = links->rowOf[chosen[l]];
+            }
+        }
+        if (links->right[ROOT] == ROOT)
+        {
+            return bestDepth;
+        }
+        unsigned int c = chooseColumn(links);
+        cover(links, c);
+        chosen[level] = links->down[c];
+
+        //try the current row of the level, backtracking while the level's column is exhausted.
+        while (chosen[level] == links->column[chosen[level]])
+        {
+            uncover(links, chosen[level]);
+            if (level == 0)
+            {
+                return bestDepth;
+            }
+            level--;
+            unsigned int r = chosen[level];
+            for (unsigned int j = links->left[r]; j != r; j = links->left[j])
+            {
+                uncover(links, links->column[j]);
+            }
+            chosen[level] = links->down[r];
+        }
+
+        unsigned int r = chosen[level];
+        for (unsigned int j = links->right[r]; j != r; j = links->right[j])
+        {
+            cover(links, links->column[j]);
+        }
+        level++;
+    }
+}
+
+/**
+ * @brief marks the constraints the given board's filled cells cover.
+ * @param board the given board.
+ * @param columnOf for the result: COVERED for every covered constraint.
+ * @return TRUE if no two filled cells cover the same constraint; FALSE otherwise.
+ */
+static int markFilledCells(pBoard board, int* columnOf)
+{
+    unsigned int size = getSize(board), numCells = size * size;
+    unsigned int blockSize = (unsigned int)sqrt(size);
+    for (unsigned int i = 0; i < size; i++)
+    {
+        for (unsigned int j = 0; j < size; j++)
+        {
+            unsigned int val = getCellValue(board, i, j);
+            if (val == 0)
+            {
+                continue;
+            }
+            unsigned int block = (i / blockSize) * blockSize + j / blockSize;
+            unsigned int constraints[NUM_CONSTRAINTS] = {i * size + j,
+                                                         numCells + i * size + val - 1,
+                                                         2 * numCells + j * size + val - 1,
+                                                         3 * numCells + block * size + val - 1};
+            for (unsigned int k = 0; k < NUM_CONSTRAINTS; k++)
+            {
+                if (columnOf[constraints[k]] == COVERED)
+                {
+                    return FALSE;
+                }
+                columnOf[constraints[k]] = COVERED;
+            }
+        }
+    }
+    return TRUE;
+}
+
+/**
+ * @brief builds the exact cover matrix of the given board.
+ * @param board the given board.
+ * @param links for the result: the matrix; rows are identified by cell * size + value - 1.
+ * @param columnOf scratch space for one entry per constraint; filled cells must be marked.
+ * @return SUCCESS_EXIT, or ERROR if allocation failed.
+ */
+static int buildLinks(pBoard board, DancingLinks* links, int* columnOf)
+{
+    unsigned int size = getSize(board), numCells = size * size;
+    unsigned int blockSize = (unsigned int)sqrt(size);
+
+    unsigned int numColumns = 0;
+    for (unsigned int k = 0; k < NUM_CONSTRAINTS * numCells; k++)
+    {
+        if (columnOf[k] != COVERED)
+        {
+            columnOf[k] = (int)++numColumns;
+        }
+    }
+
+    //two passes over the candidate rows: the first counts them, the second links them.
+    unsigned int numRows = 0;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        if (pass == 1 && allocateLinks(links, numColumns, numRows) != SUCCESS_EXIT)
+        {
+            return ERROR;
+        }
+        unsigned int node = 1 + numColumns;
+        for (unsigned int i = 0; i < size; i++)
+        {
+            for (unsigned int j = 0; j < size; j++)
+            {
+                if (getCellValue(board, i, j) != 0)
+                {
+                    continue;
+                }
+                unsigned int block = (i / blockSize) * blockSize + j / blockSize;
+                for (unsigned int val = 1; val <= size; val++)
+                {
+                    unsigned int digit = val - 1;
+                    int columns[NUM_CONSTRAINTS] = {columnOf[i * size + j],
+                                                    columnOf[numCells + i * size + digit],
+                                                    columnOf[2 * numCells + j * size + digit],
+                                                    columnOf[3 * numCells + block * size + digit]};
+                    if (columns[1] == COVERED || columns[2] == COVERED || columns[3] == COVERED)
+                    {
+                        continue;
+                    }
+                    if (pass == 0)
+                    {
+                        numRows++;
+                        continue;
+                    }
+                    unsigned int headers[NUM_CONSTRAINTS];
+                    for (unsigned int k = 0; k < NUM_CONSTRAINTS; k++)
+                    {
+                        headers[k] = (unsigned int)columns[k];
+                    }
+                    addRow(links, node, headers, (i * size + j) * size + val - 1);
+                    node += NUM_CONSTRAINTS;
+                }
+            }
+        }
+    }
+    return SUCCESS_EXIT;
+}
+
+pBoard solveExactCover(pBoard board)
+{
+    if (board == NULL)
+    {
+        fprintf(ERROR_DEST, POINTER_ERROR);
+        return NULL;
+    }
+
+    pBoard result = (pBoard)copyBoard(board);
+    if (result == NULL)
+    {
+        return NULL;
+    }
+    unsigned int size = getSize(board), numCells = size * size;
+    int* columnOf = (int*)calloc(NUM_CONSTRAINTS * numCells, sizeof(int));
+    if (columnOf == NULL)
+    {
+        fprintf(ERROR_DEST, MALLOC_ERROR);
+        freeBoard(result);
+        return NULL;
+    }
+    //conflicting filled cells leave no cover to search for.
+    if (!markFilledCells(board, columnOf))
+    {
+        free(columnOf);
+        return result;
+    }
+
+    DancingLinks links;
+    int rc = buildLinks(board, &links, columnOf);
+    free(columnOf);
+    if (rc != SUCCESS_EXIT)
+    {
+        freeBoard(result);
+        return NULL;
+    }
+
+    unsigned int* chosen = (unsigned int*)malloc(2 * (links.numColumns + 1) * sizeof(unsigned int));
+    if (chosen == NULL)
+    {
+        fprintf(ERROR_DEST, MALLOC_ERROR);
+        free(links.left);
+        freeBoard(result);
+        return NULL;
+    }
+    unsigned int* bestRows = chosen + links.numColumns + 1;
+    unsigned int depth = searchCover(&links, chosen, bestRows);
+
+    for (unsigned int l = 0; l < depth; l++)
+    {
+        unsigned int cell = bestRows[l] / size;
+        setCell(result, cell / size, cell % size, bestRows[l] % size + 1);
+    }
+    free(chosen);
+    free(links.left);
+    return result;
+}
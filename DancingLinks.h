@@ -0,0 +1,20 @@
+#ifndef EX3_DANCINGLINKS_H
+#define EX3_DANCINGLINKS_H
+
+#include "SudokuTree.h"
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief Solves the given board as an exact cover problem using Dancing Links (Algorithm X).
+ * The constraint matrix has a column for every cell, and for every value of every row, column and
+ * block that the board's filled cells do not already cover; it has a row for every legal value of
+ * every empty cell. The matrix is built once and searched without copying the board.
+ * @param board the given board; not modified.
+ * @return a new board holding the solution; if the board has no solution, a new board holding the
+ * partial assignment covering the most cells found, like getBest() does. NULL in case of an
+ * allocation error.
+ */
+pBoard solveExactCover(pBoard board);
+
+#endif //EX3_DANCINGLINKS_H
@@ -0,0 +1,292 @@
+// -------------------------- includes -------------------------
+
+#include "GenericDFS.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -------------------------- macros -------------------------
+
+//-----boolean values
+//true.
+#define TRUE 1
+//false.
+#define FALSE 0
+
+//-----the tree searched: the orders of picking some of NUM_ITEMS items, one per level.
+//number of items.
+#define NUM_ITEMS 10
+//a value above the value of any node, so the searches go through the whole tree.
+#define UNREACHABLE_VAL (NUM_ITEMS + 1)
+//number of nodes of the tree: the sum over k of NUM_ITEMS! / (NUM_ITEMS - k)!.
+#define TREE_NODES 9864101ULL
+//number of nodes searched with a table of TABLE_CAPACITY: the root, and every set of items once
+//for each item it can be reached by picking last.
+#define HASHED_NODES (1ULL + NUM_ITEMS * (1ULL << (NUM_ITEMS - 1)))
+//capacity of a table with room for every set of items.
+#define TABLE_CAPACITY (1u << 12)
+//number of threads of the parallel searches.
+#define NUM_THREADS 4
+//multiplier spreading the sets of items over the hashes, see hashItems(); being odd, it maps
+//distinct sets to distinct low bits, so they never share a slot of the table.
+#define HASH_MULTIPLIER 0x9e3779b97f4a7c15ULL
+
+//-----messages.
+//format of the line printed for each check.
+#define CHECK_FORMAT "%-40s %s\n"
+//the verdicts of a check.
+#define PASSED "ok"
+#define FAILED "FAILED"
+
+// -------------------------- structs & typedef -------------------------
+
+/**
+ * @brief A node of the tree: the items picked so far. Two nodes picking the same items in
+ * different orders have the same subtree, so they are equal, and the tree is full of
+ * transpositions.
+ */
+typedef struct Items
+{
+    unsigned int picked;
+    unsigned int count;
+} Items;
+
+/**
+ * @brief A search, run with the table settings of a check.
+ */
+typedef pNode (*SearchFunc)(pNode head);
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief constructs a node picking the given items.
+ * @param picked the bit mask of the items.
+ * @param count the number of items.
+ * @return the new node, or NULL if allocation failed.
+ */
+static pNode newItems(unsigned int picked, unsigned int count)
+{
+    Items* items = (Items*)dfsAlloc(sizeof(Items));
+    if (items != NULL)
+    {
+        items->picked = picked;
+        items->count = count;
+    }
+    return items;
+}
+
+/**
+ * @brief constructs a child of the given node for every item it has not picked; a
+ * getNodeChildrenFunc.
+ */
+static int getChildren(pNode node, pNode** children)
+{
+    const Items* items = (const Items*)node;
+    *children = (pNode*)dfsAlloc(NUM_ITEMS * sizeof(pNode));
+    if (*children == NULL)
+    {
+        return -1;
+    }
+    int count = 0;
+    for (unsigned int item = 0; item < NUM_ITEMS; item++)
+    {
+        if (items->picked & (1u << item))
+        {
+            continue;
+        }
+        (*children)[count] = newItems(items->picked | (1u << item), items->count + 1);
+        if ((*children)[count] == NULL)
+        {
+            for (int k = 0; k < count; k++)
+            {
+                dfsFree((*children)[k]);
+            }
+            dfsFree(*children);
+            return -1;
+        }
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief writes a move for every item the given node has not picked; a getNodeMovesFunc.
+ */
+static int getMoves(pNode node, Move* moves)
+{
+    const Items* items = (const Items*)node;
+    int count = 0;
+    for (unsigned int item = 0; item < NUM_ITEMS; item++)
+    {
+        if (!(items->picked & (1u << item)))
+        {
+            moves[count++] = item;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief picks the item of the given move; an applyMoveFunc.
+ */
+static int applyMove(pNode node, Move move)
+{
+    Items* items = (Items*)node;
+    items->picked |= 1u << move;
+    items->count++;
+    return TRUE;
+}
+
+/**
+ * @brief puts the item of the given move back; an undoMoveFunc.
+ */
+static void undoMove(pNode node, Move move)
+{
+    Items* items = (Items*)node;
+    items->picked &= ~(1u << move);
+    items->count--;
+}
+
+/**
+ * @brief return the number of items the given node picked; a getNodeValFunc.
+ */
+static unsigned int getVal(pNode node)
+{
+    return ((const Items*)node)->count;
+}
+
+/**
+ * @brief return a copy of the given node; a copyNodeFunc.
+ */
+static pNode copyItems(pNode node)
+{
+    const Items* items = (const Items*)node;
+    return newItems(items->picked, items->count);
+}
+
+/**
+ * @brief return a hash of the items the given node picked; a hashNodeFunc.
+ */
+static unsigned long long hashItems(pNode node)
+{
+    return ((const Items*)node)->picked * HASH_MULTIPLIER;
+}
+
+/**
+ * @brief return whether the given nodes picked the same items; an equalNodeFunc.
+ */
+static int equalItems(pNode node, pNode other)
+{
+    return ((const Items*)node)->picked == ((const Items*)other)->picked;
+}
+
+/**
+ * @brief searches the tree with getBest().
+ */
+static pNode searchCopying(pNode head)
+{
+    return getBest(head, getChildren, getVal, dfsFree, copyItems, UNREACHABLE_VAL);
+}
+
+/**
+ * @brief searches the tree with getBestParallel().
+ */
+static pNode searchParallel(pNode head)
+{
+    return getBestParallel(head, getChildren, getVal, dfsFree, copyItems, UNREACHABLE_VAL,
+                           NUM_THREADS);
+}
+
+/**
+ * @brief searches the tree with getBestInPlace().
+ */
+static pNode searchInPlace(pNode head)
+{
+    return getBestInPlace(head, getMoves, applyMove, undoMove, getVal, dfsFree, copyItems,
+                          NUM_ITEMS, UNREACHABLE_VAL);
+}
+
+/**
+ * @brief searches the tree with getBestInPlaceBudgeted(), with no limits.
+ */
+static pNode searchBudgeted(pNode head)
+{
+    int finished;
+    DfsBudget budget = {0, 0};
+    pNode result = getBestInPlaceBudgeted(head, getMoves, applyMove, undoMove, getVal, dfsFree,
+                                          copyItems, NUM_ITEMS, UNREACHABLE_VAL, &budget,
+                                          &finished);
+    if (result != NULL && !finished)
+    {
+        dfsFree(result);
+        return NULL;
+    }
+    return result;
+}
+
+/**
+ * @brief runs the given search from the root of the tree with a table of the given capacity, and
+ * checks it found a node picking every item, left the root as it was, and visited the expected
+ * number of nodes. Parallel searches may visit a subtree before another thread recorded it, and
+ * small tables leave most subtrees out, so their count is only checked not to exceed the tree's.
+ * @param name the search's name, printed with the verdict.
+ * @param search the given search.
+ * @param capacity the table's capacity; 0 for no table.
+ * @param expectedNodes the number of nodes the search must visit; 0 to only check it visits no
+ * more than the tree has.
+ * @return TRUE if the check passed; FALSE otherwise.
+ */
+static int runCheck(const char* name, SearchFunc search, size_t capacity,
+                    unsigned long long expectedNodes)
+{
+    DfsHashing hashing = {hashItems, equalItems, capacity};
+    DfsStats stats;
+    memset(&stats, 0, sizeof(DfsStats));
+    pNode root = newItems(0, 0);
+    if (root == NULL)
+    {
+        return FALSE;
+    }
+    setDfsHashing(capacity > 0 ? &hashing : NULL);
+    setDfsStats(&stats);
+    pNode result = search(root);
+    setDfsStats(NULL);
+    setDfsHashing(NULL);
+
+    int passed = result != NULL && getVal(result) == NUM_ITEMS && getVal(root) == 0;
+#if DFS_STATS
+    passed = passed && (expectedNodes > 0 ? stats.nodes == expectedNodes :
+                        stats.nodes <= TREE_NODES);
+#else
+    (void)expectedNodes;
+#endif
+    printf(CHECK_FORMAT, name, passed ? PASSED : FAILED);
+    dfsFree(result);
+    dfsFree(root);
+    return passed;
+}
+
+/**
+ * checks the transposition tables of the searches, see setDfsHashing(), on a tree whose nodes
+ * are reached by many paths: the orders of picking some of NUM_ITEMS items. Without a table
+ * every order is searched; with one, every set of items is expanded once. Small tables must not
+ * change the result. Prints a line per check, and fails if any check failed.
+ * usage: DfsCheck
+ * @return EXIT_SUCCESS if every check passed; EXIT_FAILURE otherwise.
+ */
+int main(void)
+{
+    int passed = TRUE;
+    passed &= runCheck("getBest, no table", searchCopying, 0, TREE_NODES);
+    passed &= runCheck("getBest, table", searchCopying, TABLE_CAPACITY, HASHED_NODES);
+    passed &= runCheck("getBest, table of 1", searchCopying, 1, 0);
+    passed &= runCheck("getBest, table of 8", searchCopying, 8, 0);
+    passed &= runCheck("getBestParallel, table", searchParallel, TABLE_CAPACITY, 0);
+    passed &= runCheck("getBestParallel, table of 8", searchParallel, 8, 0);
+    passed &= runCheck("getBestInPlace, no table", searchInPlace, 0, TREE_NODES);
+    passed &= runCheck("getBestInPlace, table", searchInPlace, TABLE_CAPACITY, HASHED_NODES);
+    passed &= runCheck("getBestInPlace, table of 1", searchInPlace, 1, 0);
+    passed &= runCheck("getBestInPlaceBudgeted, table", searchBudgeted, TABLE_CAPACITY,
+                       HASHED_NODES);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,126 +1,964 @@
 // -------------------------- includes -------------------------
 
-#include "GenericDFS.h"
+#define _POSIX_C_SOURCE 200809L
+
+#include "GenericDFSInternal.h"
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <stdio.h>
+#include <time.h>
+#include <limits.h>
+
+// -------------------------- macros -------------------------
+
+//number of levels an explicit search stack has room for before it first grows; it doubles
+//whenever it is full.
+#define INITIAL_LEVELS 64
+//nanoseconds per second, and per millisecond.
+#define NANOS_PER_SECOND 1000000000ULL
+#define NANOS_PER_MILLI 1000000ULL
+//each budget of GEOMETRIC_RESTARTS is the one before plus the one before divided by this.
+#define GEOMETRIC_GROWTH_DIVISOR 2
+
+// -------------------------- structs -------------------------
+
+/**
+ * @brief A level on the current path of a getSubtreeBest() search.
+ */
+typedef struct SearchFrame
+{
+    pNode node;
+    unsigned int depth;
+    //with getChildren: the node's children and the index of the next one to search.
+    pNode* children;
+    unsigned int numChildren;
+    unsigned int next;
+    //with getNextChild: the cursor over the node's children, and the child being searched.
+    unsigned long long cursor[CHILD_CURSOR_WORDS];
+    pNode child;
+    //the best valued node found in the subtree so far, which may be NULL with getNextChild, and
+    //its value.
+    pNode bestCandidate;
+    unsigned int bestVal;
+    //TRUE once an error occurred in the subtree.
+    int failed;
+} SearchFrame;
+
+/**
+ * @brief The levels of the current path of a getSubtreeBest() search.
+ */
+typedef struct FrameStack
+{
+    SearchFrame* frames;
+    size_t count;
+    size_t capacity;
+} FrameStack;
+
+// -------------------------- globals -------------------------
+
+//the statistics the searches of the calling thread count into; NULL when not counting.
+static __thread DfsStats* activeStats = NULL;
+
+//the transposition table settings of the searches of the calling thread; NULL for no table.
+static __thread const DfsHashing* activeHashing = NULL;
+
+//the backjumping settings of the searches of the calling thread; NULL to backtrack one level at a
+//time.
+static __thread const DfsBackjumping* activeBackjumping = NULL;
+
+//the restart settings of the searches of the calling thread; NULL to search in a single run.
+static __thread const DfsRestarts* activeRestarts = NULL;
 
 // -------------------------- functions -------------------------
 
+DfsStats* setDfsStats(DfsStats* stats)
+{
+    DfsStats* previous = activeStats;
+    activeStats = stats;
+    return previous;
+}
+
+DfsStats* getActiveStats(void)
+{
+    return activeStats;
+}
+
+const DfsHashing* setDfsHashing(const DfsHashing* hashing)
+{
+    const DfsHashing* previous = activeHashing;
+    activeHashing = hashing;
+    return previous;
+}
+
+const DfsHashing* getActiveHashing(void)
+{
+    return activeHashing;
+}
+
+const DfsBackjumping* setDfsBackjumping(const DfsBackjumping* backjumping)
+{
+    const DfsBackjumping* previous = activeBackjumping;
+    activeBackjumping = backjumping;
+    return previous;
+}
+
+const DfsBackjumping* getActiveBackjumping(void)
+{
+    return activeBackjumping;
+}
+
+const DfsRestarts* setDfsRestarts(const DfsRestarts* restarts)
+{
+    const DfsRestarts* previous = activeRestarts;
+    activeRestarts = restarts;
+    return previous;
+}
+
+void addDfsStats(DfsStats* total, const DfsStats* stats)
+{
+    if (total == NULL)
+    {
+        return;
+    }
+    total->nodes += stats->nodes;
+    total->backtracks += stats->backtracks;
+    total->maxDepth = stats->maxDepth > total->maxDepth ? stats->maxDepth : total->maxDepth;
+    total->generated += stats->generated;
+    total->explored += stats->explored;
+    total->copies += stats->copies;
+    total->stackBytes = stats->stackBytes > total->stackBytes ? stats->stackBytes :
+                        total->stackBytes;
+    total->transpositions += stats->transpositions;
+    total->backjumps += stats->backjumps;
+    total->nogoods += stats->nogoods;
+    total->restarts += stats->restarts;
+}
+
+/**
+ * @brief return the time on the CLOCK_MONOTONIC clock, in nanoseconds.
+ * @return the time.
+ */
+static unsigned long long clockNanos(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)now.tv_sec * NANOS_PER_SECOND + (unsigned long long)now.tv_nsec;
+}
+
+void startBudget(SearchBudget* state, const DfsBudget* budget)
+{
+    memset(state, 0, sizeof(SearchBudget));
+    if (budget == NULL)
+    {
+        return;
+    }
+    state->limitNodes = budget->maxNodes > 0;
+    state->nodesLeft = budget->maxNodes;
+    state->hasDeadline = budget->timeoutMs > 0;
+    state->untilClock = CLOCK_CHECK_NODES;
+    if (state->hasDeadline)
+    {
+        state->deadline = clockNanos() + (unsigned long long)budget->timeoutMs * NANOS_PER_MILLI;
+    }
+}
+
+int checkDeadline(SearchBudget* state)
+{
+    if (clockNanos() >= state->deadline)
+    {
+        state->exhausted = TRUE;
+    }
+    return state->exhausted;
+}
+
 /**
- * See documentation for getBest().
+ * @brief pushes a frame on the given stack, growing it if it is full.
+ * @param stack the given stack.
+ * @return the new frame, or NULL if allocation failed.
  */
-static pNode getSubtreeBest(pNode current, getNodeChildrenFunc getChildren,
-                            getNodeValFunc getVal, freeNodeFunc freeNode, copyNodeFunc copy,
-                            unsigned int best);
+static SearchFrame* pushFrame(FrameStack* stack)
+{
+    if (stack->count == stack->capacity)
+    {
+        size_t capacity = stack->capacity ? 2 * stack->capacity : INITIAL_LEVELS;
+        SearchFrame* frames = (SearchFrame*)realloc(stack->frames, capacity * sizeof(SearchFrame));
+        if (frames == NULL)
+        {
+            return NULL;
+        }
+        stack->frames = frames;
+        stack->capacity = capacity;
+    }
+    return &stack->frames[stack->count++];
+}
 
 /**
- * @brief Compares the given subtree's best candidate against the current best candidate and
- * returns the result.
- * The function preserves the following state: no nodes on a lower level than the given root are
- * allocated, and best candidate is allocated independently of the tree.
- * @param bestCandidate - the current best candidate. The function assumes its value does not match
- * the best value.
- * @param currentChild - the root of the given subtree
- * @param getChildren - see getBest()
- * @param getVal - see getBest()
- * @param freeNode - see getBest()
- * @param best - see getBest()
- * @param copy - see getBest()
- * @return The best valued node in the tree
- * In case of an error the returned Node is NULL and bestCandidate is freed from memory.
- * If some nodes share the best valued, the function returns the first one it encounters.
+ * @brief starts searching the subtree rooted at the given node: pushes a frame for the node on
+ * the given stack, unless the best valued node of the subtree is known right away.
+ * @param context the search's callbacks and settings.
+ * @param stack the given stack.
+ * @param node the given node; not freed.
+ * @param depth the level of the node in the whole tree.
+ * @param result for the result, if no frame was pushed: a copy of the subtree's best valued
+ * node, or NULL in case of an error.
+ * @return TRUE if a frame was pushed; FALSE otherwise.
  */
-static pNode updateBestCandidate(pNode bestCandidate, pNode currentChild,
-                                 getNodeChildrenFunc getChildren, getNodeValFunc getVal,
-                                 freeNodeFunc freeNode, copyNodeFunc copy, unsigned int best)
+static int enterNode(const SearchContext* context, FrameStack* stack, pNode node,
+                     unsigned int depth, pNode* result)
 {
-    assert(bestCandidate != NULL);
-    assert(getVal(bestCandidate) != best);
+    //a node the budget has no room for is not visited; it only stands for its subtree.
+    if (chargeNode(context->budget))
+    {
+        *result = copyNode(context, node);
+        return FALSE;
+    }
+    ADD_STAT(context->stats, nodes, 1);
+    ADD_STAT(context->stats, explored, depth > 0);
+    MAX_STAT(context->stats, maxDepth, depth);
+    //check to see if has best value
+    unsigned int val = context->getVal(node);
+    if (val == context->best || isCancelled(context))
+    {
+        *result = copyNode(context, node);
+        return FALSE;
+    }
+    //a node whose subtree was already searched in vain, by another path, is not expanded again.
+    if (isDeadNode(context->table, node))
+    {
+        ADD_STAT(context->stats, transpositions, 1);
+        *result = copyNode(context, node);
+        return FALSE;
+    }
 
-    pNode newCandidate;
-    unsigned int bestVal = getVal(bestCandidate), newVal;
+    //generate children list, unless they are constructed one at a time
+    pNode* children = NULL;
+    int numChildren = 0;
+    if (context->getNextChild == NULL)
+    {
+        numChildren = context->getChildren(node, &children);
+        if (children == NULL)
+        {
+            ADD_STAT(context->stats, backtracks, numChildren >= 0);
+            *result = numChildren < 0 ? NULL : copyNode(context, node);
+            return FALSE;
+        }
+        if (numChildren < 0)
+        {
+            dfsFree(children);
+            *result = NULL;
+            return FALSE;
+        }
+        ADD_STAT(context->stats, generated, (unsigned int)numChildren);
+    }
 
-    if (currentChild == NULL) //found error
+    SearchFrame* frame = pushFrame(stack);
+    if (frame == NULL)
+    {
+        for (int i = 0; i < numChildren; i++)
+        {
+            context->freeNode(children[i]);
+        }
+        dfsFree(children);
+        *result = NULL;
+        return FALSE;
+    }
+    memset(frame, 0, sizeof(SearchFrame));
+    frame->node = node;
+    frame->depth = depth;
+    frame->children = children;
+    frame->numChildren = (unsigned int)numChildren;
+    frame->bestVal = val;
+    //with a children list the node is the first candidate; otherwise it is only copied if no node
+    //below it is better.
+    frame->bestCandidate = children != NULL ? copyNode(context, node) : NULL;
+    frame->failed = children != NULL && frame->bestCandidate == NULL;
+    return TRUE;
+}
+
+/**
+ * @brief takes the next child the given frame's subtree is searched in.
+ * @param context the search's callbacks and settings.
+ * @param frame the given frame.
+ * @return the child, or NULL if the frame is done, either because its node has no more children
+ * to search or because of an error.
+ */
+static pNode nextChild(const SearchContext* context, SearchFrame* frame)
+{
+    if (frame->failed || frame->bestVal == context->best || isCancelled(context))
     {
-        freeNode(bestCandidate);
         return NULL;
     }
 
-    newCandidate = getSubtreeBest(currentChild, getChildren, getVal, freeNode, copy, best);
-    if (newCandidate == NULL) //found error
+    pNode child = NULL;
+    if (frame->children != NULL)
     {
-        freeNode(bestCandidate);
+        if (frame->next == frame->numChildren)
+        {
+            return NULL;
+        }
+        child = frame->children[frame->next++];
+    }
+    else
+    {
+        int rc = context->getNextChild(frame->node, frame->cursor, &child);
+        if (rc == 0)
+        {
+            return NULL;
+        }
+        if (rc < 0)
+        {
+            child = NULL;
+        }
+        ADD_STAT(context->stats, generated, child != NULL);
+        frame->child = child;
+    }
+
+    if (child == NULL) //found error
+    {
+        frame->failed = TRUE;
         return NULL;
     }
+    return child;
+}
 
-    if ((newVal = getVal(newCandidate)) > bestVal && newVal <= best)
+/**
+ * @brief Compares the best valued node of the subtree of the given frame's last child against the
+ * frame's best candidate, and keeps the better one.
+ * If some nodes share the best value, the first one encountered is kept.
+ * @param context the search's callbacks and settings.
+ * @param frame the given frame.
+ * @param newCandidate the best valued node of the child's subtree; NULL in case of an error.
+ * Owned by the function.
+ */
+static void updateBestCandidate(const SearchContext* context, SearchFrame* frame,
+                                pNode newCandidate)
+{
+    if (frame->child != NULL)
     {
-        freeNode(bestCandidate);
-        return newCandidate;
+        //children constructed one at a time are freed as soon as they were searched.
+        context->freeNode(frame->child);
+        frame->child = NULL;
+    }
+    if (newCandidate == NULL) //found error
+    {
+        frame->failed = TRUE;
+        return;
     }
 
-    freeNode(newCandidate);
-    return bestCandidate;
+    unsigned int newVal = context->getVal(newCandidate);
+    if (newVal > frame->bestVal && newVal <= context->best)
+    {
+        if (frame->bestCandidate != NULL)
+        {
+            context->freeNode(frame->bestCandidate);
+        }
+        frame->bestCandidate = newCandidate;
+        frame->bestVal = newVal;
+        return;
+    }
+    context->freeNode(newCandidate);
 }
 
 /**
- * See documentation for getBest().
+ * @brief ends the search of the given frame's subtree and releases the frame's children.
+ * @param context the search's callbacks and settings.
+ * @param frame the given frame.
+ * @return a copy of the best valued node of the subtree, or NULL in case of an error.
  */
-static pNode getSubtreeBest(pNode current, getNodeChildrenFunc getChildren, getNodeValFunc getVal,
-                            freeNodeFunc freeNode, copyNodeFunc copy, unsigned int best)
+static pNode leaveNode(const SearchContext* context, SearchFrame* frame)
+{
+    for (unsigned int i = 0; i < frame->numChildren; i++)
+    {
+        context->freeNode(frame->children[i]);
+        frame->children[i] = NULL;
+    }
+    dfsFree(frame->children);
+
+    if (frame->failed)
+    {
+        if (frame->bestCandidate != NULL)
+        {
+            context->freeNode(frame->bestCandidate);
+        }
+        return NULL;
+    }
+    //a subtree cut short by cancellation or by the budget is neither backtracked from nor dead,
+    //as it may still hold the best value.
+    if (frame->bestVal != context->best && !isCancelled(context))
+    {
+        ADD_STAT(context->stats, backtracks, 1);
+        addDeadNode(context->table, frame->node);
+    }
+    return frame->bestCandidate != NULL ? frame->bestCandidate : copyNode(context, frame->node);
+}
+
+pNode getSubtreeBest(const SearchContext* context, pNode current, unsigned int depth)
 {
     assert(current != NULL);
 
-    //check to see if has best value
-    unsigned int val = getVal(current);
-    if (val == best)
+    //the path from current to the node being searched is kept on an explicit stack, so the depth
+    //of the tree is bounded by the heap instead of the thread's stack.
+    FrameStack stack = {NULL, 0, 0};
+    pNode result = NULL;
+    int entered = enterNode(context, &stack, current, depth, &result);
+    while (entered && stack.count > 0)
     {
-        return copy(current);
+        SearchFrame* frame = &stack.frames[stack.count - 1];
+        pNode child = nextChild(context, frame);
+        if (child == NULL)
+        {
+            result = leaveNode(context, frame);
+            stack.count--;
+            if (stack.count > 0)
+            {
+                updateBestCandidate(context, &stack.frames[stack.count - 1], result);
+            }
+        }
+        else if (!enterNode(context, &stack, child, frame->depth + 1, &result))
+        {
+            updateBestCandidate(context, &stack.frames[stack.count - 1], result);
+        }
     }
+    MAX_STAT(context->stats, stackBytes, stack.capacity * sizeof(SearchFrame));
+    free(stack.frames);
+    return result;
+}
 
-    //generate children list
-    pNode *children;
-    int numChildren = getChildren(current, &children);
-    if (children == NULL)
+/**
+ * @brief searches the tree rooted at head with the given context, allocating the nodes of the
+ * search from an arena of its own, and with a transposition table of its own if the calling
+ * thread has its settings.
+ * @param context the search's callbacks and settings; its table is set by the function.
+ * @param head the root of the tree.
+ * @return a copy of the best valued node in the tree, allocated outside of the arena; NULL in
+ * case of an error.
+ */
+static pNode searchInArena(SearchContext* context, pNode head)
+{
+    if (newTable(context->copy, context->freeNode, &context->table) != SUCCESS_EXIT)
+    {
+        return NULL;
+    }
+    //without an arena the search simply allocates from malloc().
+    NodeArena* arena = newArena();
+    NodeArena* previous = swapActiveArena(arena);
+    pNode result = getSubtreeBest(context, head, 0);
+    swapActiveArena(previous);
+    if (arena != NULL && result != NULL)
     {
-        return copy(current);
+        //the result outlives the arena, so it is copied out of it.
+        result = copyNode(context, result);
     }
-    if (numChildren < 0)
+    freeArena(arena);
+    freeTable(context->table);
+    context->table = NULL;
+    return result;
+}
+
+pNode getBest(pNode head, getNodeChildrenFunc getChildren, getNodeValFunc getVal,
+              freeNodeFunc freeNode, copyNodeFunc copy, unsigned int best)
+{
+    if (head == NULL || getChildren == NULL || getVal == NULL || freeNode == NULL || copy == NULL)
     {
-        free(children);
         return NULL;
     }
+    SearchContext context = {getChildren, NULL, getVal, freeNode, copy, best, NULL,
+                             getActiveStats(), NULL, NULL};
+    return searchInArena(&context, head);
+}
 
-    //create best candidate
-    pNode bestCandidate = copy(current);
-    for (unsigned int i = 0; i < (unsigned int)numChildren && getVal(bestCandidate) != best; i++)
+pNode getBestLazy(pNode head, getNextChildFunc getNextChild, getNodeValFunc getVal,
+                  freeNodeFunc freeNode, copyNodeFunc copy, unsigned int best)
+{
+    if (head == NULL || getNextChild == NULL || getVal == NULL || freeNode == NULL || copy == NULL)
     {
-        bestCandidate = updateBestCandidate(bestCandidate, children[i], getChildren,
-                                            getVal, freeNode, copy, best);
-        if (bestCandidate == NULL) //found error
+        return NULL;
+    }
+    SearchContext context = {NULL, getNextChild, getVal, freeNode, copy, best, NULL,
+                             getActiveStats(), NULL, NULL};
+    return searchInArena(&context, head);
+}
+
+pNode getBestBudgeted(pNode head, getNodeChildrenFunc getChildren, getNodeValFunc getVal,
+                      freeNodeFunc freeNode, copyNodeFunc copy, unsigned int best,
+                      const DfsBudget* budget, int* finished)
+{
+    if (head == NULL || getChildren == NULL || getVal == NULL || freeNode == NULL ||
+        copy == NULL || finished == NULL)
+    {
+        return NULL;
+    }
+    SearchBudget state;
+    startBudget(&state, budget);
+    SearchContext context = {getChildren, NULL, getVal, freeNode, copy, best, NULL,
+                             getActiveStats(), &state, NULL};
+    pNode result = searchInArena(&context, head);
+    //a budget running out on the node with the best value cut nothing off.
+    *finished = !state.exhausted || (result != NULL && getVal(result) == best);
+    return result;
+}
+
+// -------------------------- in-place search -------------------------
+
+/**
+ * @brief The state of a single in-place search.
+ */
+typedef struct InPlaceSearch
+{
+    getNodeMovesFunc getMoves;
+    applyMoveFunc applyMove;
+    undoMoveFunc undoMove;
+    getNodeValFunc getVal;
+    freeNodeFunc freeNode;
+    copyNodeFunc copy;
+    unsigned int best;
+    MoveStack stack;
+    pNode bestCandidate;
+    unsigned int bestVal;
+    DfsStats* stats;
+    //the search's budget; NULL for no limits.
+    SearchBudget* budget;
+    //the subtrees known to hold no node with the best value; NULL for no table.
+    TranspositionTable* table;
+} InPlaceSearch;
+
+int reserveMoves(MoveStack* stack, size_t base)
+{
+    if (base + stack->maxMoves <= stack->capacity)
+    {
+        return TRUE;
+    }
+    size_t capacity = 2 * stack->capacity;
+    if (capacity < base + stack->maxMoves)
+    {
+        capacity = base + stack->maxMoves;
+    }
+    Move* moves = (Move*)realloc(stack->moves, capacity * sizeof(Move));
+    if (moves == NULL)
+    {
+        return FALSE;
+    }
+    stack->moves = moves;
+    stack->capacity = capacity;
+    return TRUE;
+}
+
+MoveLevel* pushLevel(MoveStack* stack)
+{
+    size_t base = stack->numLevels > 0 ? stack->levels[stack->numLevels - 1].end : 0;
+    if (!reserveMoves(stack, base))
+    {
+        return NULL;
+    }
+    if (stack->numLevels == stack->levelCapacity)
+    {
+        size_t capacity = stack->levelCapacity ? 2 * stack->levelCapacity : INITIAL_LEVELS;
+        MoveLevel* levels = (MoveLevel*)realloc(stack->levels, capacity * sizeof(MoveLevel));
+        if (levels == NULL)
         {
-            break;
+            return NULL;
         }
+        stack->levels = levels;
+        stack->levelCapacity = capacity;
     }
+    MoveLevel* level = &stack->levels[stack->numLevels++];
+    level->base = base;
+    level->end = base;
+    level->next = base;
+    level->found = 0;
+    return level;
+}
 
-    //free children
-    for (unsigned int i = 0; i < (unsigned int)numChildren; i++)
+void popLevel(MoveStack* stack, pNode node, undoMoveFunc undoMove)
+{
+    assert(stack->numLevels > 0);
+    stack->numLevels--;
+    if (stack->numLevels > 0)
     {
-        freeNode(children[i]);
-        children[i] = NULL;
+        undoMove(node, stack->moves[stack->levels[stack->numLevels - 1].next - 1]);
     }
-    free(children);
+}
 
+void freeMoveStack(MoveStack* stack, DfsStats* stats)
+{
+    //the stacks never shrink, so their final size is their peak size.
+    MAX_STAT(stats, stackBytes,
+             stack->capacity * sizeof(Move) + stack->levelCapacity * sizeof(MoveLevel));
+    free(stack->moves);
+    free(stack->levels);
+    stack->moves = NULL;
+    stack->capacity = 0;
+    stack->levels = NULL;
+    stack->numLevels = 0;
+    stack->levelCapacity = 0;
+}
+
+/**
+ * @brief visits the current state of the given node: updates the best candidate of the search,
+ * and pushes a level holding the moves of the node unless it has the best value or the
+ * search's budget is exhausted.
+ * @param search the given search.
+ * @param node the given node.
+ * @param depth the level of the node's current state in the whole tree.
+ * @return SUCCESS_EXIT, or ERROR in case of an error, in which case no level is pushed.
+ */
+static int visitState(InPlaceSearch* search, pNode node, unsigned int depth)
+{
+    //a state the budget has no room for is not visited.
+    if (chargeNode(search->budget))
+    {
+        return SUCCESS_EXIT;
+    }
+    ADD_STAT(search->stats, nodes, 1);
+    ADD_STAT(search->stats, explored, depth > 0);
+    MAX_STAT(search->stats, maxDepth, depth);
+    unsigned int val = search->getVal(node);
+    if (val > search->bestVal)
+    {
+        ADD_STAT(search->stats, copies, 1);
+        pNode newCandidate = search->copy(node);
+        if (newCandidate == NULL)
+        {
+            return ERROR;
+        }
+        search->freeNode(search->bestCandidate);
+        search->bestCandidate = newCandidate;
+        search->bestVal = val;
+    }
+    if (val == search->best)
+    {
+        return SUCCESS_EXIT;
+    }
+    //a state whose subtree was already searched in vain, by another path, is not expanded again.
+    if (isDeadNode(search->table, node))
+    {
+        ADD_STAT(search->stats, transpositions, 1);
+        return SUCCESS_EXIT;
+    }
+
+    MoveLevel* level = pushLevel(&search->stack);
+    if (level == NULL)
+    {
+        return ERROR;
+    }
+    int numMoves = search->getMoves(node, search->stack.moves + level->base);
+    if (numMoves < 0)
+    {
+        search->stack.numLevels--;
+        return ERROR;
+    }
+    ADD_STAT(search->stats, generated, (unsigned int)numMoves);
+    level->end = level->base + (size_t)numMoves;
+    return SUCCESS_EXIT;
+}
+
+/**
+ * @brief searches the subtree rooted at the current state of the given node and updates the best
+ * candidate of the search. The path from the node to the state being searched is kept on the
+ * search's explicit stack rather than on the thread's stack. The node is back in its current
+ * state when the function returns.
+ * @param search the given search; its stack holds no level.
+ * @param node the given node.
+ * @return SUCCESS_EXIT, or ERROR in case of an error.
+ */
+static int searchInPlace(InPlaceSearch* search, pNode node)
+{
+    MoveStack* stack = &search->stack;
+    int rc = visitState(search, node, 0);
+    while (rc == SUCCESS_EXIT && stack->numLevels > 0)
+    {
+        MoveLevel* level = &stack->levels[stack->numLevels - 1];
+        int exhausted = search->budget != NULL && search->budget->exhausted;
+        if (level->next == level->end || search->bestVal == search->best || exhausted)
+        {
+            //a subtree cut short by the budget is neither backtracked from nor dead, as it may
+            //still hold the best value.
+            if (search->bestVal != search->best && !exhausted)
+            {
+                ADD_STAT(search->stats, backtracks, 1);
+                addDeadNode(search->table, node);
+            }
+            popLevel(stack, node, search->undoMove);
+            continue;
+        }
+
+        Move move = stack->moves[level->next++];
+        int applied = search->applyMove(node, move);
+        if (applied <= 0)
+        {
+            rc = applied < 0 ? ERROR : rc;
+            continue;
+        }
+        size_t numLevels = stack->numLevels;
+        rc = visitState(search, node, (unsigned int)numLevels);
+        if (stack->numLevels == numLevels)
+        {
+            //no level was pushed for the new state, so the search is done with it.
+            search->undoMove(node, move);
+        }
+    }
+
+    //after an error, the moves applied along the path are undone.
+    while (stack->numLevels > 0)
+    {
+        popLevel(stack, node, search->undoMove);
+    }
+    return rc;
+}
+
+/**
+ * @brief Finds the best valued node in the tree rooted at head like getBestInPlace(), within the
+ * given budget state.
+ * @param head the root of the tree; restored before the function returns.
+ * @param getMoves a function listing the moves leading to the children of a node.
+ * @param applyMove a function applying a move to a node.
+ * @param undoMove a function reverting the last applied move.
+ * @param getVal a function returning the value of a node.
+ * @param freeNode a function freeing a node.
+ * @param copy a function copying a node.
+ * @param maxMoves the maximal number of moves getMoves may write for a single node.
+ * @param best the best possible value of a node.
+ * @param budget the search's budget state; NULL for no limits.
+ * @return a copy of the best valued node found. NULL in case of an error.
+ */
+static pNode searchMoves(pNode head, getNodeMovesFunc getMoves, applyMoveFunc applyMove,
+                         undoMoveFunc undoMove, getNodeValFunc getVal, freeNodeFunc freeNode,
+                         copyNodeFunc copy, unsigned int maxMoves, unsigned int best,
+                         SearchBudget* budget)
+{
+    if (activeBackjumping != NULL && activeBackjumping->explainConflict != NULL)
+    {
+        return searchBackjumping(head, getMoves, applyMove, undoMove, getVal, freeNode, copy,
+                                 maxMoves, best, activeBackjumping, budget);
+    }
+    InPlaceSearch search = {getMoves, applyMove, undoMove, getVal, freeNode, copy, best,
+                            {NULL, 0, maxMoves, NULL, 0, 0}, NULL, 0, getActiveStats(), budget,
+                            NULL};
+    if (newTable(copy, freeNode, &search.table) != SUCCESS_EXIT)
+    {
+        return NULL;
+    }
+    ADD_STAT(search.stats, copies, 1);
+    search.bestCandidate = copy(head);
+    if (search.bestCandidate == NULL)
+    {
+        freeTable(search.table);
+        return NULL;
+    }
+    search.bestVal = getVal(head);
+
+    if (searchInPlace(&search, head) != SUCCESS_EXIT)
+    {
+        freeNode(search.bestCandidate);
+        search.bestCandidate = NULL;
+    }
+    freeMoveStack(&search.stack, search.stats);
+    freeTable(search.table);
+    return search.bestCandidate;
+}
+
+/**
+ * @brief return the node budget of the given run of a restarting search.
+ * @param restarts the search's restart settings.
+ * @param run the given run, counted from 0.
+ * @return the number of nodes; saturates at ULLONG_MAX.
+ */
+static unsigned long long restartNodes(const DfsRestarts* restarts, unsigned int run)
+{
+    if (restarts->schedule == LUBY_RESTARTS)
+    {
+        //the sequence is made of blocks of 2^k - 1 terms: the block before twice, then 2^(k - 1).
+        //A run in the repeated part is the matching run of the block before.
+        unsigned long long blockSize = 1;
+        unsigned int exponent = 0;
+        while (blockSize < (unsigned long long)run + 1)
+        {
+            blockSize = 2 * blockSize + 1;
+            exponent++;
+        }
+        while (blockSize - 1 != run)
+        {
+            blockSize = (blockSize - 1) / 2;
+            exponent--;
+            run = (unsigned int)(run % blockSize);
+        }
+        return exponent < 64 && restarts->unitNodes <= (ULLONG_MAX >> exponent) ?
+               restarts->unitNodes << exponent : ULLONG_MAX;
+    }
+    unsigned long long nodes = restarts->unitNodes;
+    for (unsigned int r = 0; r < run && nodes < ULLONG_MAX; r++)
+    {
+        unsigned long long factor = nodes / GEOMETRIC_GROWTH_DIVISOR;
+        nodes = nodes <= ULLONG_MAX - factor ? nodes + factor : ULLONG_MAX;
+    }
+    return nodes;
+}
+
+/**
+ * @brief Finds the best valued node in the tree rooted at head like searchMoves(), restarting as
+ * set by setDfsRestarts(): each run is a searchMoves() limited to its own node budget as well as
+ * to what is left of the given one.
+ * @param head the root of the tree; restored before the function returns.
+ * @param getMoves a function listing the moves leading to the children of a node.
+ * @param applyMove a function applying a move to a node.
+ * @param undoMove a function reverting the last applied move.
+ * @param getVal a function returning the value of a node.
+ * @param freeNode a function freeing a node.
+ * @param copy a function copying a node.
+ * @param maxMoves the maximal number of moves getMoves may write for a single node.
+ * @param best the best possible value of a node.
+ * @param budget the search's budget state; NULL for no limits.
+ * @return a copy of the best valued node found in all runs. NULL in case of an error.
+ */
+static pNode searchRestarting(pNode head, getNodeMovesFunc getMoves, applyMoveFunc applyMove,
+                              undoMoveFunc undoMove, getNodeValFunc getVal, freeNodeFunc freeNode,
+                              copyNodeFunc copy, unsigned int maxMoves, unsigned int best,
+                              SearchBudget* budget)
+{
+    const DfsRestarts* restarts = activeRestarts;
+    if (restarts == NULL || restarts->unitNodes == 0 || restarts->restartNode == NULL)
+    {
+        return searchMoves(head, getMoves, applyMove, undoMove, getVal, freeNode, copy, maxMoves,
+                           best, budget);
+    }
+    SearchBudget unlimited;
+    if (budget == NULL)
+    {
+        startBudget(&unlimited, NULL);
+        budget = &unlimited;
+    }
+
+    pNode bestCandidate = NULL;
+    unsigned int bestVal = 0;
+    unsigned int run = 0;
+    for (;; run++)
+    {
+        if (run > 0)
+        {
+            ADD_STAT(getActiveStats(), restarts, 1);
+            restarts->restartNode(head, run);
+        }
+        unsigned long long runNodes = restartNodes(restarts, run);
+        int ownLimit = !budget->limitNodes || runNodes < budget->nodesLeft;
+        SearchBudget state = *budget;
+        state.limitNodes = TRUE;
+        state.nodesLeft = ownLimit ? runNodes : budget->nodesLeft;
+        state.outOfNodes = FALSE;
+        unsigned long long startNodes = state.nodesLeft;
+        pNode candidate = searchMoves(head, getMoves, applyMove, undoMove, getVal, freeNode, copy,
+                                      maxMoves, best, &state);
+
+        int outOfNodes = state.outOfNodes;
+        if (budget->limitNodes)
+        {
+            budget->nodesLeft -= startNodes - state.nodesLeft;
+        }
+        budget->untilClock = state.untilClock;
+        budget->exhausted = state.exhausted && (!outOfNodes || !ownLimit);
+        budget->outOfNodes = outOfNodes && !ownLimit;
+        if (candidate == NULL)
+        {
+            if (bestCandidate != NULL)
+            {
+                freeNode(bestCandidate);
+            }
+            bestCandidate = NULL;
+            break;
+        }
+
+        unsigned int val = getVal(candidate);
+        if (bestCandidate == NULL || val > bestVal)
+        {
+            if (bestCandidate != NULL)
+            {
+                freeNode(bestCandidate);
+            }
+            bestCandidate = candidate;
+            bestVal = val;
+        }
+        else
+        {
+            freeNode(candidate);
+        }
+        //only a run cut off by its own budget, before it found the best value, is started over.
+        if (!outOfNodes || !ownLimit || val == best)
+        {
+            break;
+        }
+    }
+    if (run > 0)
+    {
+        restarts->restartNode(head, 0);
+    }
     return bestCandidate;
 }
 
-pNode getBest(pNode head, getNodeChildrenFunc getChildren, getNodeValFunc getVal,
-              freeNodeFunc freeNode, copyNodeFunc copy, unsigned int best)
+/**
+ * @brief Finds the best valued node in the tree rooted at head like searchRestarting(), drawing
+ * the candidates the search copies from an arena private to the search.
+ * @param head the root of the tree; restored before the function returns.
+ * @param getMoves a function listing the moves leading to the children of a node.
+ * @param applyMove a function applying a move to a node.
+ * @param undoMove a function reverting the last applied move.
+ * @param getVal a function returning the value of a node.
+ * @param freeNode a function freeing a node.
+ * @param copy a function copying a node.
+ * @param maxMoves the maximal number of moves getMoves may write for a single node.
+ * @param best the best possible value of a node.
+ * @param budget the search's budget state; NULL for no limits.
+ * @return a copy of the best valued node found, allocated outside of the arena. NULL in case of
+ * an error.
+ */
+static pNode searchMovesInArena(pNode head, getNodeMovesFunc getMoves, applyMoveFunc applyMove,
+                                undoMoveFunc undoMove, getNodeValFunc getVal,
+                                freeNodeFunc freeNode, copyNodeFunc copy, unsigned int maxMoves,
+                                unsigned int best, SearchBudget* budget)
 {
-    if (head == NULL || getChildren == NULL || getVal == NULL || freeNode == NULL || copy == NULL)
+    //without an arena the search simply allocates from malloc().
+    NodeArena* arena = newArena();
+    NodeArena* previous = swapActiveArena(arena);
+    pNode result = searchRestarting(head, getMoves, applyMove, undoMove, getVal, freeNode, copy,
+                                    maxMoves, best, budget);
+    swapActiveArena(previous);
+    if (arena != NULL && result != NULL)
+    {
+        //the result outlives the arena, so it is copied out of it.
+        ADD_STAT(getActiveStats(), copies, 1);
+        result = copy(result);
+    }
+    freeArena(arena);
+    return result;
+}
+
+pNode getBestInPlace(pNode head, getNodeMovesFunc getMoves, applyMoveFunc applyMove,
+                     undoMoveFunc undoMove, getNodeValFunc getVal, freeNodeFunc freeNode,
+                     copyNodeFunc copy, unsigned int maxMoves, unsigned int best)
+{
+    if (head == NULL || getMoves == NULL || applyMove == NULL || undoMove == NULL ||
+        getVal == NULL || freeNode == NULL || copy == NULL)
+    {
+        return NULL;
+    }
+    return searchMovesInArena(head, getMoves, applyMove, undoMove, getVal, freeNode, copy,
+                              maxMoves, best, NULL);
+}
+
+pNode getBestInPlaceBudgeted(pNode head, getNodeMovesFunc getMoves, applyMoveFunc applyMove,
+                             undoMoveFunc undoMove, getNodeValFunc getVal, freeNodeFunc freeNode,
+                             copyNodeFunc copy, unsigned int maxMoves, unsigned int best,
+                             const DfsBudget* budget, int* finished)
+{
+    if (head == NULL || getMoves == NULL || applyMove == NULL || undoMove == NULL ||
+        getVal == NULL || freeNode == NULL || copy == NULL || finished == NULL)
     {
         return NULL;
     }
-    return getSubtreeBest(head, getChildren, getVal, freeNode, copy, best);
+    SearchBudget state;
+    startBudget(&state, budget);
+    pNode result = searchMovesInArena(head, getMoves, applyMove, undoMove, getVal, freeNode, copy,
+                                      maxMoves, best, &state);
+    //a budget running out on the node with the best value cut nothing off.
+    *finished = !state.exhausted || (result != NULL && getVal(result) == best);
+    return result;
 }
@@ -0,0 +1,473 @@
+#ifndef EX3_GENERICDFS_H
+#define EX3_GENERICDFS_H
+
+#include <stddef.h>
+
+// -------------------------- macros -------------------------
+
+//number of words in a child cursor, see getNextChildFunc.
+#define CHILD_CURSOR_WORDS 4
+
+// -------------------------- structs & typedef -------------------------
+
+/**
+ * @brief a void pointer
+ */
+typedef void* pNode;
+
+/**
+ * @brief An opaque move identifier; its meaning is defined by the client.
+ */
+typedef unsigned long Move;
+
+/**
+ * @brief Counts of the allocations served by dfsAlloc().
+ */
+typedef struct DfsAllocStats
+{
+    //number of dfsAlloc() calls.
+    unsigned long allocations;
+    //number of malloc() calls made to serve them, arena blocks included.
+    unsigned long mallocs;
+} DfsAllocStats;
+
+/**
+ * @brief Counts of the work done by searches, see setDfsStats().
+ */
+typedef struct DfsStats
+{
+    //number of nodes the searches visited.
+    unsigned long long nodes;
+    //number of visited nodes whose subtree was searched without finding a node with the best
+    //value.
+    unsigned long long backtracks;
+    //the deepest level visited; the head is on level 0.
+    unsigned int maxDepth;
+    //number of children constructed, or moves listed, and the number of them searched.
+    unsigned long long generated;
+    unsigned long long explored;
+    //number of nodes copied.
+    unsigned long long copies;
+    //the largest number of bytes a search's explicit stacks took; the stacks grow with the depth
+    //of the tree, by a fixed number of bytes per level, instead of the thread's stack.
+    unsigned long long stackBytes;
+    //number of visited nodes whose subtree was skipped, because the transposition table knew it
+    //holds no node with the best value, see setDfsHashing().
+    unsigned long long transpositions;
+    //number of levels backjumps went back over without trying their remaining moves, and of
+    //moves undone because they completed a learned nogood, see setDfsBackjumping().
+    unsigned long long backjumps;
+    unsigned long long nogoods;
+    //number of runs of restarting searches cut off by their node budget and started over, see
+    //setDfsRestarts().
+    unsigned long long restarts;
+} DfsStats;
+
+/**
+ * @brief Limits on the work of a budgeted search, see getBestBudgeted(). Once a limit is reached
+ * the search stops and returns the best node it found so far.
+ */
+typedef struct DfsBudget
+{
+    //the number of milliseconds the search may run for, counted from its start; 0 for no limit.
+    //The clock is read every few nodes, so the search may overrun it by the time of a few nodes.
+    unsigned long timeoutMs;
+    //the number of nodes the search may visit; 0 for no limit.
+    unsigned long long maxNodes;
+} DfsBudget;
+
+/**
+ * @brief return a hash of the given node, such that equal nodes, see equalNodeFunc, have equal
+ * hashes. It is called on every node a search with a transposition table visits, so it should
+ * not scan the whole node, but keep the hash up to date as the node is changed.
+ */
+typedef unsigned long long (*hashNodeFunc)(pNode node);
+
+/**
+ * @brief return whether the given nodes are equal: whether their subtrees are the same.
+ */
+typedef int (*equalNodeFunc)(pNode node, pNode other);
+
+/**
+ * @brief The settings of the transposition tables of searches, see setDfsHashing().
+ */
+typedef struct DfsHashing
+{
+    hashNodeFunc hashNode;
+    equalNodeFunc equalNode;
+    //the number of subtrees a table records at most; each takes a copy of its root.
+    size_t capacity;
+} DfsHashing;
+
+/**
+ * @brief explains a dead end of an in-place search: names the moves applied to the given node
+ * that together leave the node with no moves but the ones getMoves lists for it, if rejected is
+ * NULL, or that make applyMove reject the given move. Every applied move is named by its age: 1
+ * for the last move applied to the node, 2 for the one before it, and so on. The explanation
+ * must hold whatever other moves are applied, as long as the named ones are; the fewer and the
+ * older the moves named, the further back the search can jump.
+ * @param node the given node; back in its current state when the function returns.
+ * @param rejected the move applyMove just rejected, or NULL.
+ * @param ages for the result: the ages of the moves, each written once, with room for maxAge of
+ * them.
+ * @param maxAge the number of moves the search applied to the node; older moves were applied
+ * before the search, and are left out.
+ * @return the number of ages written, or a negative value if the dead end cannot be explained,
+ * in which case every applied move is taken as its cause.
+ */
+typedef int (*explainConflictFunc)(pNode node, const Move* rejected, unsigned int* ages
+                                   /*for the result*/, unsigned int maxAge);
+
+/**
+ * @brief The settings of backjumping searches, see setDfsBackjumping().
+ */
+typedef struct DfsBackjumping
+{
+    explainConflictFunc explainConflict;
+    //the number of nogoods a search learns at most; 0 to learn none.
+    size_t nogoodCapacity;
+} DfsBackjumping;
+
+/**
+ * @brief The schedules of the node budgets of the runs of restarting searches, see
+ * setDfsRestarts().
+ */
+typedef enum RestartSchedule
+{
+    //the budgets follow the Luby sequence, 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, ..., times the unit.
+    LUBY_RESTARTS,
+    //the first budget is the unit, and each budget is half again as large as the one before.
+    GEOMETRIC_RESTARTS
+} RestartSchedule;
+
+/**
+ * @brief prepares the given root of a restarting search for the run of the given number: changes
+ * the order the moves of the nodes are listed in, so that the run does not repeat the runs
+ * before it. Run 0 must restore the order of the first run.
+ */
+typedef void (*restartNodeFunc)(pNode node, unsigned int run);
+
+/**
+ * @brief The settings of restarting searches, see setDfsRestarts().
+ */
+typedef struct DfsRestarts
+{
+    RestartSchedule schedule;
+    //the number of nodes the budgets of the runs are multiples of.
+    unsigned long long unitNodes;
+    restartNodeFunc restartNode;
+} DfsRestarts;
+
+/**
+ * @brief constructs all the children of the given node and saves them into the given address of
+ * an array allocated with dfsAlloc(). Children known to have no node with the best value in
+ * their subtree may be left out; the searches then never see them, so on a tree without a node
+ * with the best value, the best node returned depends on what was left out.
+ * @return the number of children or a negative value in case of an error.
+ */
+typedef int (*getNodeChildrenFunc)(pNode node, pNode** children /*for the result*/);
+
+/**
+ * @brief constructs the next child of the given node: the first one the given cursor has not gone
+ * through yet, and advances the cursor past it. The cursor is an array of CHILD_CURSOR_WORDS
+ * words, all zero before the first call for the node; its meaning is defined by the client.
+ * @return a positive value if a child was constructed, zero if the node has no more children, or
+ * a negative value in case of an error.
+ */
+typedef int (*getNextChildFunc)(pNode node, unsigned long long* cursor, pNode* child
+                                /*for the result*/);
+
+/**
+ * @brief called with every node of the best value a counting search finds.
+ * @return zero to go on searching; a nonzero value to stop the search.
+ */
+typedef int (*visitNodeFunc)(pNode node, void* data);
+
+/**
+ * @brief return the value of the given node.
+ */
+typedef unsigned int (*getNodeValFunc)(pNode node);
+
+/**
+ * @brief free the given node.
+ */
+typedef void (*freeNodeFunc)(pNode node);
+
+/**
+ * @brief return a deep copy of the given node.
+ */
+typedef pNode (*copyNodeFunc)(pNode node);
+
+/**
+ * @brief writes the moves leading from the given node to its children into the given array.
+ * @return the number of moves or a negative value in case of an error.
+ */
+typedef int (*getNodeMovesFunc)(pNode node, Move* moves /*for the result*/);
+
+/**
+ * @brief applies the given move to the given node in place. A move may be rejected when the
+ * child it leads to is known to have no node with the best value in its subtree, with the same
+ * effect on the best node returned as a child left out by getNodeChildrenFunc.
+ * @return a positive value if the move was applied, zero if the move was rejected and the node
+ * is unchanged, or a negative value in case of an error.
+ */
+typedef int (*applyMoveFunc)(pNode node, Move move);
+
+/**
+ * @brief reverts the given move, which is the last move applied to the given node.
+ */
+typedef void (*undoMoveFunc)(pNode node, Move move);
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief Allocates memory for a node or a children array. During getBest(), getBestLazy(),
+ * getBestBudgeted(), getBestParallel(), getBestInPlace() and getBestInPlaceBudgeted() the memory
+ * is carved from an arena private to the search and the calling thread, and memory freed with
+ * dfsFree() is reused for allocations of the same size; the whole arena is released when the
+ * search returns. Elsewhere the memory comes from malloc().
+ * Nodes must be allocated with this function for the searches to use arenas; a node allocated
+ * during a search must not be used after the search returns, except for the returned node.
+ * @param bytes the number of bytes to allocate.
+ * @return the allocated memory, aligned for any node field; NULL if allocation failed.
+ */
+void* dfsAlloc(size_t bytes);
+
+/**
+ * @brief Frees memory allocated with dfsAlloc().
+ * @param ptr the given memory; may be NULL.
+ */
+void dfsFree(void* ptr);
+
+/**
+ * @brief Writes the process wide counts of the allocations served by dfsAlloc() so far.
+ * @param stats for the result: the counts.
+ */
+void getDfsAllocStats(DfsAllocStats* stats);
+
+/**
+ * @brief Makes the searches started by the calling thread add their counts to the given
+ * statistics, which are not reset. Searching with several threads, the counts of every thread
+ * are added once the search returns. The statistics stay zero if the library was built with
+ * DFS_STATS defined as 0.
+ * @param stats the given statistics; NULL to stop counting.
+ * @return the statistics counted into before.
+ */
+DfsStats* setDfsStats(DfsStats* stats);
+
+/**
+ * @brief Makes the getBest searches started by the calling thread, in place or not, keep a
+ * transposition table: a table of the subtrees found to hold no node with the best value, whose
+ * roots are recognized with the given callbacks. A node already in the table, reached again by
+ * another path, is not expanded; it stands for its subtree as a node without children does, so
+ * when the tree holds no node with the best value the returned node may not be the best valued
+ * one. The table is shared by all the threads of a search, which update it without locks; once
+ * it is full, or the slots a subtree hashes to are, the subtree is not recorded. It is released
+ * when the search returns.
+ * @param hashing the table's settings, which must stay valid while they are set; NULL for no
+ * table.
+ * @return the settings that were set before.
+ */
+const DfsHashing* setDfsHashing(const DfsHashing* hashing);
+
+/**
+ * @brief Makes the getBestInPlace() and getBestInPlaceBudgeted() searches started by the calling
+ * thread jump back over levels instead of backtracking one level at a time (conflict-directed
+ * backjumping). Every level keeps the set of earlier levels whose moves caused the dead ends
+ * found under it, as explained by explainConflict; once the level runs out of moves, the search
+ * goes straight back to the deepest of them, which inherits the rest of the set, and the levels
+ * in between are left without trying their remaining moves, since the same dead ends wait under
+ * each of them. With a nogood capacity, the search also learns the sets of moves that were
+ * behind a level running out, when they are short enough, and undoes any move that completes
+ * one of them again, on another path; the moves on a path must then be distinct. Only subtrees
+ * holding no node with the best value are skipped, so when the tree holds no node with the best
+ * value the returned node may not be the best valued one.
+ * @param backjumping the settings, which must stay valid while they are set; NULL to backtrack
+ * one level at a time.
+ * @return the settings that were set before.
+ */
+const DfsBackjumping* setDfsBackjumping(const DfsBackjumping* backjumping);
+
+/**
+ * @brief Makes the getBestInPlace() and getBestInPlaceBudgeted() searches started by the calling
+ * thread restart: search the tree in runs, each with a node budget of its own, as given by the
+ * schedule, which grows from run to run. A run cut off by its budget before it found a node with
+ * the best value is dropped, and restartNode prepares the root for the next run, which starts
+ * over from the root, trying the moves in another order; an unlucky order, which leads the search
+ * into a large subtree without a node with the best value, is thus cut short. The best valued
+ * node of all runs is returned, and the root is restored with run 0 before the search returns.
+ * The budget of a budgeted search covers all its runs.
+ * @param restarts the settings, which must stay valid while they are set; NULL, or a unit of 0,
+ * to search in a single run.
+ * @return the settings that were set before.
+ */
+const DfsRestarts* setDfsRestarts(const DfsRestarts* restarts);
+
+/**
+ * @brief Finds the best valued node in the tree rooted at head, using depth first search.
+ * The search stops as soon as a node with the given best value is found. The path from head to
+ * the node being searched is kept on an explicit stack on the heap, so deep trees do not need a
+ * large thread stack; see DfsStats for its size.
+ * @param head the root of the tree.
+ * @param getChildren a function constructing the children of a node.
+ * @param getVal a function returning the value of a node.
+ * @param freeNode a function freeing a node.
+ * @param copy a function copying a node.
+ * @param best the best possible value of a node.
+ * @return a copy of the best valued node in the tree; if some nodes share the best value, the
+ * first one encountered. NULL in case of an error.
+ */
+pNode getBest(pNode head, getNodeChildrenFunc getChildren, getNodeValFunc getVal,
+              freeNodeFunc freeNode, copyNodeFunc copy, unsigned int best);
+
+/**
+ * @brief Finds the best valued node in the tree rooted at head like getBest(), but constructs the
+ * children of a node one at a time, only when the search gets to them. Once a node with the best
+ * value is found, the remaining children are never constructed.
+ * @param head the root of the tree.
+ * @param getNextChild a function constructing the next child of a node.
+ * @param getVal a function returning the value of a node.
+ * @param freeNode a function freeing a node.
+ * @param copy a function copying a node.
+ * @param best the best possible value of a node.
+ * @return a copy of the best valued node in the tree, as for getBest(). NULL in case of an error.
+ */
+pNode getBestLazy(pNode head, getNextChildFunc getNextChild, getNodeValFunc getVal,
+                  freeNodeFunc freeNode, copyNodeFunc copy, unsigned int best);
+
+/**
+ * @brief Finds the best valued node in the tree rooted at head like getBest(), within the given
+ * budget. If the budget runs out first, the search stops and returns the best valued node found
+ * until then, ranked by getVal like getBest() ranks its candidates.
+ * @param head the root of the tree.
+ * @param getChildren a function constructing the children of a node.
+ * @param getVal a function returning the value of a node.
+ * @param freeNode a function freeing a node.
+ * @param copy a function copying a node.
+ * @param best the best possible value of a node.
+ * @param budget the limits on the search; NULL for none.
+ * @param finished for the result: TRUE if the search found a node with the best value or searched
+ * the whole tree; FALSE if it was cut off by the budget.
+ * @return a copy of the best valued node found. NULL in case of an error.
+ */
+pNode getBestBudgeted(pNode head, getNodeChildrenFunc getChildren, getNodeValFunc getVal,
+                      freeNodeFunc freeNode, copyNodeFunc copy, unsigned int best,
+                      const DfsBudget* budget, int* finished);
+
+/**
+ * @brief Finds the best valued node in the tree rooted at head like getBest(), using several
+ * threads. The top levels of the tree are split into tasks, which idle threads steal from busy
+ * ones; once a node with the best value is found, the other threads stop.
+ * The callbacks are called concurrently, but never concurrently on the same node. Programs
+ * using this function must be linked with -pthread.
+ * @param head the root of the tree.
+ * @param getChildren a function constructing the children of a node.
+ * @param getVal a function returning the value of a node.
+ * @param freeNode a function freeing a node.
+ * @param copy a function copying a node.
+ * @param best the best possible value of a node.
+ * @param numThreads the number of threads to search with; 0 for one per online processor.
+ * @return a copy of the best valued node in the tree, as for getBest(), except that if several
+ * nodes have the best value any one of them may be returned. NULL in case of an error.
+ */
+pNode getBestParallel(pNode head, getNodeChildrenFunc getChildren, getNodeValFunc getVal,
+                      freeNodeFunc freeNode, copyNodeFunc copy, unsigned int best,
+                      unsigned int numThreads);
+
+/**
+ * @brief Finds the best valued node in the tree rooted at head like getBest(), but walks the
+ * tree by applying and undoing moves on head itself instead of constructing the children.
+ * Only a copy of the best candidate found so far and a stack of at most maxMoves moves per level
+ * are kept; head is restored to its original state before the function returns.
+ * @param head the root of the tree; modified during the search.
+ * @param getMoves a function listing the moves leading to the children of a node.
+ * @param applyMove a function applying a move to a node.
+ * @param undoMove a function reverting the last applied move.
+ * @param getVal a function returning the value of a node.
+ * @param freeNode a function freeing a node.
+ * @param copy a function copying a node.
+ * @param maxMoves the maximal number of moves getMoves may write for a single node.
+ * @param best the best possible value of a node.
+ * @return a copy of the best valued node in the tree, as for getBest(). NULL in case of an error.
+ */
+pNode getBestInPlace(pNode head, getNodeMovesFunc getMoves, applyMoveFunc applyMove,
+                     undoMoveFunc undoMove, getNodeValFunc getVal, freeNodeFunc freeNode,
+                     copyNodeFunc copy, unsigned int maxMoves, unsigned int best);
+
+/**
+ * @brief Finds the best valued node in the tree rooted at head like getBestInPlace(), within the
+ * given budget, as getBestBudgeted() does.
+ * @param head the root of the tree; modified during the search, and restored before the function
+ * returns.
+ * @param getMoves a function listing the moves leading to the children of a node.
+ * @param applyMove a function applying a move to a node.
+ * @param undoMove a function reverting the last applied move.
+ * @param getVal a function returning the value of a node.
+ * @param freeNode a function freeing a node.
+ * @param copy a function copying a node.
+ * @param maxMoves the maximal number of moves getMoves may write for a single node.
+ * @param best the best possible value of a node.
+ * @param budget the limits on the search; NULL for none.
+ * @param finished for the result: TRUE if the search found a node with the best value or searched
+ * the whole tree; FALSE if it was cut off by the budget.
+ * @return a copy of the best valued node found. NULL in case of an error.
+ */
+pNode getBestInPlaceBudgeted(pNode head, getNodeMovesFunc getMoves, applyMoveFunc applyMove,
+                             undoMoveFunc undoMove, getNodeValFunc getVal, freeNodeFunc freeNode,
+                             copyNodeFunc copy, unsigned int maxMoves, unsigned int best,
+                             const DfsBudget* budget, int* finished);
+
+/**
+ * @brief Counts the nodes with the best value in the tree rooted at head, walking it by applying
+ * and undoing moves like getBestInPlace(). Nodes with the best value are not expanded. The
+ * search stops as soon as limit such nodes were found, or visit asks it to.
+ * @param head the root of the tree; modified during the search, and restored before the function
+ * returns.
+ * @param getMoves a function listing the moves leading to the children of a node.
+ * @param applyMove a function applying a move to a node.
+ * @param undoMove a function reverting the last applied move.
+ * @param getVal a function returning the value of a node.
+ * @param maxMoves the maximal number of moves getMoves may write for a single node.
+ * @param best the best possible value of a node.
+ * @param limit the number of nodes to stop at; 0 for no limit.
+ * @param visit a function called with every counted node, in the order they are found; may be
+ * NULL. The node is only valid during the call.
+ * @param data passed to visit.
+ * @param count for the result: the number of nodes with the best value found.
+ * @return 0 on success; a negative value in case of an error.
+ */
+int countBest(pNode head, getNodeMovesFunc getMoves, applyMoveFunc applyMove,
+              undoMoveFunc undoMove, getNodeValFunc getVal, unsigned int maxMoves,
+              unsigned int best, unsigned long limit, visitNodeFunc visit, void* data,
+              unsigned long* count);
+
+/**
+ * @brief Counts the nodes with the best value in the tree rooted at head like countBest(), using
+ * several threads. The top levels of the tree are split into subtrees by copying head and
+ * applying moves to the copies, and each thread counts the subtrees it takes in place.
+ * The callbacks are called concurrently, but never concurrently on the same node; visit is never
+ * called concurrently, and is called in no particular order. Programs using this function must be
+ * linked with -pthread.
+ * @param head the root of the tree; not modified.
+ * @param getMoves a function listing the moves leading to the children of a node.
+ * @param applyMove a function applying a move to a node.
+ * @param undoMove a function reverting the last applied move.
+ * @param getVal a function returning the value of a node.
+ * @param freeNode a function freeing a node.
+ * @param copy a function copying a node.
+ * @param maxMoves the maximal number of moves getMoves may write for a single node.
+ * @param best the best possible value of a node.
+ * @param limit the number of nodes to stop at; 0 for no limit.
+ * @param visit a function called with every counted node; may be NULL.
+ * @param data passed to visit.
+ * @param numThreads the number of threads to search with; 0 for one per online processor.
+ * @param count for the result: the number of nodes with the best value found.
+ * @return 0 on success; a negative value in case of an error.
+ */
+int countBestParallel(pNode head, getNodeMovesFunc getMoves, applyMoveFunc applyMove,
+                      undoMoveFunc undoMove, getNodeValFunc getVal, freeNodeFunc freeNode,
+                      copyNodeFunc copy, unsigned int maxMoves, unsigned int best,
+                      unsigned long limit, visitNodeFunc visit, void* data,
+                      unsigned int numThreads, unsigned long* count);
+
+#endif //EX3_GENERICDFS_H
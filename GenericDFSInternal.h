@@ -0,0 +1,339 @@
+#ifndef EX3_GENERICDFSINTERNAL_H
+#define EX3_GENERICDFSINTERNAL_H
+
+#include "GenericDFS.h"
+#include <stddef.h>
+
+// -------------------------- macros -------------------------
+
+//true.
+#define TRUE 1
+//false.
+#define FALSE 0
+//general error code.
+#define ERROR -1
+//success code.
+#define SUCCESS_EXIT 0
+
+//-----search statistics, see setDfsStats().
+//define as 0 to compile the counters out of the searches.
+#ifndef DFS_STATS
+#define DFS_STATS 1
+#endif
+#if DFS_STATS
+//adds n to the given counter of the given statistics, which may be NULL.
+#define ADD_STAT(stats, counter, n) \
+    do { if ((stats) != NULL) { (stats)->counter += (n); } } while (0)
+//raises the given counter of the given statistics, which may be NULL, to value.
+#define MAX_STAT(stats, counter, value) \
+    do { if ((stats) != NULL && (value) > (stats)->counter) { (stats)->counter = (value); } } \
+    while (0)
+#else
+#define ADD_STAT(stats, counter, n) ((void)(stats))
+#define MAX_STAT(stats, counter, value) ((void)(stats), (void)(value))
+#endif
+
+//-----search budgets, see DfsBudget.
+//number of nodes a budgeted search visits between two readings of the clock.
+#define CLOCK_CHECK_NODES 64
+
+// -------------------------- structs & typedef -------------------------
+
+/**
+ * @brief The state of a search's budget, see DfsBudget.
+ */
+typedef struct SearchBudget
+{
+    //the number of nodes the search may still visit, if it has a node limit.
+    unsigned long long nodesLeft;
+    int limitNodes;
+    //the CLOCK_MONOTONIC time the search stops at, in nanoseconds, if it has a deadline.
+    unsigned long long deadline;
+    int hasDeadline;
+    //the number of nodes to visit until the clock is read again.
+    unsigned int untilClock;
+    //TRUE once the budget is exhausted.
+    int exhausted;
+    //TRUE once the budget is exhausted by running out of nodes.
+    int outOfNodes;
+} SearchBudget;
+
+/**
+ * @brief A search's transposition table, see setDfsHashing().
+ */
+typedef struct TranspositionTable TranspositionTable;
+
+/**
+ * @brief The callbacks and settings shared by all the levels of a getBest() search.
+ */
+typedef struct SearchContext
+{
+    //children are constructed all at once by getChildren, or one at a time by getNextChild if
+    //it is not NULL.
+    getNodeChildrenFunc getChildren;
+    getNextChildFunc getNextChild;
+    getNodeValFunc getVal;
+    freeNodeFunc freeNode;
+    copyNodeFunc copy;
+    unsigned int best;
+    //when not NULL, the search stops early once the pointed flag is set.
+    const int* cancelled;
+    //the statistics the search counts into; may be NULL.
+    DfsStats* stats;
+    //when not NULL, the search stops early once the pointed budget is exhausted.
+    SearchBudget* budget;
+    //when not NULL, the subtrees known to hold no node with the best value.
+    TranspositionTable* table;
+} SearchContext;
+
+/**
+ * @brief A level on the current path of an in-place search. Its moves are the entries of the
+ * search's moves stack from base up to end, and next is the index of the next one to apply; while
+ * a deeper level is on the path, the move before next is the one applied to reach it.
+ */
+typedef struct MoveLevel
+{
+    size_t base;
+    size_t end;
+    size_t next;
+    //counting searches: the number of nodes the thread counted before the level was entered.
+    unsigned long found;
+} MoveLevel;
+
+/**
+ * @brief The moves and the levels of the current path of an in-place search, kept on explicit
+ * stacks instead of the thread's stack; a level owns the moves from its base index up to its end.
+ */
+typedef struct MoveStack
+{
+    Move* moves;
+    size_t capacity;
+    //the maximal number of moves of a single level.
+    unsigned int maxMoves;
+    MoveLevel* levels;
+    size_t numLevels;
+    size_t levelCapacity;
+} MoveStack;
+
+/**
+ * @brief A search's arena, see dfsAlloc().
+ */
+typedef struct NodeArena NodeArena;
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief Creates an empty arena.
+ * @return the new arena, or NULL if allocation failed.
+ */
+NodeArena* newArena(void);
+
+/**
+ * @brief Makes the given arena the one dfsAlloc() draws from on the calling thread.
+ * @param arena the given arena; NULL for malloc().
+ * @return the arena that was active before.
+ */
+NodeArena* swapActiveArena(NodeArena* arena);
+
+/**
+ * @brief Releases the given arena and all the memory allocated from it in one step. The arena
+ * must not be active on any thread.
+ * @param arena the given arena; may be NULL.
+ */
+void freeArena(NodeArena* arena);
+
+/**
+ * @brief return the statistics the searches of the calling thread count into, see setDfsStats().
+ * @return the statistics, or NULL.
+ */
+DfsStats* getActiveStats(void);
+
+/**
+ * @brief adds the counts of the given statistics to the given total.
+ * @param total the given total; may be NULL.
+ * @param stats the given statistics.
+ */
+void addDfsStats(DfsStats* total, const DfsStats* stats);
+
+/**
+ * @brief return the transposition table settings of the searches of the calling thread, see
+ * setDfsHashing().
+ * @return the settings, or NULL.
+ */
+const DfsHashing* getActiveHashing(void);
+
+/**
+ * @brief return the backjumping settings of the searches of the calling thread, see
+ * setDfsBackjumping().
+ * @return the settings, or NULL.
+ */
+const DfsBackjumping* getActiveBackjumping(void);
+
+/**
+ * @brief creates an empty transposition table for a search, with the settings of the calling
+ * thread.
+ * @param copy the search's function copying a node; the table records copies of the roots of
+ * the subtrees, allocated outside of the search's arenas.
+ * @param freeNode the search's function freeing a node.
+ * @param table for the result: the new table, or NULL if the calling thread has no settings.
+ * @return SUCCESS_EXIT, or ERROR if allocation failed.
+ */
+int newTable(copyNodeFunc copy, freeNodeFunc freeNode, TranspositionTable** table);
+
+/**
+ * @brief releases the given table and the nodes it recorded.
+ * @param table the given table; may be NULL.
+ */
+void freeTable(TranspositionTable* table);
+
+/**
+ * @brief checks whether the given table recorded the subtree of the given node.
+ * @param table the given table; may be NULL.
+ * @param node the given node.
+ * @return TRUE if the subtree is known to hold no node with the best value; FALSE otherwise.
+ */
+int isDeadNode(TranspositionTable* table, pNode node);
+
+/**
+ * @brief records the subtree of the given node, which holds no node with the best value, in the
+ * given table. Nothing is recorded if the table has no room for it or allocation fails; the table
+ * only speeds the search up.
+ * @param table the given table; may be NULL.
+ * @param node the given node; not modified.
+ */
+void addDeadNode(TranspositionTable* table, pNode node);
+
+/**
+ * @brief starts the given budget state off the given budget, reading the clock if it has a
+ * timeout.
+ * @param state for the result: the budget state.
+ * @param budget the given budget; may be NULL for no limits.
+ */
+void startBudget(SearchBudget* state, const DfsBudget* budget);
+
+/**
+ * @brief checks whether the deadline of the given budget state has passed, and marks the budget
+ * as exhausted if it has.
+ * @param state the given budget state.
+ * @return TRUE if the deadline has passed; FALSE otherwise.
+ */
+int checkDeadline(SearchBudget* state);
+
+/**
+ * @brief Finds the best valued node in the tree rooted at current, as getBest() does.
+ * If the context's cancelled flag is set, or its budget is exhausted during the search, the search
+ * stops early and returns the best candidate found until then.
+ * @param context the search's callbacks and settings.
+ * @param current the root of the tree; not freed.
+ * @param depth the level of current in the whole tree.
+ * @return a copy of the best valued node found, or NULL in case of an error.
+ */
+pNode getSubtreeBest(const SearchContext* context, pNode current, unsigned int depth);
+
+/**
+ * @brief Finds the best valued node in the tree rooted at head like getBestInPlace(), jumping
+ * back over levels with the given settings, see setDfsBackjumping().
+ * @param head the root of the tree; restored before the function returns.
+ * @param getMoves a function listing the moves leading to the children of a node.
+ * @param applyMove a function applying a move to a node.
+ * @param undoMove a function reverting the last applied move.
+ * @param getVal a function returning the value of a node.
+ * @param freeNode a function freeing a node.
+ * @param copy a function copying a node.
+ * @param maxMoves the maximal number of moves getMoves may write for a single node.
+ * @param best the best possible value of a node.
+ * @param backjumping the given settings.
+ * @param budget the search's budget state; NULL for no limits.
+ * @return a copy of the best valued node found. NULL in case of an error.
+ */
+pNode searchBackjumping(pNode head, getNodeMovesFunc getMoves, applyMoveFunc applyMove,
+                        undoMoveFunc undoMove, getNodeValFunc getVal, freeNodeFunc freeNode,
+                        copyNodeFunc copy, unsigned int maxMoves, unsigned int best,
+                        const DfsBackjumping* backjumping, SearchBudget* budget);
+
+/**
+ * @brief makes room for another level of moves on the given stack.
+ * @param stack the given stack.
+ * @param base the index the new level starts at.
+ * @return TRUE on success; FALSE if allocation failed.
+ */
+int reserveMoves(MoveStack* stack, size_t base);
+
+/**
+ * @brief pushes a level with room for maxMoves moves, starting after the moves of the top level,
+ * on the given stack. The new level has no moves yet.
+ * @param stack the given stack.
+ * @return the new level, or NULL if allocation failed.
+ */
+MoveLevel* pushLevel(MoveStack* stack);
+
+/**
+ * @brief pops the top level of the given stack, undoing the move that led to it, if any.
+ * @param stack the given stack.
+ * @param node the node the moves were applied to.
+ * @param undoMove a function reverting the last applied move.
+ */
+void popLevel(MoveStack* stack, pNode node, undoMoveFunc undoMove);
+
+/**
+ * @brief releases the memory of the given stack and empties it.
+ * @param stack the given stack.
+ * @param stats the statistics its peak size is reported to; may be NULL.
+ */
+void freeMoveStack(MoveStack* stack, DfsStats* stats);
+
+/**
+ * @brief copies the given node with the given search's copy function, counting the copy.
+ * @param context the given search.
+ * @param node the given node.
+ * @return the copy, or NULL if copying failed.
+ */
+static inline pNode copyNode(const SearchContext* context, pNode node)
+{
+    ADD_STAT(context->stats, copies, 1);
+    return context->copy(node);
+}
+
+/**
+ * @brief charges a visited node to the given budget state, marking the budget as exhausted once
+ * it has no nodes left or its deadline has passed.
+ * @param state the given budget state; may be NULL for no limits.
+ * @return TRUE if the budget is exhausted; FALSE otherwise.
+ */
+static inline int chargeNode(SearchBudget* state)
+{
+    if (state == NULL || state->exhausted)
+    {
+        return state != NULL;
+    }
+    if (state->limitNodes)
+    {
+        if (state->nodesLeft == 0)
+        {
+            state->exhausted = TRUE;
+            state->outOfNodes = TRUE;
+            return TRUE;
+        }
+        state->nodesLeft--;
+    }
+    //the clock is only read every CLOCK_CHECK_NODES nodes, which keeps its cost off the search.
+    if (state->hasDeadline && --state->untilClock == 0)
+    {
+        state->untilClock = CLOCK_CHECK_NODES;
+        return checkDeadline(state);
+    }
+    return FALSE;
+}
+
+/**
+ * @brief checks whether the given search was cancelled, or its budget is exhausted.
+ * @param context the given search.
+ * @return TRUE if the search should stop; FALSE otherwise.
+ */
+static inline int isCancelled(const SearchContext* context)
+{
+    return (context->cancelled != NULL && __atomic_load_n(context->cancelled, __ATOMIC_RELAXED)) ||
+           (context->budget != NULL && context->budget->exhausted);
+}
+
+#endif //EX3_GENERICDFSINTERNAL_H
@@ -0,0 +1,45 @@
+// -------------------------- includes -------------------------
+
+#include "LatencyHistogram.h"
+#include <math.h>
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief return the histogram bucket of the given latency.
+ * @param latency the given latency, in seconds.
+ * @return the bucket.
+ */
+static unsigned int latencyBucket(double latency)
+{
+    if (latency <= LATENCY_BASE)
+    {
+        return 0;
+    }
+    double bucket = log(latency / LATENCY_BASE) / log(LATENCY_GROWTH);
+    return bucket < LATENCY_BUCKETS - 1 ? (unsigned int)bucket : LATENCY_BUCKETS - 1;
+}
+
+void addLatency(LatencyHistogram* histogram, double latency)
+{
+    histogram->count++;
+    histogram->buckets[latencyBucket(latency)]++;
+    histogram->maxLatency = latency > histogram->maxLatency ? latency : histogram->maxLatency;
+}
+
+double latencyPercentile(const LatencyHistogram* histogram, double percentile)
+{
+    unsigned long rank = (unsigned long)ceil(percentile * (double)histogram->count);
+    unsigned long seen = 0;
+    unsigned int bucket = 0;
+    for (; bucket < LATENCY_BUCKETS - 1; bucket++)
+    {
+        seen += histogram->buckets[bucket];
+        if (seen >= rank && seen > 0)
+        {
+            break;
+        }
+    }
+    double latency = LATENCY_BASE * pow(LATENCY_GROWTH, bucket + 1);
+    return latency < histogram->maxLatency ? latency : histogram->maxLatency;
+}
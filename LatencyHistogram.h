@@ -0,0 +1,43 @@
+#ifndef EX3_LATENCYHISTOGRAM_H
+#define EX3_LATENCYHISTOGRAM_H
+
+// -------------------------- macros -------------------------
+
+//latencies are counted in buckets that grow by LATENCY_GROWTH, starting from LATENCY_BASE
+//seconds, so percentiles are exact to within LATENCY_GROWTH in constant memory.
+#define LATENCY_BUCKETS 2400
+#define LATENCY_BASE 1e-8
+#define LATENCY_GROWTH 1.01
+
+// -------------------------- structs & typedef -------------------------
+
+/**
+ * @brief A histogram of latencies; all zero when empty.
+ */
+typedef struct LatencyHistogram
+{
+    unsigned long count;
+    //the largest latency added, in seconds.
+    double maxLatency;
+    unsigned long buckets[LATENCY_BUCKETS];
+} LatencyHistogram;
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief adds the given latency to the given histogram.
+ * @param histogram the given histogram.
+ * @param latency the given latency, in seconds.
+ */
+void addLatency(LatencyHistogram* histogram, double latency);
+
+/**
+ * @brief return the given percentile of the latencies of the given histogram.
+ * @param histogram the given histogram.
+ * @param percentile the given percentile, between 0 and 1.
+ * @return the latency, in seconds: the upper end of the bucket holding it, or the largest latency
+ * if that is smaller; 0 if the histogram is empty.
+ */
+double latencyPercentile(const LatencyHistogram* histogram, double percentile);
+
+#endif //EX3_LATENCYHISTOGRAM_H
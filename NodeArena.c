@@ -0,0 +1,231 @@
+// -------------------------- includes -------------------------
+
+#include "GenericDFSInternal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// -------------------------- macros -------------------------
+
+//size of an arena's first block; each further block is twice the size of the previous one.
+#define FIRST_BLOCK_SIZE 16384
+//granularity of allocation sizes; keeps every allocation aligned for any node field.
+#define ALLOC_ALIGNMENT 16
+//number of distinct allocation sizes an arena keeps freed memory of.
+#define ARENA_SIZE_CLASSES 8
+
+// -------------------------- structs -------------------------
+
+/**
+ * @brief The header in front of every allocation made by dfsAlloc().
+ * bytes is the rounded size of the allocation; inArena tells whether it was carved from an arena
+ * block, in which case it must never be passed to free().
+ */
+typedef union AllocHeader
+{
+    struct
+    {
+        size_t bytes;
+        int inArena;
+    } info;
+    char padding[ALLOC_ALIGNMENT];
+} AllocHeader;
+
+/**
+ * @brief A block of memory allocations are carved from; the allocations follow the header.
+ */
+typedef union ArenaBlock
+{
+    union ArenaBlock* next;
+    char padding[ALLOC_ALIGNMENT];
+} ArenaBlock;
+
+/**
+ * @brief A list of freed allocations of the same size, linked through their first bytes.
+ */
+typedef struct FreeList
+{
+    size_t bytes;
+    void* head;
+} FreeList;
+
+struct NodeArena
+{
+    ArenaBlock* blocks;
+    char* top;
+    char* end;
+    size_t nextBlockSize;
+    unsigned int numLists;
+    FreeList lists[ARENA_SIZE_CLASSES];
+    unsigned long allocations;
+};
+
+// -------------------------- globals -------------------------
+
+//the arena dfsAlloc() draws from on the calling thread; NULL outside of searches.
+static __thread NodeArena* activeArena = NULL;
+
+//process wide counts of dfsAlloc() calls and of the malloc() calls made to serve them.
+static unsigned long totalAllocations = 0;
+static unsigned long totalMallocs = 0;
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief return the free list of the given size in the given arena, creating it if needed.
+ * @param arena the given arena.
+ * @param bytes the rounded allocation size.
+ * @return the free list, or NULL if the arena already tracks ARENA_SIZE_CLASSES other sizes.
+ */
+static FreeList* findFreeList(NodeArena* arena, size_t bytes)
+{
+    for (unsigned int i = 0; i < arena->numLists; i++)
+    {
+        if (arena->lists[i].bytes == bytes)
+        {
+            return &arena->lists[i];
+        }
+    }
+    if (arena->numLists == ARENA_SIZE_CLASSES)
+    {
+        return NULL;
+    }
+    FreeList* list = &arena->lists[arena->numLists++];
+    list->bytes = bytes;
+    list->head = NULL;
+    return list;
+}
+
+/**
+ * @brief carves an allocation of the given size from the given arena, reusing freed memory of the
+ * same size first.
+ * @param arena the given arena.
+ * @param bytes the rounded allocation size, including the header.
+ * @return the allocation's header, or NULL if allocation failed.
+ */
+static AllocHeader* arenaAlloc(NodeArena* arena, size_t bytes)
+{
+    FreeList* list = findFreeList(arena, bytes);
+    if (list != NULL && list->head != NULL)
+    {
+        AllocHeader* header = (AllocHeader*)list->head;
+        memcpy(&list->head, header, sizeof(void*));
+        return header;
+    }
+
+    if ((size_t)(arena->end - arena->top) < bytes)
+    {
+        while (arena->nextBlockSize < bytes)
+        {
+            arena->nextBlockSize *= 2;
+        }
+        ArenaBlock* block = (ArenaBlock*)malloc(sizeof(ArenaBlock) + arena->nextBlockSize);
+        if (block == NULL)
+        {
+            return NULL;
+        }
+        __atomic_add_fetch(&totalMallocs, 1, __ATOMIC_RELAXED);
+        block->next = arena->blocks;
+        arena->blocks = block;
+        arena->top = (char*)(block + 1);
+        arena->end = arena->top + arena->nextBlockSize;
+        arena->nextBlockSize *= 2;
+    }
+    AllocHeader* header = (AllocHeader*)arena->top;
+    arena->top += bytes;
+    return header;
+}
+
+void* dfsAlloc(size_t bytes)
+{
+    size_t total = sizeof(AllocHeader) +
+                   (bytes + ALLOC_ALIGNMENT - 1) / ALLOC_ALIGNMENT * ALLOC_ALIGNMENT;
+    NodeArena* arena = activeArena;
+    AllocHeader* header = NULL;
+    if (arena != NULL)
+    {
+        arena->allocations++;
+        header = arenaAlloc(arena, total);
+    }
+    if (header == NULL)
+    {
+        if (arena == NULL)
+        {
+            __atomic_add_fetch(&totalAllocations, 1, __ATOMIC_RELAXED);
+        }
+        header = (AllocHeader*)malloc(total);
+        if (header == NULL)
+        {
+            return NULL;
+        }
+        __atomic_add_fetch(&totalMallocs, 1, __ATOMIC_RELAXED);
+        header->info.inArena = FALSE;
+    }
+    else
+    {
+        header->info.inArena = TRUE;
+    }
+    header->info.bytes = total;
+    return header + 1;
+}
+
+void dfsFree(void* ptr)
+{
+    if (ptr == NULL)
+    {
+        return;
+    }
+    AllocHeader* header = (AllocHeader*)ptr - 1;
+    if (!header->info.inArena)
+    {
+        free(header);
+        return;
+    }
+
+    //arena memory outside of a search is reclaimed when its arena is freed.
+    FreeList* list = activeArena == NULL ? NULL : findFreeList(activeArena, header->info.bytes);
+    if (list != NULL)
+    {
+        memcpy(header, &list->head, sizeof(void*));
+        list->head = header;
+    }
+}
+
+void getDfsAllocStats(DfsAllocStats* stats)
+{
+    stats->allocations = __atomic_load_n(&totalAllocations, __ATOMIC_RELAXED);
+    stats->mallocs = __atomic_load_n(&totalMallocs, __ATOMIC_RELAXED);
+}
+
+NodeArena* newArena(void)
+{
+    NodeArena* arena = (NodeArena*)calloc(1, sizeof(NodeArena));
+    if (arena != NULL)
+    {
+        __atomic_add_fetch(&totalMallocs, 1, __ATOMIC_RELAXED);
+        arena->nextBlockSize = FIRST_BLOCK_SIZE;
+    }
+    return arena;
+}
+
+NodeArena* swapActiveArena(NodeArena* arena)
+{
+    NodeArena* previous = activeArena;
+    activeArena = arena;
+    return previous;
+}
+
+void freeArena(NodeArena* arena)
+{
+    if (arena == NULL)
+    {
+        return;
+    }
+    __atomic_add_fetch(&totalAllocations, arena->allocations, __ATOMIC_RELAXED);
+    while (arena->blocks != NULL)
+    {
+        ArenaBlock* next = arena->blocks->next;
+        free(arena->blocks);
+        arena->blocks = next;
+    }
+    free(arena);
+}
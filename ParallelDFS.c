@@ -0,0 +1,541 @@
+// -------------------------- includes -------------------------
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "GenericDFSInternal.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// -------------------------- macros -------------------------
+
+//deepest tree level that is still split into tasks.
+#define MAX_SPLIT_DEPTH 32
+//number of queued tasks per worker under which tasks are split into their children.
+#define TASKS_PER_WORKER 8
+//initial number of tasks a worker's deque has room for.
+#define DEQUE_CAPACITY 64
+
+// -------------------------- structs -------------------------
+
+/**
+ * @brief A subtree waiting to be searched.
+ * path holds the child indices leading from the head to the task's node; it orders the results
+ * of different tasks the way a sequential search would encounter them.
+ */
+typedef struct Task
+{
+    pNode node;
+    unsigned int depth;
+    unsigned int path[MAX_SPLIT_DEPTH];
+} Task;
+
+/**
+ * @brief A worker's double ended queue of tasks. The owner pushes and pops at the back; other
+ * workers steal from the front, which holds the tasks closest to the head.
+ */
+typedef struct TaskDeque
+{
+    pthread_mutex_t lock;
+    Task** tasks;
+    size_t capacity;
+    size_t front;
+    size_t count;
+} TaskDeque;
+
+/**
+ * @brief The state shared by the workers of a parallel search.
+ */
+typedef struct ParallelSearch
+{
+    SearchContext context;
+    int cancelled;
+    int failed;
+    unsigned int numWorkers;
+    TaskDeque* deques;
+    //tasks created but not finished yet, and tasks waiting in the deques.
+    size_t pending;
+    size_t queued;
+    unsigned int idleWorkers;
+    pthread_mutex_t idleLock;
+    pthread_cond_t idleCond;
+    pthread_mutex_t bestLock;
+    pNode bestCandidate;
+    unsigned int bestVal;
+    unsigned int bestDepth;
+    unsigned int bestPath[MAX_SPLIT_DEPTH];
+} ParallelSearch;
+
+/**
+ * @brief A worker thread's view of a parallel search.
+ */
+typedef struct Worker
+{
+    ParallelSearch* search;
+    unsigned int id;
+    //the arena the worker's nodes are allocated from; released once every worker is done.
+    NodeArena* arena;
+    //the search's context, counting into the worker's own statistics.
+    SearchContext context;
+    DfsStats stats;
+} Worker;
+
+// -------------------------- deque functions -------------------------
+
+/**
+ * @brief pushes the given task to the back of the given deque.
+ * @return SUCCESS_EXIT, or ERROR if allocation failed.
+ */
+static int pushBack(TaskDeque* deque, Task* task)
+{
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count == deque->capacity)
+    {
+        size_t capacity = deque->capacity ? 2 * deque->capacity : DEQUE_CAPACITY;
+        Task** tasks = (Task**)malloc(capacity * sizeof(Task*));
+        if (tasks == NULL)
+        {
+            pthread_mutex_unlock(&deque->lock);
+            return ERROR;
+        }
+        for (size_t i = 0; i < deque->count; i++)
+        {
+            tasks[i] = deque->tasks[(deque->front + i) % deque->capacity];
+        }
+        free(deque->tasks);
+        deque->tasks = tasks;
+        deque->capacity = capacity;
+        deque->front = 0;
+    }
+    deque->tasks[(deque->front + deque->count) % deque->capacity] = task;
+    deque->count++;
+    pthread_mutex_unlock(&deque->lock);
+    return SUCCESS_EXIT;
+}
+
+/**
+ * @brief removes a task from the given end of the given deque.
+ * @param deque the given deque.
+ * @param back TRUE to take the newest task; FALSE to take the oldest one.
+ * @return the task, or NULL if the deque is empty.
+ */
+static Task* takeTask(TaskDeque* deque, int back)
+{
+    Task* task = NULL;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count > 0)
+    {
+        deque->count--;
+        if (back)
+        {
+            task = deque->tasks[(deque->front + deque->count) % deque->capacity];
+        }
+        else
+        {
+            task = deque->tasks[deque->front];
+            deque->front = (deque->front + 1) % deque->capacity;
+        }
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return task;
+}
+
+// -------------------------- search functions -------------------------
+
+/**
+ * @brief checks whether the node at path a is encountered before the node at path b by a
+ * sequential search.
+ * @return TRUE if a comes first; FALSE otherwise.
+ */
+static int comesBefore(const unsigned int* a, unsigned int aDepth, const unsigned int* b,
+                       unsigned int bDepth)
+{
+    for (unsigned int i = 0; i < aDepth && i < bDepth; i++)
+    {
+        if (a[i] != b[i])
+        {
+            return a[i] < b[i];
+        }
+    }
+    return aDepth < bDepth;
+}
+
+/**
+ * @brief stops the search; the workers drop the remaining tasks.
+ * @param search the given search.
+ * @param failed TRUE if the search is stopped because of an error.
+ */
+static void cancelSearch(ParallelSearch* search, int failed)
+{
+    if (failed)
+    {
+        __atomic_store_n(&search->failed, TRUE, __ATOMIC_SEQ_CST);
+    }
+    __atomic_store_n(&search->cancelled, TRUE, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief compares the given candidate, found in the subtree of the given task, against the
+ * search's best candidate, and keeps the better one. A candidate with the best value cancels the
+ * rest of the search.
+ * @param search the given search.
+ * @param candidate the given candidate; owned by the function.
+ * @param task the task whose subtree holds the candidate.
+ */
+static void offerCandidate(ParallelSearch* search, pNode candidate, const Task* task)
+{
+    const SearchContext* context = &search->context;
+    unsigned int val = context->getVal(candidate);
+
+    pthread_mutex_lock(&search->bestLock);
+    if (val <= context->best &&
+        (search->bestCandidate == NULL || val > search->bestVal ||
+         (val == search->bestVal &&
+          comesBefore(task->path, task->depth, search->bestPath, search->bestDepth))))
+    {
+        if (search->bestCandidate != NULL)
+        {
+            context->freeNode(search->bestCandidate);
+        }
+        search->bestCandidate = candidate;
+        search->bestVal = val;
+        search->bestDepth = task->depth;
+        memcpy(search->bestPath, task->path, task->depth * sizeof(unsigned int));
+        candidate = NULL;
+        if (val == context->best)
+        {
+            cancelSearch(search, FALSE);
+        }
+    }
+    pthread_mutex_unlock(&search->bestLock);
+
+    if (candidate != NULL)
+    {
+        context->freeNode(candidate);
+    }
+}
+
+/**
+ * @brief queues a task for the given node on the given worker's deque.
+ * @param worker the given worker.
+ * @param node the task's node; owned by the task.
+ * @param parent the task of the node's parent; NULL for the head.
+ * @param index the node's index among its parent's children.
+ * @return SUCCESS_EXIT, or ERROR if allocation failed, in which case the node is freed.
+ */
+static int queueTask(Worker* worker, pNode node, const Task* parent, unsigned int index)
+{
+    ParallelSearch* search = worker->search;
+    Task* task = (Task*)malloc(sizeof(Task));
+    if (task == NULL)
+    {
+        search->context.freeNode(node);
+        return ERROR;
+    }
+    task->node = node;
+    task->depth = 0;
+    if (parent != NULL)
+    {
+        memcpy(task->path, parent->path, parent->depth * sizeof(unsigned int));
+        task->path[parent->depth] = index;
+        task->depth = parent->depth + 1;
+    }
+
+    __atomic_add_fetch(&search->pending, 1, __ATOMIC_SEQ_CST);
+    if (pushBack(&search->deques[worker->id], task) != SUCCESS_EXIT)
+    {
+        __atomic_sub_fetch(&search->pending, 1, __ATOMIC_SEQ_CST);
+        search->context.freeNode(node);
+        free(task);
+        return ERROR;
+    }
+    __atomic_add_fetch(&search->queued, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&search->idleWorkers, __ATOMIC_SEQ_CST) > 0)
+    {
+        pthread_mutex_lock(&search->idleLock);
+        pthread_cond_broadcast(&search->idleCond);
+        pthread_mutex_unlock(&search->idleLock);
+    }
+    return SUCCESS_EXIT;
+}
+
+/**
+ * @brief splits the given task into tasks for the children of its node.
+ * @param worker the given worker.
+ * @param task the given task.
+ * @return SUCCESS_EXIT, or ERROR in case of an error.
+ */
+static int splitTask(Worker* worker, Task* task)
+{
+    const SearchContext* context = &worker->context;
+    pNode* children = NULL;
+    ADD_STAT(context->stats, nodes, 1);
+    MAX_STAT(context->stats, maxDepth, task->depth);
+    int numChildren = context->getChildren(task->node, &children);
+    if (numChildren < 0)
+    {
+        dfsFree(children);
+        return ERROR;
+    }
+    ADD_STAT(context->stats, generated, (unsigned int)numChildren);
+
+    //queue in reverse, so the owner pops the first child first and thieves take the last ones.
+    int rc = SUCCESS_EXIT;
+    for (int i = numChildren - 1; i >= 0; i--)
+    {
+        if (rc != SUCCESS_EXIT || children[i] == NULL)
+        {
+            rc = ERROR;
+            if (children[i] != NULL)
+            {
+                context->freeNode(children[i]);
+            }
+            continue;
+        }
+        rc = queueTask(worker, children[i], task, (unsigned int)i);
+    }
+    dfsFree(children);
+
+    //the node precedes its children, so it is offered as a candidate of its own.
+    offerCandidate(worker->search, task->node, task);
+    task->node = NULL;
+    return rc;
+}
+
+/**
+ * @brief searches the subtree of the given task, splitting it into smaller tasks while the
+ * workers are short of tasks.
+ * @param worker the given worker.
+ * @param task the given task; freed by the function.
+ */
+static void runTask(Worker* worker, Task* task)
+{
+    ParallelSearch* search = worker->search;
+    const SearchContext* context = &worker->context;
+
+    if (!isCancelled(context))
+    {
+        unsigned int val = context->getVal(task->node);
+        size_t queued = __atomic_load_n(&search->queued, __ATOMIC_RELAXED);
+        //a node the transposition table knows is left to getSubtreeBest(), which skips it.
+        if (val != context->best && task->depth < MAX_SPLIT_DEPTH &&
+            queued < (size_t)search->numWorkers * TASKS_PER_WORKER &&
+            !isDeadNode(context->table, task->node))
+        {
+            //getSubtreeBest() counts the tasks it searches itself.
+            ADD_STAT(context->stats, explored, task->depth > 0);
+            if (splitTask(worker, task) != SUCCESS_EXIT)
+            {
+                cancelSearch(search, TRUE);
+            }
+        }
+        else
+        {
+            pNode candidate = getSubtreeBest(context, task->node, task->depth);
+            if (candidate == NULL)
+            {
+                cancelSearch(search, TRUE);
+            }
+            else
+            {
+                offerCandidate(search, candidate, task);
+            }
+        }
+    }
+
+    if (task->node != NULL)
+    {
+        context->freeNode(task->node);
+    }
+    free(task);
+    if (__atomic_sub_fetch(&search->pending, 1, __ATOMIC_SEQ_CST) == 0)
+    {
+        pthread_mutex_lock(&search->idleLock);
+        pthread_cond_broadcast(&search->idleCond);
+        pthread_mutex_unlock(&search->idleLock);
+    }
+}
+
+/**
+ * @brief takes the next task for the given worker: its own newest task, or else the oldest task
+ * of another worker.
+ * @param worker the given worker.
+ * @return the task, or NULL if no task is queued.
+ */
+static Task* nextTask(Worker* worker)
+{
+    ParallelSearch* search = worker->search;
+    Task* task = takeTask(&search->deques[worker->id], TRUE);
+    for (unsigned int i = 1; task == NULL && i < search->numWorkers; i++)
+    {
+        task = takeTask(&search->deques[(worker->id + i) % search->numWorkers], FALSE);
+    }
+    if (task != NULL)
+    {
+        __atomic_sub_fetch(&search->queued, 1, __ATOMIC_SEQ_CST);
+    }
+    return task;
+}
+
+/**
+ * @brief runs tasks until every task of the search is finished.
+ * @param arg the worker.
+ * @return NULL.
+ */
+static void* runWorker(void* arg)
+{
+    Worker* worker = (Worker*)arg;
+    ParallelSearch* search = worker->search;
+    NodeArena* previous = swapActiveArena(worker->arena);
+    while (TRUE)
+    {
+        Task* task = nextTask(worker);
+        if (task != NULL)
+        {
+            runTask(worker, task);
+            continue;
+        }
+
+        pthread_mutex_lock(&search->idleLock);
+        __atomic_add_fetch(&search->idleWorkers, 1, __ATOMIC_SEQ_CST);
+        while (__atomic_load_n(&search->queued, __ATOMIC_SEQ_CST) == 0 &&
+               __atomic_load_n(&search->pending, __ATOMIC_SEQ_CST) > 0)
+        {
+            pthread_cond_wait(&search->idleCond, &search->idleLock);
+        }
+        __atomic_sub_fetch(&search->idleWorkers, 1, __ATOMIC_SEQ_CST);
+        int done = __atomic_load_n(&search->pending, __ATOMIC_SEQ_CST) == 0;
+        pthread_mutex_unlock(&search->idleLock);
+        if (done)
+        {
+            swapActiveArena(previous);
+            return NULL;
+        }
+    }
+}
+
+pNode getBestParallel(pNode head, getNodeChildrenFunc getChildren, getNodeValFunc getVal,
+                      freeNodeFunc freeNode, copyNodeFunc copy, unsigned int best,
+                      unsigned int numThreads)
+{
+    if (head == NULL || getChildren == NULL || getVal == NULL || freeNode == NULL || copy == NULL)
+    {
+        return NULL;
+    }
+    if (numThreads == 0)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        numThreads = online > 0 ? (unsigned int)online : 1;
+    }
+    if (numThreads == 1)
+    {
+        return getBest(head, getChildren, getVal, freeNode, copy, best);
+    }
+
+    ParallelSearch search;
+    memset(&search, 0, sizeof(search));
+    DfsStats* stats = getActiveStats();
+    search.context = (SearchContext){getChildren, NULL, getVal, freeNode, copy, best,
+                                     &search.cancelled, stats, NULL, NULL};
+    if (newTable(copy, freeNode, &search.context.table) != SUCCESS_EXIT)
+    {
+        return NULL;
+    }
+    search.numWorkers = numThreads;
+    search.deques = (TaskDeque*)calloc(numThreads, sizeof(TaskDeque));
+    Worker* workers = (Worker*)malloc(numThreads * sizeof(Worker));
+    pthread_t* threads = (pthread_t*)malloc(numThreads * sizeof(pthread_t));
+    pNode root = copyNode(&search.context, head);
+    if (search.deques == NULL || workers == NULL || threads == NULL || root == NULL)
+    {
+        if (root != NULL)
+        {
+            freeNode(root);
+        }
+        free(search.deques);
+        free(workers);
+        free(threads);
+        freeTable(search.context.table);
+        return NULL;
+    }
+    for (unsigned int i = 0; i < numThreads; i++)
+    {
+        workers[i].arena = newArena();
+        if (workers[i].arena == NULL)
+        {
+            while (i > 0)
+            {
+                freeArena(workers[--i].arena);
+            }
+            freeNode(root);
+            free(search.deques);
+            free(workers);
+            free(threads);
+            freeTable(search.context.table);
+            return NULL;
+        }
+    }
+    pthread_mutex_init(&search.idleLock, NULL);
+    pthread_cond_init(&search.idleCond, NULL);
+    pthread_mutex_init(&search.bestLock, NULL);
+    for (unsigned int i = 0; i < numThreads; i++)
+    {
+        pthread_mutex_init(&search.deques[i].lock, NULL);
+        workers[i].search = &search;
+        workers[i].id = i;
+        workers[i].context = search.context;
+        memset(&workers[i].stats, 0, sizeof(DfsStats));
+        workers[i].context.stats = stats != NULL ? &workers[i].stats : NULL;
+    }
+
+    //the calling thread is worker 0; it seeds the search with the head.
+    unsigned int started = 1;
+    if (queueTask(&workers[0], root, NULL, 0) != SUCCESS_EXIT)
+    {
+        cancelSearch(&search, TRUE);
+    }
+    for (; started < numThreads; started++)
+    {
+        if (pthread_create(&threads[started], NULL, runWorker, &workers[started]) != 0)
+        {
+            break;
+        }
+    }
+    runWorker(&workers[0]);
+    for (unsigned int i = 1; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    for (unsigned int i = 0; i < numThreads; i++)
+    {
+        assert(search.deques[i].count == 0);
+        free(search.deques[i].tasks);
+        pthread_mutex_destroy(&search.deques[i].lock);
+    }
+    pthread_mutex_destroy(&search.idleLock);
+    pthread_cond_destroy(&search.idleCond);
+    pthread_mutex_destroy(&search.bestLock);
+    free(search.deques);
+    free(threads);
+
+    //the result outlives the workers' arenas, so it is copied out of them.
+    pNode result = search.failed || search.bestCandidate == NULL ? NULL :
+                   copyNode(&search.context, search.bestCandidate);
+    if (search.bestCandidate != NULL)
+    {
+        //the root copy was made before the arenas and may still be the best candidate; freeing
+        //arena memory here is a no-op, as freeArena() reclaims it.
+        freeNode(search.bestCandidate);
+    }
+    for (unsigned int i = 0; i < numThreads; i++)
+    {
+        freeArena(workers[i].arena);
+        addDfsStats(stats, &workers[i].stats);
+    }
+    free(workers);
+    freeTable(search.context.table);
+    return result;
+}
@@ -0,0 +1,621 @@
+// -------------------------- includes -------------------------
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "SolutionCache.h"
+#include "SudokuSymmetry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// -------------------------- macros -------------------------
+
+//-----parameters for the store file.
+//the first bytes of a store file, followed by STORE_HEADER_BYTES - sizeof(STORE_MAGIC) zeros.
+#define STORE_MAGIC "SUDOKU-SOLUTIONS-1"
+#define STORE_HEADER_BYTES 32
+//permissions of a new store file, before the umask.
+#define STORE_MODE 0644
+
+//-----parameters for the in-memory tables.
+//initial number of buckets of the cached solutions, and of slots of the store index; both double
+//whenever they are half full.
+#define INITIAL_BUCKETS 1024
+//FNV-1a hashing parameters.
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+// -------------------------- structs -------------------------
+
+/**
+ * @brief The header of a record of the store file, followed by the size * size cells of a
+ * canonical form and the size * size cells of its solution.
+ */
+typedef struct RecordHeader
+{
+    uint32_t size;
+    //the low bits of the hash of the size and the cells.
+    uint32_t checksum;
+} RecordHeader;
+
+/**
+ * @brief A solution kept in memory.
+ */
+typedef struct CacheEntry
+{
+    //the neighbours of the entry in the list of entries, from the most recently used.
+    struct CacheEntry* newer;
+    struct CacheEntry* older;
+    //the next entry of the entry's bucket.
+    struct CacheEntry* next;
+    unsigned long long hash;
+    unsigned int size;
+    //the cells of the canonical form, followed by the cells of its solution.
+    unsigned char cells[];
+} CacheEntry;
+
+/**
+ * @brief A slot of the store index: the hash of a record's canonical form and the record's offset
+ * in the store file; an offset of 0 marks an empty slot.
+ */
+typedef struct StoreSlot
+{
+    unsigned long long hash;
+    size_t offset;
+} StoreSlot;
+
+/**
+ * @brief A cache of solved boards.
+ */
+struct SolutionCache
+{
+    pthread_mutex_t lock;
+    //the entries kept in memory, hashed into buckets and listed from the most recently used.
+    CacheEntry** buckets;
+    size_t numBuckets;
+    size_t numEntries;
+    CacheEntry* newest;
+    CacheEntry* oldest;
+    //the number of bytes of the entries, and the number they are kept under.
+    size_t bytes;
+    size_t capacity;
+    //the store file, or -1; its mapping, and the number of its bytes indexed.
+    int fd;
+    unsigned char* map;
+    size_t mapBytes;
+    size_t indexedBytes;
+    //the store index, hashing the records of the store file into slots.
+    StoreSlot* slots;
+    size_t numSlots;
+    size_t usedSlots;
+    CacheStats stats;
+};
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief return the hash of the given canonical form.
+ * @param size the form's size.
+ * @param cells the form's cells.
+ * @param bytes the number of cells to hash.
+ * @return the hash.
+ */
+static unsigned long long hashCells(unsigned int size, const unsigned char* cells, size_t bytes)
+{
+    unsigned long long hash = (FNV_OFFSET ^ size) * FNV_PRIME;
+    for (size_t i = 0; i < bytes; i++)
+    {
+        hash = (hash ^ cells[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * @brief locks or unlocks the store file of the given cache against the other processes.
+ * @param cache the given cache.
+ * @param type F_WRLCK to lock; F_UNLCK to unlock.
+ * @return TRUE on success; FALSE otherwise.
+ */
+static int lockStore(SolutionCache* cache, short type)
+{
+    struct flock lock;
+    memset(&lock, 0, sizeof(lock));
+    lock.l_type = type;
+    lock.l_whence = SEEK_SET;
+    return fcntl(cache->fd, F_SETLKW, &lock) == 0;
+}
+
+/**
+ * @brief adds the record at the given offset of the store file to the store index of the given
+ * cache, growing the index if it is half full.
+ * @param cache the given cache.
+ * @param hash the hash of the record's canonical form.
+ * @param offset the given offset.
+ * @return TRUE on success; FALSE if allocation failed.
+ */
+static int indexRecord(SolutionCache* cache, unsigned long long hash, size_t offset)
+{
+    if (2 * (cache->usedSlots + 1) > cache->numSlots)
+    {
+        size_t numSlots = cache->numSlots ? 2 * cache->numSlots : INITIAL_BUCKETS;
+        StoreSlot* slots = (StoreSlot*)calloc(numSlots, sizeof(StoreSlot));
+        if (slots == NULL)
+        {
+            return FALSE;
+        }
+        for (size_t i = 0; i < cache->numSlots; i++)
+        {
+            if (cache->slots[i].offset != 0)
+            {
+                size_t slot = cache->slots[i].hash & (numSlots - 1);
+                while (slots[slot].offset != 0)
+                {
+                    slot = (slot + 1) & (numSlots - 1);
+                }
+                slots[slot] = cache->slots[i];
+            }
+        }
+        free(cache->slots);
+        cache->slots = slots;
+        cache->numSlots = numSlots;
+    }
+    size_t slot = hash & (cache->numSlots - 1);
+    while (cache->slots[slot].offset != 0)
+    {
+        slot = (slot + 1) & (cache->numSlots - 1);
+    }
+    cache->slots[slot].hash = hash;
+    cache->slots[slot].offset = offset;
+    cache->usedSlots++;
+    return TRUE;
+}
+
+/**
+ * @brief maps the store file of the given cache anew and indexes the records appended to it since
+ * it was last indexed. Indexing stops at the first record that is not complete yet, or that does
+ * not match its checksum.
+ * @param cache the given cache.
+ * @return TRUE on success; FALSE if mapping or allocation failed.
+ */
+static int indexStore(SolutionCache* cache)
+{
+    struct stat status;
+    if (fstat(cache->fd, &status) != 0)
+    {
+        return FALSE;
+    }
+    size_t fileBytes = (size_t)status.st_size;
+    if (fileBytes <= cache->mapBytes)
+    {
+        return TRUE;
+    }
+    unsigned char* map = (unsigned char*)mmap(NULL, fileBytes, PROT_READ, MAP_SHARED, cache->fd,
+                                              0);
+    if (map == MAP_FAILED)
+    {
+        return FALSE;
+    }
+    if (cache->map != NULL)
+    {
+        munmap(cache->map, cache->mapBytes);
+    }
+    cache->map = map;
+    cache->mapBytes = fileBytes;
+
+    size_t offset = cache->indexedBytes;
+    RecordHeader header;
+    while (offset + sizeof(RecordHeader) <= fileBytes)
+    {
+        memcpy(&header, map + offset, sizeof(RecordHeader));
+        size_t cells = (size_t)header.size * header.size;
+        if (header.size == 0 || header.size > MAX_BOARD_SIZE ||
+            offset + sizeof(RecordHeader) + 2 * cells > fileBytes)
+        {
+            break;
+        }
+        const unsigned char* record = map + offset + sizeof(RecordHeader);
+        if ((uint32_t)hashCells(header.size, record, 2 * cells) != header.checksum)
+        {
+            break;
+        }
+        if (!indexRecord(cache, hashCells(header.size, record, cells), offset))
+        {
+            return FALSE;
+        }
+        offset += sizeof(RecordHeader) + 2 * cells;
+    }
+    cache->indexedBytes = offset;
+    return TRUE;
+}
+
+/**
+ * @brief opens the given store file for the given cache, creating it if it does not exist, and
+ * indexes it. A torn record at its end, left by a process that stopped while appending it, is cut
+ * off.
+ * @param cache the given cache.
+ * @param path the store file.
+ * @return TRUE on success; FALSE otherwise.
+ */
+static int openStore(SolutionCache* cache, const char* path)
+{
+    cache->fd = open(path, O_RDWR | O_CREAT | O_APPEND, STORE_MODE);
+    if (cache->fd < 0 || !lockStore(cache, F_WRLCK))
+    {
+        return FALSE;
+    }
+    char header[STORE_HEADER_BYTES];
+    memset(header, 0, sizeof(header));
+    memcpy(header, STORE_MAGIC, sizeof(STORE_MAGIC));
+    char found[STORE_HEADER_BYTES];
+    ssize_t bytes = pread(cache->fd, found, sizeof(found), 0);
+    int valid = bytes == (ssize_t)sizeof(found) ? memcmp(found, header, sizeof(header)) == 0 :
+                bytes == 0 && write(cache->fd, header, sizeof(header)) == (ssize_t)sizeof(header);
+    cache->indexedBytes = STORE_HEADER_BYTES;
+    valid = valid && indexStore(cache);
+    if (valid && cache->indexedBytes < cache->mapBytes)
+    {
+        valid = ftruncate(cache->fd, (off_t)cache->indexedBytes) == 0;
+    }
+    lockStore(cache, F_UNLCK);
+    return valid;
+}
+
+SolutionCache* openCache(const char* path, size_t capacity)
+{
+    SolutionCache* cache = (SolutionCache*)calloc(1, sizeof(SolutionCache));
+    if (cache == NULL)
+    {
+        return NULL;
+    }
+    cache->capacity = capacity;
+    cache->fd = -1;
+    cache->numBuckets = INITIAL_BUCKETS;
+    cache->buckets = (CacheEntry**)calloc(cache->numBuckets, sizeof(CacheEntry*));
+    pthread_mutex_init(&cache->lock, NULL);
+    if (cache->buckets == NULL || (path != NULL && !openStore(cache, path)))
+    {
+        closeCache(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+void closeCache(SolutionCache* cache)
+{
+    if (cache == NULL)
+    {
+        return;
+    }
+    for (CacheEntry* entry = cache->newest; entry != NULL;)
+    {
+        CacheEntry* older = entry->older;
+        free(entry);
+        entry = older;
+    }
+    if (cache->map != NULL)
+    {
+        munmap(cache->map, cache->mapBytes);
+    }
+    if (cache->fd >= 0)
+    {
+        close(cache->fd);
+    }
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->slots);
+    free(cache->buckets);
+    free(cache);
+}
+
+/**
+ * @brief return the number of bytes the given entry takes.
+ * @param size the entry's size.
+ * @return the number of bytes.
+ */
+static size_t entryBytes(unsigned int size)
+{
+    return sizeof(CacheEntry) + 2 * (size_t)size * size;
+}
+
+/**
+ * @brief unlinks the given entry from the list of entries of the given cache.
+ * @param cache the given cache.
+ * @param entry the given entry.
+ */
+static void unlinkEntry(SolutionCache* cache, CacheEntry* entry)
+{
+    *(entry->newer != NULL ? &entry->newer->older : &cache->newest) = entry->older;
+    *(entry->older != NULL ? &entry->older->newer : &cache->oldest) = entry->newer;
+}
+
+/**
+ * @brief links the given entry at the front of the list of entries of the given cache, as the
+ * most recently used.
+ * @param cache the given cache.
+ * @param entry the given entry.
+ */
+static void linkEntry(SolutionCache* cache, CacheEntry* entry)
+{
+    entry->newer = NULL;
+    entry->older = cache->newest;
+    *(cache->newest != NULL ? &cache->newest->newer : &cache->oldest) = entry;
+    cache->newest = entry;
+}
+
+/**
+ * @brief finds the entry of the given canonical form in the given cache.
+ * @param cache the given cache.
+ * @param hash the form's hash.
+ * @param size the form's size.
+ * @param cells the form's cells.
+ * @return the entry, or NULL if the cache has none.
+ */
+static CacheEntry* findEntry(SolutionCache* cache, unsigned long long hash, unsigned int size,
+                             const unsigned char* cells)
+{
+    CacheEntry* entry = cache->buckets[hash & (cache->numBuckets - 1)];
+    while (entry != NULL && (entry->hash != hash || entry->size != size ||
+                             memcmp(entry->cells, cells, (size_t)size * size) != 0))
+    {
+        entry = entry->next;
+    }
+    return entry;
+}
+
+/**
+ * @brief removes the least recently used entries of the given cache until its entries fit in its
+ * capacity.
+ * @param cache the given cache.
+ */
+static void evictEntries(SolutionCache* cache)
+{
+    while (cache->bytes > cache->capacity && cache->oldest != NULL)
+    {
+        CacheEntry* entry = cache->oldest;
+        CacheEntry** link = &cache->buckets[entry->hash & (cache->numBuckets - 1)];
+        while (*link != entry)
+        {
+            link = &(*link)->next;
+        }
+        *link = entry->next;
+        unlinkEntry(cache, entry);
+        cache->bytes -= entryBytes(entry->size);
+        cache->numEntries--;
+        free(entry);
+    }
+}
+
+/**
+ * @brief adds an entry holding the given canonical form and solution to the given cache, as the
+ * most recently used, growing the buckets if they are half full.
+ * @param cache the given cache.
+ * @param hash the form's hash.
+ * @param size the form's size.
+ * @param cells the form's cells, followed by its solution's cells.
+ * @return TRUE on success; FALSE if allocation failed.
+ */
+static int addEntry(SolutionCache* cache, unsigned long long hash, unsigned int size,
+                    const unsigned char* cells)
+{
+    if (2 * (cache->numEntries + 1) > cache->numBuckets)
+    {
+        size_t numBuckets = 2 * cache->numBuckets;
+        CacheEntry** buckets = (CacheEntry**)calloc(numBuckets, sizeof(CacheEntry*));
+        if (buckets == NULL)
+        {
+            return FALSE;
+        }
+        for (CacheEntry* entry = cache->newest; entry != NULL; entry = entry->older)
+        {
+            CacheEntry** bucket = &buckets[entry->hash & (numBuckets - 1)];
+            entry->next = *bucket;
+            *bucket = entry;
+        }
+        free(cache->buckets);
+        cache->buckets = buckets;
+        cache->numBuckets = numBuckets;
+    }
+    CacheEntry* entry = (CacheEntry*)malloc(entryBytes(size));
+    if (entry == NULL)
+    {
+        return FALSE;
+    }
+    entry->hash = hash;
+    entry->size = size;
+    memcpy(entry->cells, cells, 2 * (size_t)size * size);
+    CacheEntry** bucket = &cache->buckets[hash & (cache->numBuckets - 1)];
+    entry->next = *bucket;
+    *bucket = entry;
+    linkEntry(cache, entry);
+    cache->bytes += entryBytes(size);
+    cache->numEntries++;
+    evictEntries(cache);
+    return TRUE;
+}
+
+/**
+ * @brief finds the record of the given canonical form in the store index of the given cache.
+ * @param cache the given cache.
+ * @param hash the form's hash.
+ * @param size the form's size.
+ * @param cells the form's cells.
+ * @return the record's cells, followed by its solution's cells, in the store file's mapping; NULL
+ * if the store has none.
+ */
+static const unsigned char* findRecord(SolutionCache* cache, unsigned long long hash,
+                                       unsigned int size, const unsigned char* cells)
+{
+    if (cache->numSlots == 0)
+    {
+        return NULL;
+    }
+    RecordHeader header;
+    for (size_t slot = hash & (cache->numSlots - 1); cache->slots[slot].offset != 0;
+         slot = (slot + 1) & (cache->numSlots - 1))
+    {
+        if (cache->slots[slot].hash != hash)
+        {
+            continue;
+        }
+        const unsigned char* record = cache->map + cache->slots[slot].offset;
+        memcpy(&header, record, sizeof(RecordHeader));
+        record += sizeof(RecordHeader);
+        if (header.size == size && memcmp(record, cells, (size_t)size * size) == 0)
+        {
+            return record;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief looks up the solution of the given canonical form in the given cache: in memory, then in
+ * the store file, indexing the records other processes appended to it if needed. A solution
+ * found in the store file is kept in memory.
+ * @param cache the given cache; locked.
+ * @param hash the form's hash.
+ * @param size the form's size.
+ * @param cells the form's cells; for the result: followed by the solution's cells.
+ * @return TRUE if a solution was found; FALSE otherwise.
+ */
+static int lookupForm(SolutionCache* cache, unsigned long long hash, unsigned int size,
+                      unsigned char* cells)
+{
+    size_t bytes = (size_t)size * size;
+    CacheEntry* entry = findEntry(cache, hash, size, cells);
+    if (entry != NULL)
+    {
+        unlinkEntry(cache, entry);
+        linkEntry(cache, entry);
+        memcpy(cells + bytes, entry->cells + bytes, bytes);
+        return TRUE;
+    }
+    if (cache->fd < 0)
+    {
+        return FALSE;
+    }
+    const unsigned char* record = findRecord(cache, hash, size, cells);
+    if (record == NULL && indexStore(cache))
+    {
+        record = findRecord(cache, hash, size, cells);
+    }
+    if (record == NULL)
+    {
+        return FALSE;
+    }
+    memcpy(cells + bytes, record + bytes, bytes);
+    addEntry(cache, hash, size, cells);
+    return TRUE;
+}
+
+int findSolution(SolutionCache* cache, pBoard board, pBoard* solution)
+{
+    assert(cache != NULL && board != NULL && solution != NULL);
+
+    *solution = NULL;
+    unsigned int size = getSize(board);
+    Symmetry symmetry;
+    unsigned char* cells = (unsigned char*)malloc(2 * (size_t)size * size);
+    if (cells == NULL || canonicalForm(board, cells, &symmetry) != SUCCESS_EXIT)
+    {
+        free(cells);
+        return ERROR;
+    }
+    unsigned long long hash = hashCells(size, cells, (size_t)size * size);
+
+    pthread_mutex_lock(&cache->lock);
+    int found = lookupForm(cache, hash, size, cells);
+    pthread_mutex_unlock(&cache->lock);
+
+    int rc = SUCCESS_EXIT;
+    if (found)
+    {
+        *solution = (pBoard)copyBoard(board);
+        rc = *solution == NULL ? ERROR : SUCCESS_EXIT;
+        //a solution that does not fit the board, from a damaged store file, is a miss.
+        if (*solution != NULL && (!mapFromImage(&symmetry, cells + (size_t)size * size, *solution)
+                                  || getFilledCells(*solution) != size * size))
+        {
+            freeBoard(*solution);
+            *solution = NULL;
+        }
+    }
+    pthread_mutex_lock(&cache->lock);
+    cache->stats.hits += *solution != NULL;
+    cache->stats.misses += *solution == NULL;
+    pthread_mutex_unlock(&cache->lock);
+    free(cells);
+    return rc;
+}
+
+/**
+ * @brief appends a record of the given canonical form and solution to the store file of the given
+ * cache, in a single write.
+ * @param cache the given cache.
+ * @param size the form's size.
+ * @param cells the form's cells, followed by its solution's cells.
+ * @return TRUE on success; FALSE otherwise.
+ */
+static int appendRecord(SolutionCache* cache, unsigned int size, const unsigned char* cells)
+{
+    size_t bytes = 2 * (size_t)size * size;
+    unsigned char* record = (unsigned char*)malloc(sizeof(RecordHeader) + bytes);
+    if (record == NULL)
+    {
+        return FALSE;
+    }
+    RecordHeader header = {size, (uint32_t)hashCells(size, cells, bytes)};
+    memcpy(record, &header, sizeof(RecordHeader));
+    memcpy(record + sizeof(RecordHeader), cells, bytes);
+    int written = lockStore(cache, F_WRLCK);
+    written = written && write(cache->fd, record, sizeof(RecordHeader) + bytes) ==
+                         (ssize_t)(sizeof(RecordHeader) + bytes);
+    lockStore(cache, F_UNLCK);
+    free(record);
+    return written;
+}
+
+int storeSolution(SolutionCache* cache, pBoard board, pBoard solution)
+{
+    assert(cache != NULL && board != NULL && solution != NULL);
+
+    unsigned int size = getSize(board);
+    size_t bytes = (size_t)size * size;
+    Symmetry symmetry;
+    unsigned char* cells = (unsigned char*)malloc(2 * bytes);
+    if (cells == NULL || canonicalForm(board, cells, &symmetry) != SUCCESS_EXIT)
+    {
+        free(cells);
+        return ERROR;
+    }
+    mapToImage(&symmetry, solution, cells + bytes);
+    unsigned long long hash = hashCells(size, cells, bytes);
+
+    int rc = SUCCESS_EXIT;
+    pthread_mutex_lock(&cache->lock);
+    if (findEntry(cache, hash, size, cells) == NULL &&
+        (cache->fd < 0 || findRecord(cache, hash, size, cells) == NULL))
+    {
+        int added = addEntry(cache, hash, size, cells);
+        rc = added && (cache->fd < 0 || appendRecord(cache, size, cells)) ? SUCCESS_EXIT : ERROR;
+        cache->stats.stored += added;
+    }
+    pthread_mutex_unlock(&cache->lock);
+    free(cells);
+    return rc;
+}
+
+void getCacheStats(SolutionCache* cache, CacheStats* stats)
+{
+    assert(cache != NULL && stats != NULL);
+
+    pthread_mutex_lock(&cache->lock);
+    *stats = cache->stats;
+    pthread_mutex_unlock(&cache->lock);
+}
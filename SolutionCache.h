@@ -0,0 +1,73 @@
+#ifndef EX3_SOLUTIONCACHE_H
+#define EX3_SOLUTIONCACHE_H
+
+#include "SudokuTree.h"
+#include <stddef.h>
+
+// -------------------------- structs & typedef -------------------------
+
+/**
+ * @brief A cache of solved boards, keyed by their canonical forms, see openCache().
+ */
+typedef struct SolutionCache SolutionCache;
+
+/**
+ * @brief Counts of the lookups and stores of a cache.
+ */
+typedef struct CacheStats
+{
+    //number of lookups that found a solution, in memory or in the store file, and that did not.
+    unsigned long hits;
+    unsigned long misses;
+    //number of solutions stored.
+    unsigned long stored;
+} CacheStats;
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief opens a cache of solved boards. Boards are looked up by their canonical form, see
+ * canonicalForm(), so a board hits the solution of any board it is an image of. The most
+ * recently used solutions are kept in memory, up to the given number of bytes; with a store
+ * file, every solution is also appended to it, and solutions appended by any process are found
+ * through a memory mapping of it. The cache may be used by several threads at once.
+ * @param path the store file, created if it does not exist; NULL for a cache in memory only.
+ * @param capacity the number of bytes of solutions kept in memory.
+ * @return the new cache; NULL if the store file could not be opened or is not a store file, or if
+ * allocation failed.
+ */
+SolutionCache* openCache(const char* path, size_t capacity);
+
+/**
+ * @brief closes the given cache.
+ * @param cache the given cache; may be NULL.
+ */
+void closeCache(SolutionCache* cache);
+
+/**
+ * @brief looks up the solution of the given board in the given cache.
+ * @param cache the given cache.
+ * @param board the given board; not modified.
+ * @param solution for the result: a new board holding the cached solution, mapped back onto the
+ * given board; NULL if the cache holds none.
+ * @return SUCCESS_EXIT, or ERROR if allocation failed.
+ */
+int findSolution(SolutionCache* cache, pBoard board, pBoard* solution);
+
+/**
+ * @brief stores the given solution of the given board in the given cache.
+ * @param cache the given cache.
+ * @param board the given board.
+ * @param solution the given solution; must be a complete board agreeing with the given board.
+ * @return SUCCESS_EXIT, or ERROR if allocation or writing to the store file failed.
+ */
+int storeSolution(SolutionCache* cache, pBoard board, pBoard solution);
+
+/**
+ * @brief writes the counts of the lookups and stores of the given cache so far.
+ * @param cache the given cache.
+ * @param stats for the result: the counts.
+ */
+void getCacheStats(SolutionCache* cache, CacheStats* stats);
+
+#endif //EX3_SOLUTIONCACHE_H
@@ -0,0 +1,324 @@
+// -------------------------- includes -------------------------
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "SudokuTree.h"
+#include "SudokuIO.h"
+#include "GenericDFS.h"
+#include "DancingLinks.h"
+#include "LatencyHistogram.h"
+#include "ToolUtils.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+// -------------------------- macros -------------------------
+
+//-----parameters for reading the command line.
+//index of the first argument.
+#define FIRST_ARG_INDEX 1
+//flag selecting the minimum remaining values branching mode.
+#define MRV_FLAG "--mrv"
+//flag disabling constraint propagation.
+#define NO_PROPAGATION_FLAG "--no-propagation"
+//flag selecting the exact cover backend.
+#define DLX_FLAG "--dlx"
+//flags selecting the least constraining value ordering, and the random one; the latter followed
+//by the seed.
+#define LCV_FLAG "--lcv"
+#define RANDOM_FLAG "--random"
+//flags restarting the searches on a schedule; followed by the number of nodes of the unit budget.
+#define LUBY_FLAG "--luby"
+#define GEOMETRIC_FLAG "--geometric"
+//flag keeping a transposition table; followed by its capacity.
+#define HASH_FLAG "--hash"
+//prefix of command line flags.
+#define FLAG_PREFIX "--"
+
+//-----parameters for running a category.
+//a category's corpus is solved again and again until it ran for at least this many seconds.
+#define MIN_CATEGORY_SECONDS 0.5
+//percentiles reported for the latencies.
+#define MEDIAN 0.5
+#define TAIL 0.99
+//microseconds per second.
+#define MICROS 1e6
+
+//-----parameters for reading from file.
+//format for opening a corpus file.
+#define FILE_FORMAT "r"
+
+//-----parameters for printing.
+//the header of the report; one tab separated row per category follows.
+#define HEADER "category\tpuzzles\tsolved\tseconds\tpuzzles_per_sec\tnodes\tnodes_per_sec" \
+               "\ttranspositions\tp50_us\tp99_us\tmax_us\tallocations\tmallocs\tpeak_rss_kb\n"
+//printing format for a category's row.
+#define ROW_FORMAT "%s\t%lu\t%lu\t%.3f\t%.1f\t%llu\t%.1f\t%llu\t%.1f\t%.1f\t%.1f\t%lu\t%lu\t%ld\n"
+
+//-----messages.
+//fopen error message,
+#define FOPEN_ERROR "%s:no such file\n"
+//unexpected arguments exit message
+#define ARGC_ERROR "usage: SudokuBench [--mrv] [--no-propagation] [--dlx] " \
+                   "[--lcv | --random <seed>] [--luby <n> | --geometric <n>] " \
+                   "[--hash <capacity>] <corpus file>...\n"
+//failed category error message.
+#define CATEGORY_ERROR "%s:benchmark failed\n"
+
+// -------------------------- structs -------------------------
+
+/**
+ * @brief The search settings the corpus is solved with.
+ */
+typedef struct BenchOptions
+{
+    //TRUE to solve the puzzles with solveExactCover() instead of searching them.
+    int exactCover;
+    BranchingMode branching;
+    int propagation;
+    ValueOrdering ordering;
+    unsigned long long seed;
+    //the restart settings; a unit of 0 for none.
+    DfsRestarts restarts;
+    //the transposition table settings; a capacity of 0 for no table.
+    DfsHashing hashing;
+} BenchOptions;
+
+/**
+ * @brief The measurements of a category.
+ */
+typedef struct CategoryStats
+{
+    unsigned long puzzles;
+    unsigned long solved;
+    double seconds;
+    LatencyHistogram latencies;
+} CategoryStats;
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief solves the given board, recording the time it took.
+ * @param board the given board.
+ * @param options the search settings.
+ * @param stats the category's measurements; updated.
+ * @return SUCCESS_EXIT, or MALLOC_EXIT in case of an error.
+ */
+static int benchBoard(pBoard board, const BenchOptions* options, CategoryStats* stats)
+{
+    setBranchingMode(board, options->branching);
+    setPropagation(board, options->propagation);
+    setValueOrdering(board, options->ordering, options->seed);
+    unsigned int size = getSize(board);
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pBoard bestBoard = options->exactCover ?
+                       solveExactCover(board) :
+                       getBestInPlace(board, getBoardMoves, applyBoardMove, undoBoardMove,
+                                      getFilledCells, freeBoard, copyBoard, size, size * size);
+    double latency = secondsSince(&start);
+    if (bestBoard == NULL)
+    {
+        return MALLOC_EXIT;
+    }
+
+    stats->puzzles++;
+    addLatency(&stats->latencies, latency);
+    stats->seconds += latency;
+    stats->solved += getFilledCells(bestBoard) == size * size;
+    freeBoard(bestBoard);
+    return SUCCESS_EXIT;
+}
+
+/**
+ * @brief solves every puzzle of the given corpus file once.
+ * @param fileName the corpus file's name.
+ * @param options the search settings.
+ * @param stats the category's measurements; updated.
+ * @return SUCCESS_EXIT, or an error code.
+ */
+static int benchCorpus(const char* fileName, const BenchOptions* options, CategoryStats* stats)
+{
+    FILE* inputFile = fopen(fileName, FILE_FORMAT);
+    if (inputFile == NULL)
+    {
+        fprintf(ERROR_DEST, FOPEN_ERROR, fileName);
+        return FOPEN_EXIT;
+    }
+
+    InputReader* reader = openReader(inputFile);
+    int rc = reader == NULL ? MALLOC_EXIT : SUCCESS_EXIT;
+    pBoard board;
+    RecordFormat format;
+    for (unsigned long record = 1;
+         rc == SUCCESS_EXIT &&
+         (rc = scanRecord(reader, fileName, record, &board, &format)) == SUCCESS_EXIT; record++)
+    {
+        rc = benchBoard(board, options, stats);
+        freeBoard(board);
+    }
+    closeReader(reader);
+    fclose(inputFile);
+    return rc == END_OF_INPUT ? SUCCESS_EXIT : rc;
+}
+
+/**
+ * @brief runs the category of the given corpus file and prints its row of the report. Meant to
+ * run in a process of its own, so the peak resident set size is the category's.
+ * @param fileName the corpus file's name; the category is named after it.
+ * @param options the search settings.
+ * @return SUCCESS_EXIT, or an error code.
+ */
+static int benchCategory(const char* fileName, const BenchOptions* options)
+{
+    static CategoryStats stats;
+    DfsStats searchStats;
+    memset(&searchStats, 0, sizeof(DfsStats));
+    DfsAllocStats before, after;
+    getDfsAllocStats(&before);
+    setDfsStats(&searchStats);
+    setDfsRestarts(&options->restarts);
+    setDfsHashing(options->hashing.capacity > 0 ? &options->hashing : NULL);
+
+    int rc;
+    do
+    {
+        rc = benchCorpus(fileName, options, &stats);
+    } while (rc == SUCCESS_EXIT && stats.puzzles > 0 && stats.seconds < MIN_CATEGORY_SECONDS);
+    getDfsAllocStats(&after);
+    setDfsStats(NULL);
+    setDfsRestarts(NULL);
+    setDfsHashing(NULL);
+    if (rc != SUCCESS_EXIT || stats.puzzles == 0)
+    {
+        return rc != SUCCESS_EXIT ? rc : INVALID_INPUT_EXIT;
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    const char* category = strrchr(fileName, '/') != NULL ? strrchr(fileName, '/') + 1 : fileName;
+    printf(ROW_FORMAT, category, stats.puzzles, stats.solved, stats.seconds,
+           (double)stats.puzzles / stats.seconds, searchStats.nodes,
+           (double)searchStats.nodes / stats.seconds, searchStats.transpositions,
+           latencyPercentile(&stats.latencies, MEDIAN) * MICROS,
+           latencyPercentile(&stats.latencies, TAIL) * MICROS, stats.latencies.maxLatency * MICROS,
+           after.allocations - before.allocations, after.mallocs - before.mallocs,
+           usage.ru_maxrss);
+    fflush(stdout);
+    return SUCCESS_EXIT;
+}
+
+/**
+ * measures the solver on corpora of puzzles, one category per corpus file, and prints a tab
+ * separated report with a row per category. Each category solves its corpus with a single
+ * thread, again and again until it ran for at least MIN_CATEGORY_SECONDS, in a process of its
+ * own. A node is a board the search visited, and the transpositions are the boards the
+ * transposition table let the search skip; see DfsStats.
+ * usage: SudokuBench [--mrv] [--no-propagation] [--dlx] [--lcv | --random <seed>]
+ *                    [--luby <n> | --geometric <n>] [--hash <capacity>] <corpus file>...
+ * --mrv branches on the empty cell with the fewest legal values instead of the first empty cell.
+ * --no-propagation disables filling forced cells before branching.
+ * --dlx solves the puzzles as exact cover problems with Dancing Links instead of searching them;
+ * see SudokuSolver. The exact cover search visits no boards, so its node count is 0. Not
+ * available with --luby, --geometric or --hash.
+ * --lcv and --random <seed> try the values of a cell in the least constraining order, or in a
+ * random order drawn from the board and the seed, instead of in ascending order.
+ * --luby <n> and --geometric <n> restart the searches on the Luby schedule, or the geometric one,
+ * with a unit of n nodes; see SudokuSolver.
+ * --hash <capacity> keeps a transposition table of up to capacity subtrees, see setDfsHashing(),
+ * keyed by hashBoard() and equalBoards().
+ * @param argc number of arguments.
+ * @param argv arguments.
+ * @return SUCCESS_EXIT if every category ran; an error code otherwise.
+ */
+int main(int argc, char* argv[])
+{
+    BenchOptions options = {FALSE, FIRST_EMPTY_BRANCHING, TRUE, ASCENDING_ORDERING, 0,
+                            {LUBY_RESTARTS, 0, restartBoard}, {hashBoard, equalBoards, 0}};
+    int firstFile = FIRST_ARG_INDEX;
+    unsigned long long number;
+    //the number of value ordering flags, and of restart schedule flags, given.
+    int orderingFlags = 0;
+    int scheduleFlags = 0;
+    for (; firstFile < argc && strncmp(argv[firstFile], FLAG_PREFIX, strlen(FLAG_PREFIX)) == 0;
+         firstFile++)
+    {
+        if (strcmp(argv[firstFile], MRV_FLAG) == 0)
+        {
+            options.branching = MIN_REMAINING_BRANCHING;
+        }
+        else if (strcmp(argv[firstFile], NO_PROPAGATION_FLAG) == 0)
+        {
+            options.propagation = FALSE;
+        }
+        else if (strcmp(argv[firstFile], DLX_FLAG) == 0)
+        {
+            options.exactCover = TRUE;
+        }
+        else if (strcmp(argv[firstFile], LCV_FLAG) == 0)
+        {
+            options.ordering = LEAST_CONSTRAINING_ORDERING;
+            orderingFlags++;
+        }
+        else if (strcmp(argv[firstFile], RANDOM_FLAG) == 0 &&
+                 parseNumber(argv[firstFile + 1], ULLONG_MAX, &number))
+        {
+            options.ordering = RANDOM_ORDERING;
+            options.seed = number;
+            orderingFlags++;
+            firstFile++;
+        }
+        else if ((strcmp(argv[firstFile], LUBY_FLAG) == 0 ||
+                  strcmp(argv[firstFile], GEOMETRIC_FLAG) == 0) &&
+                 parseNumber(argv[firstFile + 1], ULLONG_MAX, &number))
+        {
+            options.restarts.schedule = strcmp(argv[firstFile], LUBY_FLAG) == 0 ?
+                                        LUBY_RESTARTS : GEOMETRIC_RESTARTS;
+            options.restarts.unitNodes = number;
+            scheduleFlags++;
+            firstFile++;
+        }
+        else if (strcmp(argv[firstFile], HASH_FLAG) == 0 &&
+                 parseNumber(argv[firstFile + 1], ULLONG_MAX, &number))
+        {
+            options.hashing.capacity = (size_t)number;
+            firstFile++;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (firstFile == argc || strncmp(argv[firstFile], FLAG_PREFIX, strlen(FLAG_PREFIX)) == 0 ||
+        orderingFlags > 1 || scheduleFlags > 1 ||
+        (options.exactCover && (options.restarts.unitNodes > 0 || options.hashing.capacity > 0)))
+    {
+        fprintf(ERROR_DEST, ARGC_ERROR);
+        return ARGC_EXIT;
+    }
+
+    printf(HEADER);
+    fflush(stdout);
+    int result = SUCCESS_EXIT;
+    for (int i = firstFile; i < argc; i++)
+    {
+        pid_t child = fork();
+        if (child == 0)
+        {
+            exit(benchCategory(argv[i], &options) == SUCCESS_EXIT ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+        int status;
+        if (child < 0 || waitpid(child, &status, 0) != child || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != EXIT_SUCCESS)
+        {
+            fprintf(ERROR_DEST, CATEGORY_ERROR, argv[i]);
+            result = ERROR;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,542 @@
+// -------------------------- includes -------------------------
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "SudokuTree.h"
+#include "SudokuIO.h"
+#include "SudokuServer.h"
+#include "LatencyHistogram.h"
+#include "ToolUtils.h"
+#include <pthread.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// -------------------------- macros -------------------------
+
+//-----parameters for reading the command line.
+//index of the first argument.
+#define FIRST_ARG_INDEX 1
+//flag setting the number of connections; followed by the number.
+#define CONNECTIONS_FLAG "--connections"
+//flag setting the number of times each puzzle is sent; followed by the number.
+#define REPEAT_FLAG "--repeat"
+//flag printing the server's statistics after the run.
+#define STATS_FLAG "--stats"
+//max number of connections.
+#define MAX_CONNECTIONS 1024
+//base of numeric arguments.
+#define DECIMAL 10
+//number of arguments after the flags.
+#define POSITIONAL_ARGS 2
+
+//-----parameters for measuring.
+//percentiles reported for the latencies.
+#define MEDIAN 0.5
+#define HIGH 0.9
+#define TAIL 0.99
+//microseconds per second.
+#define MICROS 1e6
+
+//-----parameters for reading from file.
+//format for opening the puzzle file.
+#define FILE_FORMAT "r"
+//format for reading the answers.
+#define SOCKET_FORMAT "r"
+
+//-----parameters for printing.
+//the header of the report, followed by its row.
+#define HEADER "connections\trequests\tsolved\tseconds\trequests_per_sec\tp50_us\tp90_us" \
+               "\tp99_us\tmax_us\n"
+//printing format for the report's row.
+#define ROW_FORMAT "%u\t%lu\t%lu\t%.3f\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\n"
+
+//-----messages.
+//fopen error message,
+#define FOPEN_ERROR "%s:no such file\n"
+//unexpected arguments exit message
+#define ARGC_ERROR "usage: SudokuClient [--connections <n>] [--repeat <n>] [--stats] <socket> " \
+                   "<puzzle file>\n"
+//connection error message.
+#define CONNECT_ERROR "%s:cannot connect\n"
+//message telling the server answered in an unexpected way.
+#define ANSWER_ERROR "%s:unexpected answer\n"
+
+// -------------------------- structs -------------------------
+
+/**
+ * @brief The puzzles sent to the server, formatted as requests.
+ * Puzzle p is the length[p] bytes of text from offset[p], in format formats[p].
+ */
+typedef struct Puzzles
+{
+    char* text;
+    size_t length;
+    size_t capacity;
+    unsigned long count;
+    size_t* offsets;
+    size_t* lengths;
+    RecordFormat* formats;
+    unsigned int* sizes;
+} Puzzles;
+
+/**
+ * @brief A connection of the run. Connection c sends the requests c, c + n, c + 2n and so on of
+ * the run, for n connections, where request r is puzzle r modulo the number of puzzles.
+ */
+typedef struct ClientConnection
+{
+    const Puzzles* puzzles;
+    const char* socketPath;
+    unsigned int id;
+    unsigned int numConnections;
+    unsigned long numRequests;
+    int socket;
+    //the time each of the connection's requests was sent.
+    struct timespec* sent;
+    unsigned long answered;
+    unsigned long solved;
+    int failed;
+    LatencyHistogram latencies;
+} ClientConnection;
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief appends the given board, formatted as a request, to the given puzzles.
+ * @param puzzles the given puzzles.
+ * @param board the given board.
+ * @param format the format to send the board in.
+ * @return SUCCESS_EXIT, or MALLOC_EXIT if allocation failed.
+ */
+static int addPuzzle(Puzzles* puzzles, pBoard board, RecordFormat format)
+{
+    unsigned int size = getSize(board);
+    size_t bytes = maxFormattedBytes(size, format);
+    if (puzzles->length + bytes > puzzles->capacity)
+    {
+        size_t capacity = 2 * puzzles->capacity + bytes;
+        char* text = (char*)realloc(puzzles->text, capacity);
+        if (text == NULL)
+        {
+            return MALLOC_EXIT;
+        }
+        puzzles->text = text;
+        puzzles->capacity = capacity;
+    }
+    //the arrays grow whenever the count reaches a power of two.
+    unsigned long count = puzzles->count;
+    if ((count & (count - 1)) == 0)
+    {
+        size_t slots = count > 0 ? 2 * count : 1;
+        size_t* offsets = (size_t*)realloc(puzzles->offsets, slots * sizeof(size_t));
+        puzzles->offsets = offsets != NULL ? offsets : puzzles->offsets;
+        size_t* lengths = (size_t*)realloc(puzzles->lengths, slots * sizeof(size_t));
+        puzzles->lengths = lengths != NULL ? lengths : puzzles->lengths;
+        RecordFormat* formats = (RecordFormat*)realloc(puzzles->formats,
+                                                       slots * sizeof(RecordFormat));
+        puzzles->formats = formats != NULL ? formats : puzzles->formats;
+        unsigned int* sizes = (unsigned int*)realloc(puzzles->sizes, slots * sizeof(unsigned int));
+        puzzles->sizes = sizes != NULL ? sizes : puzzles->sizes;
+        if (offsets == NULL || lengths == NULL || formats == NULL || sizes == NULL)
+        {
+            return MALLOC_EXIT;
+        }
+    }
+    puzzles->offsets[count] = puzzles->length;
+    puzzles->lengths[count] = formatBoard(board, format, puzzles->text + puzzles->length);
+    puzzles->formats[count] = format;
+    puzzles->sizes[count] = size;
+    puzzles->length += puzzles->lengths[count];
+    puzzles->count++;
+    return SUCCESS_EXIT;
+}
+
+/**
+ * @brief reads every puzzle of the given file into the given puzzles.
+ * @param fileName the file's name.
+ * @param puzzles for the result: the puzzles; all zero before the call.
+ * @return SUCCESS_EXIT, or an error code.
+ */
+static int loadPuzzles(const char* fileName, Puzzles* puzzles)
+{
+    FILE* inputFile = fopen(fileName, FILE_FORMAT);
+    if (inputFile == NULL)
+    {
+        fprintf(ERROR_DEST, FOPEN_ERROR, fileName);
+        return FOPEN_EXIT;
+    }
+    InputReader* reader = openReader(inputFile);
+    int rc = reader == NULL ? MALLOC_EXIT : SUCCESS_EXIT;
+    pBoard board;
+    RecordFormat format;
+    for (unsigned long record = 1;
+         rc == SUCCESS_EXIT &&
+         (rc = scanRecord(reader, fileName, record, &board, &format)) == SUCCESS_EXIT; record++)
+    {
+        //answers are read a line at a time, so binary puzzles are sent as grids.
+        rc = addPuzzle(puzzles, board, format == BINARY_FORMAT ? GRID_FORMAT : format);
+        freeBoard(board);
+    }
+    closeReader(reader);
+    fclose(inputFile);
+    if (rc == MALLOC_EXIT)
+    {
+        fprintf(ERROR_DEST, MALLOC_ERROR);
+    }
+    return rc == END_OF_INPUT ? SUCCESS_EXIT : rc;
+}
+
+/**
+ * @brief releases the memory of the given puzzles.
+ * @param puzzles the given puzzles.
+ */
+static void freePuzzles(Puzzles* puzzles)
+{
+    free(puzzles->text);
+    free(puzzles->offsets);
+    free(puzzles->lengths);
+    free(puzzles->formats);
+    free(puzzles->sizes);
+}
+
+/**
+ * @brief connects to the socket at the given path.
+ * @param socketPath the given path.
+ * @return the connected socket, or -1 if connecting failed.
+ */
+static int connectTo(const char* socketPath)
+{
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(address.sun_path))
+    {
+        return -1;
+    }
+    strcpy(address.sun_path, socketPath);
+    int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connection >= 0 && connect(connection, (struct sockaddr*)&address, sizeof(address)) != 0)
+    {
+        close(connection);
+        connection = -1;
+    }
+    return connection;
+}
+
+/**
+ * @brief return the puzzle of the given request of the given connection.
+ * @param connection the given connection.
+ * @param request the index of the request among the connection's requests.
+ * @return the index of the puzzle.
+ */
+static unsigned long puzzleOf(const ClientConnection* connection, unsigned long request)
+{
+    return (request * connection->numConnections + connection->id) % connection->puzzles->count;
+}
+
+/**
+ * @brief sends every request of the given connection without waiting for the answers, then
+ * closes the sending side of its socket.
+ * @param arg the connection.
+ * @return NULL.
+ */
+static void* runSender(void* arg)
+{
+    ClientConnection* connection = (ClientConnection*)arg;
+    const Puzzles* puzzles = connection->puzzles;
+    for (unsigned long r = 0; r < connection->numRequests; r++)
+    {
+        unsigned long p = puzzleOf(connection, r);
+        clock_gettime(CLOCK_MONOTONIC, &connection->sent[r]);
+        if (!writeAll(connection->socket, puzzles->text + puzzles->offsets[p],
+                      puzzles->lengths[p]))
+        {
+            break;
+        }
+    }
+    shutdown(connection->socket, SHUT_WR);
+    return NULL;
+}
+
+/**
+ * @brief reads the answer to the given request of the given connection.
+ * @param connection the given connection.
+ * @param answers the stream the answers are read from.
+ * @param request the index of the request among the connection's requests.
+ * @param line the buffer lines are read into, see getline().
+ * @param capacity the size of the buffer.
+ * @return TRUE if an answer was read; FALSE if the answers ended or were malformed.
+ */
+static int readAnswer(ClientConnection* connection, FILE* answers, unsigned long request,
+                      char** line, size_t* capacity)
+{
+    if (getline(line, capacity, answers) < 0)
+    {
+        return FALSE;
+    }
+    if (strcmp(*line, NO_SOLUTION_ERROR) == 0)
+    {
+        return TRUE;
+    }
+    unsigned long p = puzzleOf(connection, request);
+    //a grid answer is its size line followed by a line per row; a line answer is one line.
+    unsigned int rows = 0;
+    if (connection->puzzles->formats[p] == GRID_FORMAT)
+    {
+        rows = connection->puzzles->sizes[p];
+        if ((unsigned int)strtoul(*line, NULL, DECIMAL) != rows)
+        {
+            return FALSE;
+        }
+    }
+    for (unsigned int i = 0; i < rows; i++)
+    {
+        if (getline(line, capacity, answers) < 0)
+        {
+            return FALSE;
+        }
+    }
+    connection->solved++;
+    return TRUE;
+}
+
+/**
+ * @brief runs the given connection: sends its requests from a thread of their own, and reads
+ * the answers, timing each request.
+ * @param arg the connection.
+ * @return NULL.
+ */
+static void* runConnection(void* arg)
+{
+    ClientConnection* connection = (ClientConnection*)arg;
+    connection->failed = TRUE;
+    connection->socket = connectTo(connection->socketPath);
+    if (connection->socket < 0)
+    {
+        fprintf(ERROR_DEST, CONNECT_ERROR, connection->socketPath);
+        return NULL;
+    }
+    int descriptor = dup(connection->socket);
+    FILE* answers = descriptor >= 0 ? fdopen(descriptor, SOCKET_FORMAT) : NULL;
+    if (answers == NULL && descriptor >= 0)
+    {
+        close(descriptor);
+    }
+    pthread_t sender;
+    if (answers == NULL || pthread_create(&sender, NULL, runSender, connection) != 0)
+    {
+        fprintf(ERROR_DEST, MALLOC_ERROR);
+        if (answers != NULL)
+        {
+            fclose(answers);
+        }
+        close(connection->socket);
+        return NULL;
+    }
+
+    char* line = NULL;
+    size_t capacity = 0;
+    while (connection->answered < connection->numRequests &&
+           readAnswer(connection, answers, connection->answered, &line, &capacity))
+    {
+        addLatency(&connection->latencies, secondsSince(&connection->sent[connection->answered]));
+        connection->answered++;
+    }
+    connection->failed = connection->answered < connection->numRequests;
+    if (connection->failed)
+    {
+        fprintf(ERROR_DEST, ANSWER_ERROR, connection->socketPath);
+        //the server may be waiting for the answers to be read; closing stops it.
+        shutdown(connection->socket, SHUT_RDWR);
+    }
+    pthread_join(sender, NULL);
+    free(line);
+    fclose(answers);
+    close(connection->socket);
+    return NULL;
+}
+
+/**
+ * @brief sends every puzzle the given number of times over the given number of connections and
+ * prints a tab separated report of the answers and their latencies.
+ * @param socketPath the server's socket.
+ * @param puzzles the given puzzles.
+ * @param numConnections the number of connections.
+ * @param repeat the number of times each puzzle is sent.
+ * @return SUCCESS_EXIT, or an error code.
+ */
+static int runLoad(const char* socketPath, const Puzzles* puzzles, unsigned int numConnections,
+                   unsigned long repeat)
+{
+    unsigned long total = puzzles->count * repeat;
+    ClientConnection* connections = (ClientConnection*)calloc(numConnections,
+                                                              sizeof(ClientConnection));
+    pthread_t* threads = (pthread_t*)malloc(numConnections * sizeof(pthread_t));
+    int rc = connections != NULL && threads != NULL ? SUCCESS_EXIT : MALLOC_EXIT;
+    for (unsigned int c = 0; rc == SUCCESS_EXIT && c < numConnections; c++)
+    {
+        ClientConnection* connection = &connections[c];
+        connection->puzzles = puzzles;
+        connection->socketPath = socketPath;
+        connection->id = c;
+        connection->numConnections = numConnections;
+        connection->numRequests = total / numConnections + (c < total % numConnections);
+        connection->sent = (struct timespec*)malloc(
+                (connection->numRequests + 1) * sizeof(struct timespec));
+        rc = connection->sent != NULL ? SUCCESS_EXIT : MALLOC_EXIT;
+    }
+    if (rc != SUCCESS_EXIT)
+    {
+        fprintf(ERROR_DEST, MALLOC_ERROR);
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    unsigned int started = 0;
+    while (rc == SUCCESS_EXIT && started < numConnections &&
+           pthread_create(&threads[started], NULL, runConnection, &connections[started]) == 0)
+    {
+        started++;
+    }
+    rc = rc == SUCCESS_EXIT && started < numConnections ? MALLOC_EXIT : rc;
+    for (unsigned int c = 0; c < started; c++)
+    {
+        pthread_join(threads[c], NULL);
+    }
+    double seconds = secondsSince(&start);
+
+    static LatencyHistogram latencies;
+    unsigned long answered = 0, solved = 0;
+    for (unsigned int c = 0; connections != NULL && c < numConnections; c++)
+    {
+        rc = c < started && connections[c].failed ? ERROR : rc;
+        answered += connections[c].answered;
+        solved += connections[c].solved;
+        latencies.count += connections[c].latencies.count;
+        latencies.maxLatency = connections[c].latencies.maxLatency > latencies.maxLatency ?
+                               connections[c].latencies.maxLatency : latencies.maxLatency;
+        for (unsigned int b = 0; b < LATENCY_BUCKETS; b++)
+        {
+            latencies.buckets[b] += connections[c].latencies.buckets[b];
+        }
+        free(connections[c].sent);
+    }
+    if (rc == SUCCESS_EXIT)
+    {
+        printf(HEADER);
+        printf(ROW_FORMAT, numConnections, answered, solved, seconds, (double)answered / seconds,
+               latencyPercentile(&latencies, MEDIAN) * MICROS,
+               latencyPercentile(&latencies, HIGH) * MICROS,
+               latencyPercentile(&latencies, TAIL) * MICROS, latencies.maxLatency * MICROS);
+    }
+    free(connections);
+    free(threads);
+    return rc;
+}
+
+/**
+ * @brief asks the server for its statistics and prints them.
+ * @param socketPath the server's socket.
+ * @return SUCCESS_EXIT, or an error code.
+ */
+static int printServerStats(const char* socketPath)
+{
+    int connection = connectTo(socketPath);
+    if (connection < 0)
+    {
+        fprintf(ERROR_DEST, CONNECT_ERROR, socketPath);
+        return FOPEN_EXIT;
+    }
+    char request[] = STATS_COMMAND "\n";
+    FILE* answers = writeAll(connection, request, sizeof(request) - 1) ?
+                    fdopen(connection, SOCKET_FORMAT) : NULL;
+    if (answers == NULL)
+    {
+        close(connection);
+        fprintf(ERROR_DEST, CONNECT_ERROR, socketPath);
+        return FOPEN_EXIT;
+    }
+    shutdown(connection, SHUT_WR);
+
+    //the statistics end with an empty line.
+    char* line = NULL;
+    size_t capacity = 0;
+    while (getline(&line, &capacity, answers) > 1)
+    {
+        fputs(line, stdout);
+    }
+    free(line);
+    fclose(answers);
+    return SUCCESS_EXIT;
+}
+
+/**
+ * loads a Unix socket solver server, see SudokuSolver --serve: sends the puzzles of a file over
+ * several connections at once, each sending all its puzzles without waiting for the answers,
+ * and prints a tab separated report of the number of answers, the solved puzzles, the
+ * throughput and the percentiles of the latencies, from sending a puzzle to reading its answer.
+ * usage: SudokuClient [--connections <n>] [--repeat <n>] [--stats] <socket> <puzzle file>
+ * --connections <n> sends over n connections; 1 by default.
+ * --repeat <n> sends every puzzle n times; 1 by default.
+ * --stats prints the server's statistics after the run.
+ * @param argc number of arguments.
+ * @param argv arguments.
+ * @return SUCCESS_EXIT if every puzzle was answered; an error code otherwise.
+ */
+int main(int argc, char* argv[])
+{
+    unsigned long numConnections = 1, repeat = 1;
+    unsigned long long number;
+    int stats = FALSE;
+    int i = FIRST_ARG_INDEX;
+    for (; i < argc - POSITIONAL_ARGS; i++)
+    {
+        if (strcmp(argv[i], CONNECTIONS_FLAG) == 0 &&
+            parseNumber(argv[i + 1], MAX_CONNECTIONS, &number) && number > 0)
+        {
+            numConnections = (unsigned long)number;
+            i++;
+        }
+        else if (strcmp(argv[i], REPEAT_FLAG) == 0 &&
+                 parseNumber(argv[i + 1], ULONG_MAX, &number) && number > 0)
+        {
+            repeat = (unsigned long)number;
+            i++;
+        }
+        else if (strcmp(argv[i], STATS_FLAG) == 0)
+        {
+            stats = TRUE;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (i != argc - POSITIONAL_ARGS)
+    {
+        fprintf(ERROR_DEST, ARGC_ERROR);
+        return ARGC_EXIT;
+    }
+
+    const char* socketPath = argv[i];
+    Puzzles puzzles;
+    memset(&puzzles, 0, sizeof(puzzles));
+    int rc = loadPuzzles(argv[i + 1], &puzzles);
+    if (rc == SUCCESS_EXIT && puzzles.count > 0)
+    {
+        rc = runLoad(socketPath, &puzzles, (unsigned int)numConnections, repeat);
+    }
+    freePuzzles(&puzzles);
+    if (rc == SUCCESS_EXIT && stats)
+    {
+        rc = printServerStats(socketPath);
+    }
+    fflush(stdout);
+    return rc;
+}
@@ -0,0 +1,134 @@
+// -------------------------- includes -------------------------
+
+#include "SudokuTree.h"
+#include "SudokuIO.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -------------------------- macros -------------------------
+
+//-----parameters for reading the command line.
+//number of arguments expected.
+#define EXPECTED_ARGC 3
+//index of the format flag, and of the input file's name.
+#define FORMAT_ARG_INDEX 1
+#define FILE_ARG_INDEX 2
+//flags selecting the format written.
+#define BINARY_FLAG "--binary"
+#define GRID_FLAG "--grid"
+#define LINE_FLAG "--line"
+//file name standing for the standard input.
+#define STDIN_NAME "-"
+
+//-----parameters for reading from file.
+//format for opening the input file.
+#define FILE_FORMAT "r"
+//size of a board written in LINE_FORMAT; boards of other sizes are written in GRID_FORMAT.
+#define LINE_SIZE 9
+
+//-----messages.
+//fopen error message,
+#define FOPEN_ERROR "%s:no such file\n"
+//unexpected arguments exit message
+#define ARGC_ERROR "usage: SudokuConvert --binary | --grid | --line <input file>\n"
+//fclose error message.
+#define FCLOSE_ERROR "failed to close file\n"
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief writes every puzzle of the given input to the standard output in the given format.
+ * @param inputFile the given input.
+ * @param inputFileName the name of the given input, for error messages.
+ * @param format the given format; 9x9 boards only are written in LINE_FORMAT, the others in
+ * GRID_FORMAT.
+ * @return SUCCESS_EXIT, or an error code if the input holds an invalid puzzle, in which case the
+ * puzzles before it are still written.
+ */
+static int convertPuzzles(FILE* inputFile, const char* inputFileName, RecordFormat format)
+{
+    InputReader* reader = openReader(inputFile);
+    //a single buffer, with room for the largest board in any format, holds each record in turn.
+    char* buffer = (char*)malloc(maxFormattedBytes(MAX_BOARD_SIZE, GRID_FORMAT));
+    if (reader == NULL || buffer == NULL)
+    {
+        fprintf(ERROR_DEST, MALLOC_ERROR);
+        closeReader(reader);
+        free(buffer);
+        return MALLOC_EXIT;
+    }
+
+    pBoard board;
+    RecordFormat read;
+    int rc;
+    for (unsigned long record = 1;
+         (rc = scanRecord(reader, inputFileName, record, &board, &read)) == SUCCESS_EXIT; record++)
+    {
+        RecordFormat written = format == LINE_FORMAT && getSize(board) != LINE_SIZE ?
+                               GRID_FORMAT : format;
+        fwrite(buffer, 1, formatBoard(board, written, buffer), stdout);
+        freeBoard(board);
+    }
+    if (rc == MALLOC_EXIT)
+    {
+        fprintf(ERROR_DEST, MALLOC_ERROR);
+    }
+    fflush(stdout);
+    closeReader(reader);
+    free(buffer);
+    return rc == END_OF_INPUT ? SUCCESS_EXIT : rc;
+}
+
+/**
+ * converts a file of puzzles, in any of the formats read by SudokuSolver --batch, to a single
+ * format, written to the standard output. The conversion is lossless: converting the output back
+ * gives the same boards, in the same order.
+ * usage: SudokuConvert --binary | --grid | --line <input file>
+ * --binary writes binary frames, see BINARY_FORMAT.
+ * --grid writes the size followed by a line per row, see GRID_FORMAT.
+ * --line writes 9x9 boards as 81 character lines, see LINE_FORMAT, and other boards as grids.
+ * A file name of - reads the standard input. Answers to puzzles that were not solved, such as
+ * NO_SOLUTION_ERROR, are not puzzles, and are rejected as invalid input.
+ * @param argc number of arguments.
+ * @param argv arguments.
+ * @return SUCCESS_EXIT, or an error code.
+ */
+int main(int argc, char* argv[])
+{
+    RecordFormat format;
+    const char* flag = argc == EXPECTED_ARGC ? argv[FORMAT_ARG_INDEX] : "";
+    if (strcmp(flag, BINARY_FLAG) == 0)
+    {
+        format = BINARY_FORMAT;
+    }
+    else if (strcmp(flag, GRID_FLAG) == 0)
+    {
+        format = GRID_FORMAT;
+    }
+    else if (strcmp(flag, LINE_FLAG) == 0)
+    {
+        format = LINE_FORMAT;
+    }
+    else
+    {
+        fprintf(ERROR_DEST, ARGC_ERROR);
+        return ARGC_EXIT;
+    }
+
+    const char* fileName = argv[FILE_ARG_INDEX];
+    int fromStdin = strcmp(fileName, STDIN_NAME) == 0;
+    FILE* inputFile = fromStdin ? stdin : fopen(fileName, FILE_FORMAT);
+    if (inputFile == NULL)
+    {
+        fprintf(ERROR_DEST, FOPEN_ERROR, fileName);
+        return FOPEN_EXIT;
+    }
+    int rc = convertPuzzles(inputFile, fileName, format);
+    if (!fromStdin && fclose(inputFile))
+    {
+        fprintf(ERROR_DEST, FCLOSE_ERROR);
+        return FCLOSE_EXIT;
+    }
+    return rc;
+}
@@ -0,0 +1,140 @@
+// -------------------------- includes -------------------------
+
+#include "SudokuEngine.h"
+#include "DancingLinks.h"
+#include <stdlib.h>
+#include <assert.h>
+
+// -------------------------- functions -------------------------
+
+void defaultSolverOptions(SolverOptions* options)
+{
+    assert(options != NULL);
+    options->backend = AUTO_BACKEND;
+    options->branching = FIRST_EMPTY_BRANCHING;
+    options->propagation = TRUE;
+    options->numThreads = 1;
+    options->budget.timeoutMs = 0;
+    options->budget.maxNodes = 0;
+    options->backjumping = FALSE;
+    options->nogoods = 0;
+    options->ordering = ASCENDING_ORDERING;
+    options->seed = 0;
+    options->restarts = LUBY_RESTARTS;
+    options->restartNodes = 0;
+    options->cache = NULL;
+}
+
+/**
+ * @brief return the backend the given board is solved with under the given options.
+ * AUTO_BACKEND picks the exact cover search for large boards only when every depth first search
+ * setting is the default one, so a setting asked for is never dropped.
+ * @param board the given board.
+ * @param options the given options.
+ * @return DFS_BACKEND, or DLX_BACKEND.
+ */
+static Backend chooseBackend(pBoard board, const SolverOptions* options)
+{
+    if (options->backend != AUTO_BACKEND)
+    {
+        return options->backend;
+    }
+    int defaultSearch = options->branching == FIRST_EMPTY_BRANCHING && options->propagation &&
+                        options->numThreads == 1 && options->budget.timeoutMs == 0 &&
+                        options->budget.maxNodes == 0 && !options->backjumping &&
+                        options->ordering == ASCENDING_ORDERING && options->restartNodes == 0;
+    return defaultSearch && getSize(board) >= EXACT_COVER_MIN_SIZE ? DLX_BACKEND : DFS_BACKEND;
+}
+
+/**
+ * @brief solves the given board with the backend and search settings of the given options,
+ * without the cache.
+ * @param board the given board.
+ * @param options the given options.
+ * @param finished for the result, see solveBoard().
+ * @return a new board holding the solution, as for solveBoard().
+ */
+static pBoard searchBoard(pBoard board, const SolverOptions* options, int* finished)
+{
+    *finished = TRUE;
+    if (chooseBackend(board, options) == DLX_BACKEND)
+    {
+        return solveExactCover(board);
+    }
+
+    setBranchingMode(board, options->branching);
+    setPropagation(board, options->propagation);
+    setValueOrdering(board, options->ordering, options->seed);
+    unsigned int best = getSize(board) * getSize(board);
+    if (options->numThreads != 1)
+    {
+        return getBestParallel(board, getBoardChildren, getFilledCells, freeBoard, copyBoard, best,
+                               options->numThreads);
+    }
+    DfsBackjumping backjumping = {explainBoardConflict, options->nogoods};
+    DfsRestarts restarts = {options->restarts, options->restartNodes, restartBoard};
+    const DfsBackjumping* previous = setDfsBackjumping(options->backjumping ? &backjumping : NULL);
+    const DfsRestarts* previousRestarts = setDfsRestarts(&restarts);
+    pBoard solution = getBestInPlaceBudgeted(board, getBoardMoves, applyBoardMove, undoBoardMove,
+                                             getFilledCells, freeBoard, copyBoard, getSize(board),
+                                             best, &options->budget, finished);
+    setDfsRestarts(previousRestarts);
+    setDfsBackjumping(previous);
+    return solution;
+}
+
+pBoard solveBoard(pBoard board, const SolverOptions* options, int* finished)
+{
+    assert(board != NULL && options != NULL);
+
+    int searched;
+    if (finished == NULL)
+    {
+        finished = &searched;
+    }
+    pBoard solution = NULL;
+    if (options->cache != NULL && findSolution(options->cache, board, &solution) != SUCCESS_EXIT)
+    {
+        return NULL;
+    }
+    if (solution != NULL)
+    {
+        *finished = TRUE;
+        return solution;
+    }
+
+    solution = searchBoard(board, options, finished);
+    if (solution == NULL)
+    {
+        return NULL;
+    }
+    if (getFilledCells(solution) != getSize(board) * getSize(board))
+    {
+        //a search that finished without a solution proved there is none.
+        if (*finished)
+        {
+            freeBoard(solution);
+            return NULL;
+        }
+        return solution;
+    }
+    //a solution that could not be stored is still returned.
+    if (options->cache != NULL)
+    {
+        storeSolution(options->cache, board, solution);
+    }
+    return solution;
+}
+
+int countSolutions(pBoard board, const SolverOptions* options, unsigned long limit,
+                   visitNodeFunc visit, void* data, unsigned long* count)
+{
+    assert(board != NULL && options != NULL && count != NULL);
+
+    setBranchingMode(board, options->branching);
+    setPropagation(board, options->propagation);
+    setValueOrdering(board, options->ordering, options->seed);
+    return countBestParallel(board, getBoardMoves, applyBoardMove, undoBoardMove, getFilledCells,
+                             freeBoard, copyBoard, getSize(board), getSize(board) * getSize(board),
+                             limit, visit, data, options->numThreads, count);
+}
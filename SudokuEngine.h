@@ -0,0 +1,104 @@
+#ifndef EX3_SUDOKUENGINE_H
+#define EX3_SUDOKUENGINE_H
+
+#include "SudokuTree.h"
+#include "GenericDFS.h"
+#include "SolutionCache.h"
+
+// -------------------------- macros -------------------------
+
+//the size of the smallest boards AUTO_BACKEND solves with the exact cover search. On the bench
+//corpora, Dancing Links solves 9x9 puzzles slower than the depth first search with propagation,
+//and 16x16 and 25x25 ones faster.
+#define EXACT_COVER_MIN_SIZE 16
+
+// -------------------------- structs & typedef -------------------------
+
+/**
+ * @brief The algorithms a board can be solved with.
+ */
+typedef enum Backend
+{
+    //the exact cover search for boards of EXACT_COVER_MIN_SIZE and up, unless the options ask for
+    //a setting only the depth first search has; the depth first search otherwise.
+    AUTO_BACKEND,
+    //depth first search over the board's moves, see getBestInPlace().
+    DFS_BACKEND,
+    //Dancing Links exact cover search, see solveExactCover().
+    DLX_BACKEND
+} Backend;
+
+/**
+ * @brief The settings a board is solved with.
+ */
+typedef struct SolverOptions
+{
+    Backend backend;
+    BranchingMode branching;
+    int propagation;
+    //number of threads searching a single board; 0 for one per processor.
+    unsigned int numThreads;
+    //limits on the search of a single board. Only single threaded depth first searches are
+    //limited; see getBestInPlaceBudgeted().
+    DfsBudget budget;
+    //TRUE to jump back over the levels a dead end is not to blame on, see setDfsBackjumping(),
+    //learning at most nogoods nogoods. Only single threaded depth first searches jump back.
+    int backjumping;
+    size_t nogoods;
+    //the order the values of a cell are tried in, and the seed of RANDOM_ORDERING.
+    ValueOrdering ordering;
+    unsigned long long seed;
+    //the schedule of the node budgets of the runs of the search, and the number of nodes they are
+    //multiples of; 0 to search in a single run, see setDfsRestarts(). Only single threaded depth
+    //first searches restart.
+    RestartSchedule restarts;
+    unsigned long long restartNodes;
+    //the cache solutions are looked up in before a board is solved, and stored in after; NULL
+    //for none.
+    SolutionCache* cache;
+} SolverOptions;
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief sets the given options to the default settings: the backend chosen by the board's size,
+ * see AUTO_BACKEND, and a single threaded depth first search with propagation, branching on the
+ * first empty cell, trying its values in ascending order and backtracking one level at a time, in
+ * a single run, with no budget and no cache.
+ * @param options the given options.
+ */
+void defaultSolverOptions(SolverOptions* options);
+
+/**
+ * @brief solves the given board with the backend and search settings of the given options. With a
+ * cache, a board whose solution, or the solution of a board it is an image of, is cached is not
+ * solved again; if it has several solutions, the cached one may differ from the one found by
+ * solving it. A board the search proves to have no solution gives no board: the fullest partial
+ * board each backend reaches depends on how it prunes, see getBoardChildren(), so it is dropped
+ * and every backend and setting gives the same answer.
+ * @param board the given board.
+ * @param options the given options.
+ * @param finished for the result: FALSE if the options' budget ran out before the search found a
+ * solution or searched every branch, TRUE otherwise; may be NULL.
+ * @return a new board holding the solution, or the best partial solution found if the budget ran
+ * out; NULL if the board has no solution, or in case of an error.
+ */
+pBoard solveBoard(pBoard board, const SolverOptions* options, int* finished);
+
+/**
+ * @brief counts the solutions of the given board with the search settings of the given options,
+ * using the options' number of threads. Counting always uses depth first search.
+ * @param board the given board; not modified.
+ * @param options the given options.
+ * @param limit the number of solutions to stop at; 0 for no limit. A limit of 2 tells whether the
+ * solution is unique.
+ * @param visit a function called with every solution found, see countBestParallel(); may be
+ * NULL.
+ * @param data passed to visit.
+ * @param count for the result: the number of solutions found.
+ * @return SUCCESS_EXIT, or ERROR in case of an error.
+ */
+int countSolutions(pBoard board, const SolverOptions* options, unsigned long limit,
+                   visitNodeFunc visit, void* data, unsigned long* count);
+
+#endif //EX3_SUDOKUENGINE_H
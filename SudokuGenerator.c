@@ -0,0 +1,680 @@
+// -------------------------- includes -------------------------
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "SudokuTree.h"
+#include "SudokuIO.h"
+#include "SudokuEngine.h"
+#include "SudokuSymmetry.h"
+#include "DancingLinks.h"
+#include "GenericDFS.h"
+#include "ToolUtils.h"
+#include <pthread.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// -------------------------- macros -------------------------
+
+//-----parameters for reading the command line.
+//index of the first argument.
+#define FIRST_ARG_INDEX 1
+//flag setting the board's size; followed by the size.
+#define SIZE_FLAG "--size"
+//flag setting the number of puzzles; followed by the number, 0 for no limit.
+#define COUNT_FLAG "--count"
+//flag setting the seed; followed by the seed.
+#define SEED_FLAG "--seed"
+//flag setting the number of threads; followed by the number, 0 for one per processor.
+#define THREADS_FLAG "--threads"
+//flag setting the number of clues to aim for; followed by the number.
+#define CLUES_FLAG "--clues"
+//flag setting the number of search nodes to aim for; followed by the number.
+#define MIN_NODES_FLAG "--min-nodes"
+//flag writing the puzzles in GRID_FORMAT even when they fit a line.
+#define GRID_FLAG "--grid"
+
+//-----parameters for generating.
+//default size of the boards.
+#define DEFAULT_SIZE 9
+//default number of puzzles.
+#define DEFAULT_COUNT 1
+//default seed; the same seed gives the same puzzles, whatever the number of threads.
+#define DEFAULT_SEED 1
+//number of grids a puzzle is dug out of, at most, looking for one meeting its targets.
+#define MAX_ATTEMPTS 100
+//number of puzzles held in memory per worker thread.
+#define SLOTS_PER_WORKER 4
+//size of a board whose puzzles fit LINE_FORMAT.
+#define LINE_SIZE 9
+//solution count telling a puzzle has more than one solution.
+#define NOT_UNIQUE 2
+
+//-----messages.
+//unexpected arguments exit message
+#define ARGC_ERROR "usage: SudokuGenerator [--size <n>] [--count <n>] [--seed <n>] " \
+                   "[--threads <n>] [--clues <n>] [--min-nodes <n>] [--grid]\n"
+
+// -------------------------- structs -------------------------
+
+/**
+ * @brief What the puzzles are generated with.
+ */
+typedef struct GeneratorOptions
+{
+    unsigned int size;
+    unsigned int blockSize;
+    //number of puzzles; 0 for no limit.
+    unsigned long count;
+    unsigned long long seed;
+    //number of clues to stop removing clues at.
+    unsigned int targetClues;
+    //number of nodes the solver's default search should visit solving a puzzle, at least.
+    unsigned long long minNodes;
+    RecordFormat format;
+} GeneratorOptions;
+
+/**
+ * @brief A generated puzzle, written in its turn; a slot not ready is owned by a worker.
+ */
+typedef struct Slot
+{
+    int ready;
+    char* text;
+    size_t length;
+} Slot;
+
+/**
+ * @brief The state shared by the workers and the writer of a run.
+ * Slots are used as a ring: puzzle number n is generated into slots[n % numSlots]. taken puzzles
+ * were taken by workers and written of them were written.
+ */
+typedef struct Generator
+{
+    GeneratorOptions options;
+    Slot* slots;
+    unsigned long numSlots;
+    unsigned long taken;
+    unsigned long written;
+    int failed;
+    pthread_mutex_t lock;
+    pthread_cond_t spaceCond;
+    pthread_cond_t readyCond;
+} Generator;
+
+/**
+ * @brief A puzzle dug out of a grid, and how far it is from its targets.
+ */
+typedef struct Candidate
+{
+    unsigned char cells[MAX_BOARD_SIZE * MAX_BOARD_SIZE];
+    unsigned int clues;
+    unsigned long long nodes;
+} Candidate;
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief return the next number of the given random generator, see splitmix64.
+ * @param state the generator's state.
+ * @return the number.
+ */
+static uint64_t nextRandom(uint64_t* state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief shuffles the given values with the given random generator.
+ * @param values the given values.
+ * @param count the number of values.
+ * @param state the generator's state.
+ */
+static void shuffle(unsigned char* values, unsigned int count, uint64_t* state)
+{
+    for (unsigned int i = count; i > 1; i--)
+    {
+        unsigned int j = (unsigned int)(nextRandom(state) % i);
+        unsigned char value = values[i - 1];
+        values[i - 1] = values[j];
+        values[j] = value;
+    }
+}
+
+/**
+ * @brief sets the given values to 0 .. count - 1, shuffled.
+ * @param values the given values.
+ * @param count the number of values.
+ * @param state the random generator's state.
+ */
+static void randomOrder(unsigned char* values, unsigned int count, uint64_t* state)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        values[i] = (unsigned char)i;
+    }
+    shuffle(values, count, state);
+}
+
+/**
+ * @brief draws a random symmetry of boards of the given options' size.
+ * @param options the given options.
+ * @param symmetry for the result: the symmetry.
+ * @param state the random generator's state.
+ */
+static void randomSymmetry(const GeneratorOptions* options, Symmetry* symmetry, uint64_t* state)
+{
+    unsigned int blockSize = options->blockSize;
+    unsigned char bands[MAX_BOARD_SIZE], inBand[MAX_BOARD_SIZE];
+    symmetry->size = options->size;
+    symmetry->transposed = (int)(nextRandom(state) & 1);
+    unsigned char* lines[] = {symmetry->rows, symmetry->cols};
+    for (unsigned int l = 0; l < sizeof(lines) / sizeof(lines[0]); l++)
+    {
+        randomOrder(bands, blockSize, state);
+        for (unsigned int b = 0; b < blockSize; b++)
+        {
+            randomOrder(inBand, blockSize, state);
+            for (unsigned int r = 0; r < blockSize; r++)
+            {
+                lines[l][b * blockSize + r] = (unsigned char)(bands[b] * blockSize + inBand[r]);
+            }
+        }
+    }
+    randomOrder(symmetry->digits + 1, options->size, state);
+    symmetry->digits[0] = 0;
+    for (unsigned int val = 1; val <= options->size; val++)
+    {
+        symmetry->digits[val]++;
+    }
+}
+
+/**
+ * @brief return a new board holding the given cells.
+ * @param size the board's size.
+ * @param cells the given cells, row by row; 0 for empty cells.
+ * @return the board, or NULL if allocation failed.
+ */
+static pBoard boardOf(unsigned int size, const unsigned char* cells)
+{
+    pBoard board = (pBoard)newBoard(size);
+    for (unsigned int k = 0; board != NULL && k < size * size; k++)
+    {
+        setCell(board, k / size, k % size, cells[k]);
+    }
+    return board;
+}
+
+/**
+ * @brief creates a random full grid: fills the blocks on the diagonal, which share no row or
+ * column, with random values, completes the board with the exact cover solver, and maps the
+ * completion through a random symmetry.
+ * @param options the given options.
+ * @param cells for the result: the grid's cells, row by row.
+ * @param state the random generator's state.
+ * @return SUCCESS_EXIT; ERROR if the completion failed, or allocation did.
+ */
+static int randomGrid(const GeneratorOptions* options, unsigned char* cells, uint64_t* state)
+{
+    unsigned int size = options->size, blockSize = options->blockSize;
+    pBoard board = (pBoard)newBoard(size);
+    if (board == NULL)
+    {
+        return ERROR;
+    }
+    unsigned char values[MAX_BOARD_SIZE];
+    for (unsigned int b = 0; b < blockSize; b++)
+    {
+        randomOrder(values, size, state);
+        for (unsigned int k = 0; k < size; k++)
+        {
+            setCell(board, b * blockSize + k / blockSize, b * blockSize + k % blockSize,
+                    values[k] + 1u);
+        }
+    }
+    pBoard grid = solveExactCover(board);
+    freeBoard(board);
+    if (grid == NULL || getFilledCells(grid) != size * size)
+    {
+        freeBoard(grid);
+        return ERROR;
+    }
+    Symmetry symmetry;
+    randomSymmetry(options, &symmetry, state);
+    mapToImage(&symmetry, grid, cells);
+    freeBoard(grid);
+    return SUCCESS_EXIT;
+}
+
+/**
+ * @brief removes clues from the given grid, in a random order, as long as the puzzle keeps a
+ * unique solution, until the options' number of clues is reached or no clue can be removed.
+ * @param options the given options.
+ * @param candidate the grid; for the result: the puzzle and its number of clues.
+ * @param state the random generator's state.
+ * @return SUCCESS_EXIT, or ERROR if allocation failed.
+ */
+static int digPuzzle(const GeneratorOptions* options, Candidate* candidate, uint64_t* state)
+{
+    unsigned int size = options->size, numCells = size * size;
+    //the uniqueness checks branch on the most constrained cell, which keeps them short.
+    SolverOptions checking;
+    defaultSolverOptions(&checking);
+    checking.branching = MIN_REMAINING_BRANCHING;
+    candidate->clues = numCells;
+    //the cells are tried in a random order.
+    unsigned int* cells = (unsigned int*)malloc(numCells * sizeof(unsigned int));
+    if (cells == NULL)
+    {
+        return ERROR;
+    }
+    for (unsigned int k = 0; k < numCells; k++)
+    {
+        cells[k] = k;
+    }
+    for (unsigned int k = numCells; k > 1; k--)
+    {
+        unsigned int j = (unsigned int)(nextRandom(state) % k);
+        unsigned int cell = cells[k - 1];
+        cells[k - 1] = cells[j];
+        cells[j] = cell;
+    }
+    int rc = SUCCESS_EXIT;
+    for (unsigned int k = 0; rc == SUCCESS_EXIT && k < numCells &&
+                             candidate->clues > options->targetClues; k++)
+    {
+        unsigned char value = candidate->cells[cells[k]];
+        candidate->cells[cells[k]] = 0;
+        pBoard puzzle = boardOf(size, candidate->cells);
+        unsigned long count = 0;
+        if (puzzle == NULL ||
+            countSolutions(puzzle, &checking, NOT_UNIQUE, NULL, NULL, &count) != SUCCESS_EXIT)
+        {
+            rc = ERROR;
+        }
+        if (count == 1)
+        {
+            candidate->clues--;
+        }
+        else
+        {
+            candidate->cells[cells[k]] = value;
+        }
+        freeBoard(puzzle);
+    }
+    free(cells);
+    return rc;
+}
+
+/**
+ * @brief return the number of nodes the solver's default search visits solving the given puzzle.
+ * @param options the given options.
+ * @param cells the puzzle's cells, row by row.
+ * @param nodes for the result: the number of nodes.
+ * @return SUCCESS_EXIT, or ERROR if allocation failed.
+ */
+static int measureNodes(const GeneratorOptions* options, const unsigned char* cells,
+                        unsigned long long* nodes)
+{
+    pBoard puzzle = boardOf(options->size, cells);
+    if (puzzle == NULL)
+    {
+        return ERROR;
+    }
+    SolverOptions solving;
+    defaultSolverOptions(&solving);
+    //the exact cover search does not count nodes.
+    solving.backend = DFS_BACKEND;
+    DfsStats stats;
+    memset(&stats, 0, sizeof(stats));
+    DfsStats* previous = setDfsStats(&stats);
+    pBoard solution = solveBoard(puzzle, &solving, NULL);
+    setDfsStats(previous);
+    freeBoard(puzzle);
+    freeBoard(solution);
+    *nodes = stats.nodes;
+    return solution != NULL ? SUCCESS_EXIT : ERROR;
+}
+
+/**
+ * @brief return the number of clues the given puzzle has beyond the options' target.
+ * @param options the given options.
+ * @param candidate the given puzzle.
+ * @return the number of clues; 0 if the puzzle meets the target, or there is none.
+ */
+static unsigned int extraClues(const GeneratorOptions* options, const Candidate* candidate)
+{
+    if (options->targetClues == 0 || candidate->clues <= options->targetClues)
+    {
+        return 0;
+    }
+    return candidate->clues - options->targetClues;
+}
+
+/**
+ * @brief return whether the first given puzzle is closer to the options' targets than the second:
+ * it has fewer clues beyond the target number, or as many and takes more nodes to solve.
+ * @param options the given options.
+ * @param candidate the first given puzzle.
+ * @param best the second given puzzle.
+ * @return TRUE if it is closer; FALSE otherwise.
+ */
+static int isCloser(const GeneratorOptions* options, const Candidate* candidate,
+                    const Candidate* best)
+{
+    unsigned int extra = extraClues(options, candidate), bestExtra = extraClues(options, best);
+    return extra < bestExtra || (extra == bestExtra && candidate->nodes > best->nodes);
+}
+
+/**
+ * @brief generates the puzzle of the given number: digs puzzles out of random grids until one
+ * meets the options' targets, or MAX_ATTEMPTS grids were dug, in which case the puzzle closest
+ * to the targets is taken. The puzzle depends on the options' seed and its number alone.
+ * @param options the given options.
+ * @param number the puzzle's number.
+ * @param attempt room for a puzzle being dug.
+ * @param best room for the closest puzzle dug.
+ * @return SUCCESS_EXIT, or ERROR if no grid could be completed or allocation failed.
+ */
+static int generatePuzzle(const GeneratorOptions* options, unsigned long number,
+                          Candidate* attempt, Candidate* best)
+{
+    uint64_t state = options->seed ^ ((uint64_t)number * 0xD1B54A32D192ED03ULL);
+    int found = FALSE;
+    for (unsigned int a = 0; a < MAX_ATTEMPTS; a++)
+    {
+        if (randomGrid(options, attempt->cells, &state) != SUCCESS_EXIT)
+        {
+            continue;
+        }
+        attempt->nodes = 0;
+        if (digPuzzle(options, attempt, &state) != SUCCESS_EXIT ||
+            (options->minNodes > 0 &&
+             measureNodes(options, attempt->cells, &attempt->nodes) != SUCCESS_EXIT))
+        {
+            return ERROR;
+        }
+        if (!found || isCloser(options, attempt, best))
+        {
+            memcpy(best, attempt, sizeof(Candidate));
+            found = TRUE;
+        }
+        if (extraClues(options, best) == 0 && best->nodes >= options->minNodes)
+        {
+            break;
+        }
+    }
+    return found ? SUCCESS_EXIT : ERROR;
+}
+
+/**
+ * @brief generates puzzles into free slots, in the order of their numbers, until every puzzle
+ * was taken or the run failed.
+ * @param arg the generator.
+ * @return NULL.
+ */
+static void* runWorker(void* arg)
+{
+    Generator* generator = (Generator*)arg;
+    const GeneratorOptions* options = &generator->options;
+    Candidate* candidates = (Candidate*)malloc(2 * sizeof(Candidate));
+    pthread_mutex_lock(&generator->lock);
+    if (candidates == NULL)
+    {
+        generator->failed = MALLOC_EXIT;
+        pthread_cond_broadcast(&generator->readyCond);
+    }
+    while (TRUE)
+    {
+        while (!generator->failed && (options->count == 0 || generator->taken < options->count) &&
+               generator->taken - generator->written == generator->numSlots)
+        {
+            pthread_cond_wait(&generator->spaceCond, &generator->lock);
+        }
+        if (generator->failed || (options->count != 0 && generator->taken == options->count))
+        {
+            pthread_mutex_unlock(&generator->lock);
+            free(candidates);
+            return NULL;
+        }
+        unsigned long number = generator->taken++;
+        Slot* slot = &generator->slots[number % generator->numSlots];
+        pthread_mutex_unlock(&generator->lock);
+
+        int rc = generatePuzzle(options, number, &candidates[0], &candidates[1]);
+        pBoard puzzle = rc == SUCCESS_EXIT ? boardOf(options->size, candidates[1].cells) : NULL;
+        if (puzzle != NULL)
+        {
+            slot->length = formatBoard(puzzle, options->format, slot->text);
+            freeBoard(puzzle);
+        }
+
+        pthread_mutex_lock(&generator->lock);
+        if (puzzle == NULL)
+        {
+            generator->failed = MALLOC_EXIT;
+        }
+        slot->ready = TRUE;
+        pthread_cond_broadcast(&generator->readyCond);
+    }
+}
+
+/**
+ * @brief writes the generated puzzles in the order of their numbers, flushing each, until every
+ * puzzle was written or the run failed.
+ * @param generator the given generator.
+ * @param outputFile the file to write to.
+ * @return SUCCESS_EXIT, or an error code.
+ */
+static int writePuzzles(Generator* generator, FILE* outputFile)
+{
+    unsigned long count = generator->options.count;
+    pthread_mutex_lock(&generator->lock);
+    while (!generator->failed && (count == 0 || generator->written < count))
+    {
+        Slot* slot = &generator->slots[generator->written % generator->numSlots];
+        while (!slot->ready && !generator->failed)
+        {
+            pthread_cond_wait(&generator->readyCond, &generator->lock);
+        }
+        if (generator->failed)
+        {
+            break;
+        }
+        pthread_mutex_unlock(&generator->lock);
+
+        fwrite(slot->text, 1, slot->length, outputFile);
+        int failed = fflush(outputFile) != 0;
+
+        pthread_mutex_lock(&generator->lock);
+        generator->failed = failed ? ERROR : generator->failed;
+        slot->ready = FALSE;
+        generator->written++;
+        pthread_cond_broadcast(&generator->spaceCond);
+    }
+    int rc = generator->failed;
+    pthread_mutex_unlock(&generator->lock);
+    return rc;
+}
+
+/**
+ * @brief generates the puzzles of the given options with the given number of worker threads and
+ * writes them, in order, to the given file.
+ * @param options the given options.
+ * @param numThreads the number of worker threads; 0 for one per online processor.
+ * @param outputFile the file to write to.
+ * @return SUCCESS_EXIT, or an error code.
+ */
+static int generatePuzzles(const GeneratorOptions* options, unsigned int numThreads,
+                           FILE* outputFile)
+{
+    if (numThreads == 0)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        numThreads = online > 0 ? (unsigned int)online : 1;
+    }
+
+    Generator generator;
+    memset(&generator, 0, sizeof(generator));
+    generator.options = *options;
+    generator.numSlots = (unsigned long)numThreads * SLOTS_PER_WORKER;
+    generator.slots = (Slot*)calloc(generator.numSlots, sizeof(Slot));
+    pthread_t* threads = (pthread_t*)malloc(numThreads * sizeof(pthread_t));
+    int rc = generator.slots != NULL && threads != NULL ? SUCCESS_EXIT : MALLOC_EXIT;
+    size_t bytes = maxFormattedBytes(options->size, options->format);
+    for (unsigned long i = 0; rc == SUCCESS_EXIT && i < generator.numSlots; i++)
+    {
+        generator.slots[i].text = (char*)malloc(bytes);
+        rc = generator.slots[i].text != NULL ? SUCCESS_EXIT : MALLOC_EXIT;
+    }
+    pthread_mutex_init(&generator.lock, NULL);
+    pthread_cond_init(&generator.spaceCond, NULL);
+    pthread_cond_init(&generator.readyCond, NULL);
+
+    unsigned int started = 0;
+    while (rc == SUCCESS_EXIT && started < numThreads &&
+           pthread_create(&threads[started], NULL, runWorker, &generator) == 0)
+    {
+        started++;
+    }
+    if (started > 0)
+    {
+        rc = writePuzzles(&generator, outputFile);
+    }
+    else if (rc == SUCCESS_EXIT)
+    {
+        rc = MALLOC_EXIT;
+    }
+
+    pthread_mutex_lock(&generator.lock);
+    generator.failed = rc != SUCCESS_EXIT ? rc : generator.failed;
+    pthread_cond_broadcast(&generator.spaceCond);
+    pthread_mutex_unlock(&generator.lock);
+    for (unsigned int i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    if (rc == MALLOC_EXIT)
+    {
+        fprintf(ERROR_DEST, MALLOC_ERROR);
+    }
+    for (unsigned long i = 0; generator.slots != NULL && i < generator.numSlots; i++)
+    {
+        free(generator.slots[i].text);
+    }
+    pthread_mutex_destroy(&generator.lock);
+    pthread_cond_destroy(&generator.spaceCond);
+    pthread_cond_destroy(&generator.readyCond);
+    free(generator.slots);
+    free(threads);
+    return rc;
+}
+
+/**
+ * @brief parse the command line into the given options.
+ * @param argc number of arguments.
+ * @param argv arguments.
+ * @param options for the result: the options.
+ * @param numThreads for the result: the number of worker threads.
+ * @return TRUE if the command line is valid; FALSE otherwise.
+ */
+static int parseArguments(int argc, char* argv[], GeneratorOptions* options,
+                          unsigned int* numThreads)
+{
+    unsigned long long number;
+    int grid = FALSE;
+    options->size = DEFAULT_SIZE;
+    options->count = DEFAULT_COUNT;
+    options->seed = DEFAULT_SEED;
+    options->targetClues = 0;
+    options->minNodes = 0;
+    *numThreads = 0;
+    for (int i = FIRST_ARG_INDEX; i < argc; i++)
+    {
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], GRID_FLAG) == 0)
+        {
+            grid = TRUE;
+            continue;
+        }
+        if (strcmp(argv[i], SIZE_FLAG) == 0 && parseNumber(value, MAX_BOARD_SIZE, &number) &&
+            number > 0)
+        {
+            options->size = (unsigned int)number;
+        }
+        else if (strcmp(argv[i], COUNT_FLAG) == 0 && parseNumber(value, ULONG_MAX, &number))
+        {
+            options->count = (unsigned long)number;
+        }
+        else if (strcmp(argv[i], SEED_FLAG) == 0 && parseNumber(value, ULLONG_MAX, &number))
+        {
+            options->seed = number;
+        }
+        else if (strcmp(argv[i], THREADS_FLAG) == 0 && parseNumber(value, UINT_MAX, &number))
+        {
+            *numThreads = (unsigned int)number;
+        }
+        else if (strcmp(argv[i], CLUES_FLAG) == 0 && parseNumber(value, UINT_MAX, &number))
+        {
+            options->targetClues = (unsigned int)number;
+        }
+        else if (strcmp(argv[i], MIN_NODES_FLAG) == 0 && parseNumber(value, ULLONG_MAX, &number))
+        {
+            options->minNodes = number;
+        }
+        else
+        {
+            return FALSE;
+        }
+        i++;
+    }
+    options->blockSize = 1;
+    while (options->blockSize * options->blockSize < options->size)
+    {
+        options->blockSize++;
+    }
+    options->format = options->size == LINE_SIZE && !grid ? LINE_FORMAT : GRID_FORMAT;
+    return options->blockSize * options->blockSize == options->size;
+}
+
+/**
+ * generates sudoku puzzles with unique solutions and writes them to the standard output, one
+ * record at a time in the solver's input format: a line per 9x9 puzzle, or GRID_FORMAT.
+ * Each puzzle is dug out of a random full grid by removing its clues in a random order, keeping
+ * each removal only if the puzzle still has a unique solution, until the target number of clues
+ * is reached or no clue can be removed. A puzzle missing the targets is dug again out of another
+ * grid, up to MAX_ATTEMPTS times, and the puzzle closest to them is written. Puzzles are
+ * generated by several threads and written in order, so a seed gives the same output whatever
+ * the number of threads.
+ * usage: SudokuGenerator [--size <n>] [--count <n>] [--seed <n>] [--threads <n>] [--clues <n>]
+ * [--min-nodes <n>] [--grid]
+ * --size <n> generates n x n puzzles; 9 by default. n must be a square.
+ * --count <n> generates n puzzles, or puzzles until the output is closed for 0; 1 by default.
+ * --seed <n> seeds the random choices; DEFAULT_SEED by default.
+ * --threads <n> generates with n threads; 0, the default, for one per online processor.
+ * --clues <n> stops removing clues once n are left; 0, the default, for a minimal puzzle.
+ * --min-nodes <n> aims for puzzles whose solving, by SudokuSolver's default search, visits at
+ * least n nodes. The nodes are counted by the search statistics, see setDfsStats(), so the target
+ * is never met when they are compiled out.
+ * --grid writes 9x9 puzzles in GRID_FORMAT too.
+ * @param argc number of arguments.
+ * @param argv arguments.
+ * @return SUCCESS_EXIT, or an error code.
+ */
+int main(int argc, char* argv[])
+{
+    GeneratorOptions options;
+    unsigned int numThreads;
+    if (!parseArguments(argc, argv, &options, &numThreads))
+    {
+        fprintf(ERROR_DEST, ARGC_ERROR);
+        return ARGC_EXIT;
+    }
+    return generatePuzzles(&options, numThreads, stdout);
+}
@@ -0,0 +1,875 @@
+// -------------------------- includes -------------------------
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "SudokuIO.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// -------------------------- macros -------------------------
+
+//-----parameters for reading from file.
+//number of bytes of a regular file mapped at a time; a multiple of the page size.
+#define MAP_WINDOW ((size_t)1 << 26)
+//number of bytes read at a time from other inputs.
+#define READ_BLOCK ((size_t)1 << 20)
+//size of buffer for the name of a record in error messages.
+#define RECORD_NAME_SIZE 256
+//parsed numbers stop growing past this bound, which no valid value reaches.
+#define MAX_PARSED_NUMBER 100000000u
+//base of the parsed numbers.
+#define DECIMAL 10
+
+//-----parameters for checking input
+//board shape.
+#define SQUARED 2
+//size of a board in LINE_FORMAT.
+#define LINE_SIZE 9
+//empty cell characters in LINE_FORMAT.
+#define EMPTY_ZERO '0'
+#define EMPTY_DOT '.'
+//carriage return, tolerated before the end of a LINE_FORMAT record.
+#define CARRIAGE_RETURN '\r'
+//blank characters, skipped in front of a number.
+#define TAB '\t'
+#define VERTICAL_TAB '\v'
+#define FORM_FEED '\f'
+
+//-----parameters for BINARY_FORMAT.
+//first byte of a frame; no text record starts with it.
+#define FRAME_MAGIC 0xB5
+//number of bytes of a frame's header: the magic byte and the size.
+#define FRAME_HEADER_BYTES 2
+//number of bits of a byte, and a mask of them.
+#define BYTE_BITS 8
+#define BYTE_MASK 0xFFu
+
+//-----parameters for printing board.
+//end-line delimiter
+#define END_LINE '\n'
+//mid-line delimiter
+#define SPACE ' '
+//printing format.
+#define PRINT_FORMAT "%u%c"
+//printing format for board size.
+#define PRINT_SIZE_FORMAT "%u\n"
+//max number of characters of a formatted value, including its delimiter.
+#define MAX_VALUE_CHARS 4
+
+// -------------------------- structs -------------------------
+
+/**
+ * @brief An input read a line at a time. A regular file is mapped into memory a window at a
+ * time, and its lines are parsed where they lie; other inputs are read in blocks into a buffer.
+ * Either way, only the window or the buffer is held in memory, whatever the size of the input.
+ */
+struct InputReader
+{
+    FILE* file;
+    //TRUE if the input is a regular file read through mappings.
+    int mapped;
+    //mapped inputs: the size of the file, and the offset of the window in it.
+    off_t fileSize;
+    off_t windowOffset;
+    //the mapped window or the buffer, the number of bytes it holds and the size of the mapping
+    //or the buffer.
+    char* window;
+    size_t windowBytes;
+    size_t capacity;
+    //the offset in the window of the first byte not read yet.
+    size_t pos;
+    //TRUE once the window holds the last byte of the input.
+    int atEnd;
+};
+
+// -------------------------- reader functions -------------------------
+
+InputReader* openReader(FILE* inputFile)
+{
+    assert(inputFile != NULL);
+
+    InputReader* reader = (InputReader*)calloc(1, sizeof(InputReader));
+    if (reader == NULL)
+    {
+        return NULL;
+    }
+    reader->file = inputFile;
+
+    struct stat info;
+    off_t offset = ftello(inputFile);
+    if (fstat(fileno(inputFile), &info) == 0 && S_ISREG(info.st_mode) && offset >= 0 &&
+        info.st_size > offset)
+    {
+        //the first slide maps the window holding the current offset of the file.
+        reader->mapped = TRUE;
+        reader->fileSize = info.st_size;
+        reader->windowOffset = offset;
+    }
+    return reader;
+}
+
+void closeReader(InputReader* reader)
+{
+    if (reader == NULL)
+    {
+        return;
+    }
+    if (reader->mapped)
+    {
+        if (reader->window != NULL)
+        {
+            munmap(reader->window, reader->capacity);
+        }
+    }
+    else
+    {
+        free(reader->window);
+    }
+    free(reader);
+}
+
+/**
+ * @brief maps the window starting at the page holding the first unread byte of the given mapped
+ * input. If that byte already lies in the window's first page, the window is doubled instead, so
+ * each slide brings in more of the current line.
+ * @param reader the given input.
+ * @return SUCCESS_EXIT, or MALLOC_EXIT if mapping failed.
+ */
+static int slideMapping(InputReader* reader)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    off_t next = reader->windowOffset + (off_t)reader->pos;
+    off_t offset = next - next % (off_t)page;
+    size_t length = MAP_WINDOW;
+    if (reader->window != NULL && offset == reader->windowOffset)
+    {
+        length = 2 * reader->capacity;
+    }
+    if ((off_t)length > reader->fileSize - offset)
+    {
+        length = (size_t)(reader->fileSize - offset);
+    }
+
+    if (reader->window != NULL)
+    {
+        munmap(reader->window, reader->capacity);
+        reader->window = NULL;
+    }
+    void* window = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fileno(reader->file), offset);
+    if (window == MAP_FAILED)
+    {
+        return MALLOC_EXIT;
+    }
+    posix_madvise(window, length, POSIX_MADV_SEQUENTIAL);
+    reader->window = (char*)window;
+    reader->windowOffset = offset;
+    reader->windowBytes = length;
+    reader->capacity = length;
+    reader->pos = (size_t)(next - offset);
+    reader->atEnd = offset + (off_t)length == reader->fileSize;
+    return SUCCESS_EXIT;
+}
+
+/**
+ * @brief moves the unread bytes of the given streamed input to the front of its buffer, growing
+ * the buffer if they fill it, and reads the next block after them.
+ * @param reader the given input.
+ * @return SUCCESS_EXIT, or MALLOC_EXIT if allocation failed.
+ */
+static int refillBuffer(InputReader* reader)
+{
+    size_t unread = reader->windowBytes - reader->pos;
+    if (unread > 0)
+    {
+        memmove(reader->window, reader->window + reader->pos, unread);
+    }
+    reader->windowBytes = unread;
+    reader->pos = 0;
+    if (reader->capacity - unread < READ_BLOCK)
+    {
+        size_t capacity = reader->capacity ? 2 * reader->capacity : READ_BLOCK;
+        capacity = capacity < unread + READ_BLOCK ? unread + READ_BLOCK : capacity;
+        char* window = (char*)realloc(reader->window, capacity);
+        if (window == NULL)
+        {
+            return MALLOC_EXIT;
+        }
+        reader->window = window;
+        reader->capacity = capacity;
+    }
+
+    //the descriptor is read directly, so a pipe or a socket hands over whatever it holds instead
+    //of blocking until the whole block arrives.
+    ssize_t bytes;
+    do
+    {
+        bytes = read(fileno(reader->file), reader->window + unread, reader->capacity - unread);
+    } while (bytes < 0 && errno == EINTR);
+    reader->windowBytes += bytes > 0 ? (size_t)bytes : 0;
+    reader->atEnd = bytes <= 0;
+    return SUCCESS_EXIT;
+}
+
+/**
+ * @brief return the next line of the given input, without its end-line delimiter. The line stays
+ * valid until the next call.
+ * @param reader the given input.
+ * @param line for the result: the first character of the line.
+ * @param length for the result: the number of characters of the line.
+ * @return SUCCESS_EXIT; END_OF_INPUT if the input has no more lines; MALLOC_EXIT if reading
+ * failed.
+ */
+static int nextLine(InputReader* reader, const char** line, size_t* length)
+{
+    while (TRUE)
+    {
+        const char* start = reader->window + reader->pos;
+        size_t unread = reader->windowBytes - reader->pos;
+        const char* end = unread > 0 ? (const char*)memchr(start, END_LINE, unread) : NULL;
+        if (end != NULL || (reader->atEnd && unread > 0))
+        {
+            *line = start;
+            *length = end != NULL ? (size_t)(end - start) : unread;
+            reader->pos += end != NULL ? *length + 1 : unread;
+            return SUCCESS_EXIT;
+        }
+        if (reader->atEnd)
+        {
+            return END_OF_INPUT;
+        }
+
+        int rc = reader->mapped ? slideMapping(reader) : refillBuffer(reader);
+        if (rc != SUCCESS_EXIT)
+        {
+            return rc;
+        }
+    }
+}
+
+/**
+ * @brief return the next given number of bytes of the given input, without consuming them. The
+ * bytes stay valid until the next call.
+ * @param reader the given input.
+ * @param count the given number of bytes.
+ * @param bytes for the result: the first of the bytes.
+ * @return SUCCESS_EXIT; END_OF_INPUT if the input ends before; MALLOC_EXIT if reading failed.
+ */
+static int peekBytes(InputReader* reader, size_t count, const unsigned char** bytes)
+{
+    while (reader->windowBytes - reader->pos < count)
+    {
+        if (reader->atEnd)
+        {
+            return END_OF_INPUT;
+        }
+        int rc = reader->mapped ? slideMapping(reader) : refillBuffer(reader);
+        if (rc != SUCCESS_EXIT)
+        {
+            return rc;
+        }
+    }
+    *bytes = (const unsigned char*)reader->window + reader->pos;
+    return SUCCESS_EXIT;
+}
+
+/**
+ * @brief skips the empty lines in front of the next record of the given input.
+ * @param reader the given input.
+ * @param first for the result: the first byte of the record, which is not consumed.
+ * @return SUCCESS_EXIT; END_OF_INPUT if the input has no more records; MALLOC_EXIT if reading
+ * failed.
+ */
+static int skipEmptyLines(InputReader* reader, unsigned char* first)
+{
+    const unsigned char* bytes;
+    int rc;
+    while ((rc = peekBytes(reader, 1, &bytes)) == SUCCESS_EXIT && *bytes == END_LINE)
+    {
+        reader->pos++;
+    }
+    if (rc == SUCCESS_EXIT)
+    {
+        *first = *bytes;
+    }
+    return rc;
+}
+
+// -------------------------- parsing functions -------------------------
+
+/**
+ * @brief checks whether the given character is skipped in front of a number.
+ * @param c the given character.
+ * @return TRUE if it is; FALSE otherwise.
+ */
+static int isBlank(char c)
+{
+    return c == SPACE || c == TAB || c == VERTICAL_TAB || c == FORM_FEED || c == CARRIAGE_RETURN;
+}
+
+/**
+ * @brief parse a whole number, optionally preceded by blanks, from the front of the given text.
+ * @param text the given text; advanced past the number.
+ * @param end the end of the text.
+ * @param number for the result: the parsed number; any number past MAX_PARSED_NUMBER is parsed
+ * as a number past it.
+ * @return TRUE if the text starts with a number; FALSE otherwise.
+ */
+static int parseNumber(const char** text, const char* end, unsigned int* number)
+{
+    const char* p = *text;
+    while (p < end && isBlank(*p))
+    {
+        p++;
+    }
+    if (p == end || *p < '0' || *p > '9')
+    {
+        return FALSE;
+    }
+
+    unsigned int result = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++)
+    {
+        if (result <= MAX_PARSED_NUMBER)
+        {
+            result = result * DECIMAL + (unsigned int)(*p - '0');
+        }
+    }
+    *text = p;
+    *number = result;
+    return TRUE;
+}
+
+/**
+ * @brief checks whether the given number is the size of a sudoku board.
+ * @param size the given number.
+ * @return TRUE if it is; FALSE otherwise.
+ */
+static int isValidSize(unsigned int size)
+{
+    return size > 0 && size <= MAX_BOARD_SIZE && pow(sqrt(size), SQUARED) == size;
+}
+
+/**
+ * @brief parse the size of the sudoku board from the given line.
+ * @param line the given line; NULL if the input ended.
+ * @param length the number of characters of the line.
+ * @param inputFileName the name of the input file.
+ * @param errorNum for the result: address for an int representing an error.
+ * @return the size of the board.
+ */
+static unsigned int parseSize(const char* line, size_t length, const char* inputFileName,
+                              int* errorNum)
+{
+    unsigned int size = 0;
+    const char* end = line != NULL ? line + length : NULL;
+    if (line == NULL || !parseNumber(&line, end, &size) || line != end || !isValidSize(size))
+    {
+        fprintf(ERROR_DEST, INVALID_FILE_ERROR, inputFileName);
+        *errorNum = INVALID_INPUT_EXIT;
+        return 0;
+    }
+
+    *errorNum = SUCCESS_EXIT;
+    return size;
+}
+
+/**
+ * @brief scan a line from the input, representing a row in the sudoku board.
+ * @param reader the given input.
+ * @param inputFileName the name of the given input file.
+ * @param board the given board.
+ * @param i the row index.
+ * @return an error code in case of an error; SUCCESS_EXIT otherwise.
+ */
+static int scanLine(InputReader* reader, const char* inputFileName, pBoard board, unsigned int i)
+{
+    assert(reader != NULL && inputFileName != NULL && board != NULL);
+    assert(i < getSize(board));
+
+    const char* line = NULL;
+    size_t length = 0;
+    int rc = nextLine(reader, &line, &length);
+    if (rc == MALLOC_EXIT)
+    {
+        return rc;
+    }
+    const char* end = rc == SUCCESS_EXIT ? line + length : line;
+    unsigned int size = getSize(board);
+
+    for (unsigned int j = 0; j < size && rc == SUCCESS_EXIT; j++)
+    {
+        unsigned int val;
+        if (!parseNumber(&line, end, &val) || val > size ||
+            (j < size - 1 && (line == end || *line != SPACE)) || (j == size - 1 && line != end))
+        {
+            rc = INVALID_INPUT_EXIT;
+            break;
+        }
+
+        setCell(board, i, j, val);
+        if (j < size - 1)
+        {
+            line++;
+        }
+    }
+
+    if (rc != SUCCESS_EXIT)
+    {
+        fprintf(ERROR_DEST, INVALID_FILE_ERROR, inputFileName);
+        return INVALID_INPUT_EXIT;
+    }
+    return SUCCESS_EXIT;
+}
+
+/**
+ * @brief scan the rows of a board of the given size, whose size line was already read.
+ * @param reader the given input.
+ * @param inputFileName the name of the given input file.
+ * @param size the board's size.
+ * @param errorNum for the result: address for an int representing an error.
+ * @return the new sudoku board; NULL in case of error.
+ */
+static pBoard scanRows(InputReader* reader, const char* inputFileName, unsigned int size,
+                       int* errorNum)
+{
+    pBoard board = newBoard(size);
+    if (board == NULL)
+    {
+        *errorNum = MALLOC_EXIT;
+        return NULL;
+    }
+
+    int rc;
+    for (unsigned int i = 0; i < size; i++)
+    {
+        rc = scanLine(reader, inputFileName, board, i);
+        if (rc != SUCCESS_EXIT)
+        {
+            *errorNum = rc;
+            freeBoard(board);
+            return NULL;
+        }
+    }
+    return board;
+}
+
+/**
+ * @brief return the number of bits a cell of a board of the given size takes in BINARY_FORMAT.
+ * @param size the board's size.
+ * @return the number of bits.
+ */
+static unsigned int cellBits(unsigned int size)
+{
+    unsigned int bits = 0;
+    while ((size >> bits) != 0)
+    {
+        bits++;
+    }
+    return bits;
+}
+
+/**
+ * @brief return the number of bytes of a BINARY_FORMAT frame of a board of the given size.
+ * @param size the board's size.
+ * @return the number of bytes.
+ */
+static size_t frameBytes(unsigned int size)
+{
+    return FRAME_HEADER_BYTES + ((size_t)size * size * cellBits(size) + BYTE_BITS - 1) / BYTE_BITS;
+}
+
+/**
+ * @brief scan a BINARY_FORMAT frame from the given input, unpacking its cells where they lie.
+ * @param reader the given input; its next byte must be the frame's magic byte.
+ * @param inputFileName the name of the given input file.
+ * @param errorNum for the result: address for an int representing an error.
+ * @return the new sudoku board; NULL in case of error.
+ */
+static pBoard scanFrame(InputReader* reader, const char* inputFileName, int* errorNum)
+{
+    const unsigned char* frame;
+    int rc = peekBytes(reader, FRAME_HEADER_BYTES, &frame);
+    unsigned int size = rc == SUCCESS_EXIT ? frame[1] : 0;
+    if (rc == SUCCESS_EXIT && isValidSize(size))
+    {
+        rc = peekBytes(reader, frameBytes(size), &frame);
+    }
+    pBoard board = NULL;
+    if (rc == SUCCESS_EXIT && isValidSize(size) && (board = newBoard(size)) == NULL)
+    {
+        rc = MALLOC_EXIT;
+    }
+
+    const unsigned char* packed = board != NULL ? frame + FRAME_HEADER_BYTES : NULL;
+    unsigned int bits = cellBits(size), mask = (1u << bits) - 1, buffered = 0, held = 0;
+    for (unsigned int k = 0; board != NULL && k < size * size; k++)
+    {
+        while (held < bits)
+        {
+            buffered |= (unsigned int)*packed++ << held;
+            held += BYTE_BITS;
+        }
+        unsigned int val = buffered & mask;
+        buffered >>= bits;
+        held -= bits;
+        if (val > size)
+        {
+            freeBoard(board);
+            board = NULL;
+            break;
+        }
+        setCell(board, k / size, k % size, val);
+    }
+
+    if (board == NULL)
+    {
+        *errorNum = rc == MALLOC_EXIT ? rc : INVALID_INPUT_EXIT;
+        if (rc != MALLOC_EXIT)
+        {
+            fprintf(ERROR_DEST, INVALID_FILE_ERROR, inputFileName);
+        }
+        return NULL;
+    }
+    reader->pos += frameBytes(size);
+    *errorNum = SUCCESS_EXIT;
+    return board;
+}
+
+/**
+ * @brief scan a board in GRID_FORMAT or BINARY_FORMAT from the given input, which must hold nothing
+ * but the board.
+ * @param reader the given input.
+ * @param inputFileName the name of the given input file.
+ * @param errorNum for the result: address for an int representing an error.
+ * @return the new sudoku board; NULL in case of error.
+ */
+static pBoard scanWholeBoard(InputReader* reader, const char* inputFileName, int* errorNum)
+{
+    const char* line = NULL;
+    size_t length = 0;
+    const unsigned char* first;
+    int rc = peekBytes(reader, 1, &first);
+    pBoard board;
+    if (rc == SUCCESS_EXIT && *first == FRAME_MAGIC)
+    {
+        board = scanFrame(reader, inputFileName, errorNum);
+    }
+    else
+    {
+        rc = rc == MALLOC_EXIT ? rc : nextLine(reader, &line, &length);
+        if (rc == MALLOC_EXIT)
+        {
+            *errorNum = rc;
+            return NULL;
+        }
+        unsigned int size = parseSize(rc == SUCCESS_EXIT ? line : NULL, length, inputFileName,
+                                      errorNum);
+        board = *errorNum == SUCCESS_EXIT ? scanRows(reader, inputFileName, size, errorNum) : NULL;
+    }
+    if (board == NULL)
+    {
+        return NULL;
+    }
+
+    //the board may be followed by a single end-line delimiter.
+    if ((rc = nextLine(reader, &line, &length)) != END_OF_INPUT &&
+        (rc != SUCCESS_EXIT || length != 0))
+    {
+        *errorNum = rc == MALLOC_EXIT ? rc : INVALID_INPUT_EXIT;
+        if (rc != MALLOC_EXIT)
+        {
+            fprintf(ERROR_DEST, INVALID_FILE_ERROR, inputFileName);
+        }
+        freeBoard(board);
+        return NULL;
+    }
+
+    return board;
+}
+
+pBoard scanBoard(FILE* inputFile, const char* inputFileName, int* errorNum)
+{
+    assert(inputFile != NULL && inputFileName != NULL && errorNum != NULL);
+
+    InputReader* reader = openReader(inputFile);
+    if (reader == NULL)
+    {
+        *errorNum = MALLOC_EXIT;
+        return NULL;
+    }
+    pBoard board = scanWholeBoard(reader, inputFileName, errorNum);
+    closeReader(reader);
+    return board;
+}
+
+/**
+ * @brief checks whether the given line is a LINE_FORMAT record.
+ * @param line the given line.
+ * @param length the number of characters of the line.
+ * @return TRUE if it is; FALSE otherwise.
+ */
+static int isLineRecord(const char* line, size_t length)
+{
+    if (length != LINE_SIZE * LINE_SIZE &&
+        (length != LINE_SIZE * LINE_SIZE + 1 || line[length - 1] != CARRIAGE_RETURN))
+    {
+        return FALSE;
+    }
+    for (unsigned int k = 0; k < LINE_SIZE * LINE_SIZE; k++)
+    {
+        if (line[k] != EMPTY_DOT && (line[k] < EMPTY_ZERO || line[k] > EMPTY_ZERO + LINE_SIZE))
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/**
+ * @brief parse a LINE_FORMAT record into a new board.
+ * @param line the given line; must be a LINE_FORMAT record.
+ * @return the new board; NULL if allocation failed.
+ */
+static pBoard parseLineRecord(const char* line)
+{
+    pBoard board = newBoard(LINE_SIZE);
+    if (board == NULL)
+    {
+        return NULL;
+    }
+    for (unsigned int k = 0; k < LINE_SIZE * LINE_SIZE; k++)
+    {
+        unsigned int val = line[k] == EMPTY_DOT ? 0 : (unsigned int)(line[k] - EMPTY_ZERO);
+        setCell(board, k / LINE_SIZE, k % LINE_SIZE, val);
+    }
+    return board;
+}
+
+int scanCommand(InputReader* reader, const char* command, int* matched)
+{
+    assert(reader != NULL && command != NULL && matched != NULL);
+
+    const char* line;
+    size_t length;
+    unsigned char first;
+    int rc = skipEmptyLines(reader, &first);
+    if (rc != SUCCESS_EXIT || first == FRAME_MAGIC)
+    {
+        //a frame is no command, and holds no end-line delimiter to end a line at.
+        *matched = FALSE;
+        return rc;
+    }
+    if ((rc = nextLine(reader, &line, &length)) != SUCCESS_EXIT)
+    {
+        return rc;
+    }
+
+    if (length > 0 && line[length - 1] == CARRIAGE_RETURN)
+    {
+        length--;
+    }
+    *matched = length == strlen(command) && memcmp(line, command, length) == 0;
+    if (!*matched)
+    {
+        //the line is still in the window, so it is put back for scanRecord().
+        reader->pos = (size_t)(line - reader->window);
+    }
+    return SUCCESS_EXIT;
+}
+
+int scanRecord(InputReader* reader, const char* inputFileName, unsigned long record,
+               pBoard* board, RecordFormat* format)
+{
+    assert(reader != NULL && inputFileName != NULL && board != NULL && format != NULL);
+
+    const char* line;
+    size_t length;
+    unsigned char first;
+    int errorNum;
+    char recordName[RECORD_NAME_SIZE];
+    int rc = skipEmptyLines(reader, &first);
+    if (rc != SUCCESS_EXIT)
+    {
+        return rc;
+    }
+    if (first == FRAME_MAGIC)
+    {
+        *format = BINARY_FORMAT;
+        snprintf(recordName, RECORD_NAME_SIZE, "%s:%lu", inputFileName, record);
+        *board = scanFrame(reader, recordName, &errorNum);
+        return *board == NULL ? errorNum : SUCCESS_EXIT;
+    }
+    if ((rc = nextLine(reader, &line, &length)) != SUCCESS_EXIT)
+    {
+        return rc;
+    }
+
+    if (isLineRecord(line, length))
+    {
+        *format = LINE_FORMAT;
+        *board = parseLineRecord(line);
+        return *board == NULL ? MALLOC_EXIT : SUCCESS_EXIT;
+    }
+
+    *format = GRID_FORMAT;
+    snprintf(recordName, RECORD_NAME_SIZE, "%s:%lu", inputFileName, record);
+    unsigned int size = parseSize(line, length, recordName, &errorNum);
+    if (errorNum != SUCCESS_EXIT)
+    {
+        return errorNum;
+    }
+    *board = scanRows(reader, recordName, size, &errorNum);
+    return *board == NULL ? errorNum : SUCCESS_EXIT;
+}
+
+size_t maxFormattedBytes(unsigned int size, RecordFormat format)
+{
+    if (format == LINE_FORMAT)
+    {
+        return size * size + 1;
+    }
+    if (format == BINARY_FORMAT)
+    {
+        return frameBytes(size);
+    }
+    return MAX_VALUE_CHARS + size * size * MAX_VALUE_CHARS;
+}
+
+/**
+ * @brief writes the given value, followed by the given delimiter, into the given buffer.
+ * @param val the given value.
+ * @param delimiter the given delimiter.
+ * @param buffer the given buffer.
+ * @return the number of bytes written.
+ */
+static size_t formatValue(unsigned int val, char delimiter, char* buffer)
+{
+    char digits[MAX_VALUE_CHARS];
+    size_t count = 0, written = 0;
+    do
+    {
+        digits[count++] = (char)('0' + val % 10);
+        val /= 10;
+    } while (val > 0);
+    while (count > 0)
+    {
+        buffer[written++] = digits[--count];
+    }
+    buffer[written++] = delimiter;
+    return written;
+}
+
+/**
+ * @brief writes the given board as a BINARY_FORMAT frame into the given buffer.
+ * @param board the given board.
+ * @param buffer the given buffer, with room for the frame.
+ * @return the number of bytes written.
+ */
+static size_t formatFrame(pBoard board, char* buffer)
+{
+    unsigned int size = getSize(board), bits = cellBits(size), buffered = 0, held = 0;
+    unsigned char* frame = (unsigned char*)buffer;
+    size_t written = 0;
+    frame[written++] = FRAME_MAGIC;
+    frame[written++] = (unsigned char)size;
+    for (unsigned int k = 0; k < size * size; k++)
+    {
+        buffered |= getCellValue(board, k / size, k % size) << held;
+        held += bits;
+        while (held >= BYTE_BITS)
+        {
+            frame[written++] = (unsigned char)(buffered & BYTE_MASK);
+            buffered >>= BYTE_BITS;
+            held -= BYTE_BITS;
+        }
+    }
+    if (held > 0)
+    {
+        frame[written++] = (unsigned char)buffered;
+    }
+    return written;
+}
+
+size_t formatBoard(pBoard board, RecordFormat format, char* buffer)
+{
+    assert(board != NULL && buffer != NULL);
+    unsigned int size = getSize(board);
+    size_t written = 0;
+
+    if (format == BINARY_FORMAT)
+    {
+        return formatFrame(board, buffer);
+    }
+    if (format == LINE_FORMAT)
+    {
+        assert(size == LINE_SIZE);
+        for (unsigned int k = 0; k < size * size; k++)
+        {
+            buffer[written++] = (char)(EMPTY_ZERO + getCellValue(board, k / size, k % size));
+        }
+        buffer[written++] = END_LINE;
+        return written;
+    }
+
+    written += formatValue(size, END_LINE, buffer);
+    for (unsigned int i = 0; i < size; i++)
+    {
+        for (unsigned int j = 0; j < size; j++)
+        {
+            written += formatValue(getCellValue(board, i, j), j < size - 1 ? SPACE : END_LINE,
+                                   buffer + written);
+        }
+    }
+    return written;
+}
+
+size_t formatFailure(RecordFormat format, char* buffer)
+{
+    assert(buffer != NULL);
+    if (format == BINARY_FORMAT)
+    {
+        buffer[0] = (char)FRAME_MAGIC;
+        buffer[1] = 0;
+        return FRAME_HEADER_BYTES;
+    }
+    memcpy(buffer, NO_SOLUTION_ERROR, sizeof(NO_SOLUTION_ERROR) - 1);
+    return sizeof(NO_SOLUTION_ERROR) - 1;
+}
+
+int writeBoard(pBoard board, RecordFormat format, FILE* outputFile)
+{
+    assert(board != NULL && outputFile != NULL);
+    char* buffer = (char*)malloc(maxFormattedBytes(getSize(board), format));
+    if (buffer == NULL)
+    {
+        return MALLOC_EXIT;
+    }
+    fwrite(buffer, 1, formatBoard(board, format, buffer), outputFile);
+    free(buffer);
+    return SUCCESS_EXIT;
+}
+
+void printBoard(pBoard board)
+{
+    assert(board != NULL);
+    //the board is formatted whole and written at once; cell by cell if that fails.
+    if (writeBoard(board, GRID_FORMAT, stdout) == SUCCESS_EXIT)
+    {
+        return;
+    }
+    unsigned int size = getSize(board);
+    printf(PRINT_SIZE_FORMAT, size);
+    for (unsigned int i = 0; i < size; i++)
+    {
+        for (unsigned int j = 0; j < size; j++)
+        {
+            printf(PRINT_FORMAT, getCellValue(board, i, j), j < size - 1 ? SPACE : END_LINE);
+        }
+    }
+}
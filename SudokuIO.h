@@ -0,0 +1,149 @@
+#ifndef EX3_SUDOKUIO_H
+#define EX3_SUDOKUIO_H
+
+#include "SudokuTree.h"
+#include <stdio.h>
+
+// -------------------------- macros -------------------------
+
+//-----exit codes
+//allocation error exit code.
+#define MALLOC_EXIT -2
+//invalid input error exit code
+#define INVALID_INPUT_EXIT -3
+//fclose error exit code.
+#define FCLOSE_EXIT -4
+//unexpected number of arguments exit code.
+#define ARGC_EXIT -5
+//fopen error exit code.
+#define FOPEN_EXIT -6
+//returned by scanRecord() when the input has no more puzzles.
+#define END_OF_INPUT 1
+
+//-----messages.
+//invalid input error message.
+#define INVALID_FILE_ERROR "%s:not a valid sudoku file\n"
+//no solution message.
+#define NO_SOLUTION_ERROR "no solution!\n"
+
+// -------------------------- structs & typedef -------------------------
+
+/**
+ * @brief The text formats a board can be read and written in.
+ */
+typedef enum RecordFormat
+{
+    //the size on the first line, followed by a line of space separated values per row. Each
+    //value is a run of decimal digits, which blanks may precede. Other spellings strtod() took
+    //are not values: signs ("+4", "-0"), fractions ("4.0"), hexadecimal ("0x1"), exponents
+    //("4e0"), and "inf" or "nan"; nor may anything follow the last value of a row.
+    GRID_FORMAT,
+    //a single line of 81 characters, one per cell of a 9x9 board, '0' or '.' for empty cells.
+    LINE_FORMAT,
+    //a frame: a magic byte no text record starts with, the size in a byte, and the cells row by
+    //row, packed from the lowest bit up at the fewest bits holding the size: 4 bits for a 9x9
+    //board, 5 for 16x16 and 25x25. A frame of size 0 stands for a board that was not solved.
+    BINARY_FORMAT
+} RecordFormat;
+
+/**
+ * @brief An input file read a record at a time, see openReader().
+ */
+typedef struct InputReader InputReader;
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief scan the values of a sudoku board, in GRID_FORMAT or BINARY_FORMAT, from the given input
+ * file. The file must hold nothing but the board.
+ * @param inputFile the given input file.
+ * @param inputFileName the name of the given input file.
+ * @param errorNum for the result: address for an int representing an error.
+ * @return the new sudoku board; NULL in case of error.
+ */
+pBoard scanBoard(FILE* inputFile, const char* inputFileName, int* errorNum);
+
+/**
+ * @brief opens a reader over the rest of the given input file. A regular file is mapped into
+ * memory a window at a time and parsed in place; other inputs are read from their descriptor in
+ * blocks of up to a fixed size, taking whatever a pipe or a socket holds without waiting for more.
+ * Either way the memory used does not grow with the size of the input. The file must not be
+ * read otherwise until the reader is closed, and other inputs must not have been read through
+ * the file's buffer before.
+ * @param inputFile the given input file; not closed by closeReader().
+ * @return the new reader; NULL if allocation failed.
+ */
+InputReader* openReader(FILE* inputFile);
+
+/**
+ * @brief closes the given reader.
+ * @param reader the given reader; may be NULL.
+ */
+void closeReader(InputReader* reader);
+
+/**
+ * @brief checks whether the next line of the given reader, after any empty lines, is the given
+ * command, and consumes it if it is; otherwise the line is left for scanRecord().
+ * @param reader the given reader.
+ * @param command the given command.
+ * @param matched for the result: TRUE if the line is the command; FALSE otherwise.
+ * @return SUCCESS_EXIT; END_OF_INPUT if the input has no more lines; an error code otherwise.
+ */
+int scanCommand(InputReader* reader, const char* command, int* matched);
+
+/**
+ * @brief scan the next puzzle of a batch from the given reader. Puzzles may be in any format and
+ * may be separated by empty lines. A BINARY_FORMAT puzzle is unpacked where it lies in the
+ * reader's window, without being copied.
+ * @param reader the given reader.
+ * @param inputFileName the name of the given input file.
+ * @param record the number of the puzzle in the batch, for error messages.
+ * @param board for the result: the new sudoku board.
+ * @param format for the result: the format the puzzle was written in.
+ * @return SUCCESS_EXIT; END_OF_INPUT if the input has no more puzzles; an error code otherwise.
+ */
+int scanRecord(InputReader* reader, const char* inputFileName, unsigned long record,
+               pBoard* board, RecordFormat* format);
+
+/**
+ * @brief return the number of bytes formatBoard() may write for a board of the given size.
+ * @param size the board's size.
+ * @param format the given format.
+ * @return the number of bytes.
+ */
+size_t maxFormattedBytes(unsigned int size, RecordFormat format);
+
+/**
+ * @brief writes the given board in the given format into the given buffer.
+ * @param board the given board; must be 9x9 for LINE_FORMAT.
+ * @param format the given format.
+ * @param buffer the given buffer, with room for maxFormattedBytes() bytes.
+ * @return the number of bytes written.
+ */
+size_t formatBoard(pBoard board, RecordFormat format, char* buffer);
+
+/**
+ * @brief writes the answer to a puzzle that could not be solved, in the given format, into the
+ * given buffer: NO_SOLUTION_ERROR, or an empty BINARY_FORMAT frame.
+ * @param format the given format.
+ * @param buffer the given buffer, with room for sizeof(NO_SOLUTION_ERROR) bytes.
+ * @return the number of bytes written.
+ */
+size_t formatFailure(RecordFormat format, char* buffer);
+
+/**
+ * @brief writes the given board in the given format to the given file.
+ * @param board the given board; must be 9x9 for LINE_FORMAT.
+ * @param format the given format.
+ * @param outputFile the given file.
+ * @return SUCCESS_EXIT, or MALLOC_EXIT if allocation failed.
+ */
+int writeBoard(pBoard board, RecordFormat format, FILE* outputFile);
+
+/**
+ * @brief prints the given sudoku board in GRID_FORMAT.
+ * @param board the given board.
+ */
+void printBoard(pBoard board);
+
+#endif //EX3_SUDOKUIO_H
@@ -0,0 +1,689 @@
+// -------------------------- includes -------------------------
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "SudokuServer.h"
+#include "SudokuIO.h"
+#include "LatencyHistogram.h"
+#include "ToolUtils.h"
+#include <pthread.h>
+#include <signal.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+// -------------------------- macros -------------------------
+
+//number of puzzles the pool's queue holds per worker thread.
+#define JOBS_PER_WORKER 16
+//number of puzzles of a connection that may wait for their solutions at a time.
+#define CONNECTION_WINDOW 64
+//number of connections waiting to be accepted.
+#define LISTEN_BACKLOG 64
+
+//-----parameters for the statistics.
+//printing format of the statistics, latencies in microseconds; an empty line ends them.
+#define SERVER_STATS_FORMAT "queue_depth\t%lu\nqueue_capacity\t%lu\nin_flight\t%lu\n" \
+                            "connections\t%lu\nrequests\t%lu\nlatency_p50_us\t%.1f\n" \
+                            "latency_p90_us\t%.1f\nlatency_p99_us\t%.1f\nlatency_max_us\t%.1f\n\n"
+//max number of bytes of the printed statistics.
+#define MAX_STATS_BYTES 512
+//percentiles reported for the latencies.
+#define MEDIAN 0.5
+#define HIGH 0.9
+#define TAIL 0.99
+//microseconds per second.
+#define MICROS 1e6
+
+//-----messages.
+//socket error message.
+#define SOCKET_ERROR "%s:cannot listen on socket\n"
+
+// -------------------------- structs -------------------------
+
+typedef struct Server Server;
+typedef struct Connection Connection;
+
+/**
+ * @brief A request of a connection: a puzzle, or a command answered by the connection itself.
+ */
+typedef struct Job
+{
+    //the next request of the connection, in the order they were read.
+    struct Job* next;
+    //the next puzzle in the pool's queue.
+    struct Job* nextQueued;
+    Connection* connection;
+    pBoard board;
+    RecordFormat format;
+    //the time the request was read.
+    struct timespec received;
+    //the answer, once done is set.
+    char* text;
+    size_t length;
+    int done;
+} Job;
+
+/**
+ * @brief A client connection. Its reader thread reads requests and queues them, and its writer
+ * thread writes their answers back in order as they are done.
+ */
+struct Connection
+{
+    Server* server;
+    int socket;
+    //the requests read and not written yet, oldest first, and their number.
+    Job* head;
+    Job* tail;
+    unsigned int inFlight;
+    //TRUE once the reader read its last request.
+    int readDone;
+    //TRUE once writing to the client failed; the remaining answers are dropped.
+    int writeFailed;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    //the next connection of the server.
+    Connection* next;
+};
+
+/**
+ * @brief The state shared by the connections and the workers of a server.
+ * The queue holds the puzzles read and not taken by a worker yet, oldest first.
+ */
+struct Server
+{
+    //the socket's path, naming the requests in error messages.
+    const char* socketPath;
+    SolverOptions options;
+    Job* queueHead;
+    Job* queueTail;
+    size_t queued;
+    size_t capacity;
+    //number of puzzles taken by workers and not solved yet.
+    size_t solving;
+    //TRUE once every connection is closed and the workers should stop.
+    int stopping;
+    Connection* connections;
+    unsigned long numConnections;
+    unsigned long requests;
+    LatencyHistogram latencies;
+    pthread_mutex_t lock;
+    pthread_cond_t workCond;
+    pthread_cond_t spaceCond;
+    pthread_cond_t closedCond;
+};
+
+// -------------------------- globals -------------------------
+
+//set by the signal handler to stop the server.
+static volatile sig_atomic_t stopRequested = 0;
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief asks the server to stop; the handler of SIGINT and SIGTERM.
+ * @param signum the signal.
+ */
+static void requestStop(int signum)
+{
+    (void)signum;
+    stopRequested = 1;
+}
+
+/**
+ * @brief sets the answer of the given job to a copy of the given text and marks it done.
+ * @param job the given job.
+ * @param text the given text.
+ * @param length the text's length.
+ * @return SUCCESS_EXIT, or MALLOC_EXIT if allocation failed.
+ */
+static int answerJob(Job* job, const char* text, size_t length)
+{
+    job->text = (char*)malloc(length);
+    if (job->text == NULL)
+    {
+        fprintf(ERROR_DEST, MALLOC_ERROR);
+        return MALLOC_EXIT;
+    }
+    memcpy(job->text, text, length);
+    job->length = length;
+    job->done = TRUE;
+    return SUCCESS_EXIT;
+}
+
+/**
+ * @brief marks the given job done, waking its connection's writer.
+ * @param job the given job; its answer is set.
+ */
+static void finishJob(Job* job)
+{
+    Connection* connection = job->connection;
+    pthread_mutex_lock(&connection->lock);
+    job->done = TRUE;
+    pthread_cond_broadcast(&connection->cond);
+    pthread_mutex_unlock(&connection->lock);
+}
+
+/**
+ * @brief solves the puzzle of the given job and sets its answer.
+ * @param server the given server.
+ * @param job the given job.
+ */
+static void solveJob(Server* server, Job* job)
+{
+    pBoard solution = solveBoard(job->board, &server->options, NULL);
+    size_t bytes = maxFormattedBytes(getSize(job->board), job->format);
+    bytes = bytes > sizeof(NO_SOLUTION_ERROR) ? bytes : sizeof(NO_SOLUTION_ERROR);
+    job->text = (char*)malloc(bytes);
+    if (job->text == NULL)
+    {
+        fprintf(ERROR_DEST, MALLOC_ERROR);
+    }
+    else if (solution == NULL)
+    {
+        job->length = formatFailure(job->format, job->text);
+    }
+    else
+    {
+        job->length = formatBoard(solution, job->format, job->text);
+    }
+    freeBoard(solution);
+    freeBoard(job->board);
+    job->board = NULL;
+}
+
+/**
+ * @brief solves queued puzzles until the server stops.
+ * @param arg the server.
+ * @return NULL.
+ */
+static void* runWorker(void* arg)
+{
+    Server* server = (Server*)arg;
+    pthread_mutex_lock(&server->lock);
+    while (TRUE)
+    {
+        while (server->queueHead == NULL && !server->stopping)
+        {
+            pthread_cond_wait(&server->workCond, &server->lock);
+        }
+        if (server->queueHead == NULL)
+        {
+            pthread_mutex_unlock(&server->lock);
+            return NULL;
+        }
+        Job* job = server->queueHead;
+        server->queueHead = job->nextQueued;
+        server->queueTail = server->queueHead != NULL ? server->queueTail : NULL;
+        server->queued--;
+        server->solving++;
+        pthread_cond_signal(&server->spaceCond);
+        pthread_mutex_unlock(&server->lock);
+
+        solveJob(server, job);
+        double latency = secondsSince(&job->received);
+
+        pthread_mutex_lock(&server->lock);
+        server->solving--;
+        server->requests++;
+        addLatency(&server->latencies, latency);
+        pthread_mutex_unlock(&server->lock);
+        //a job whose answer could not be allocated is answered with nothing.
+        finishJob(job);
+        pthread_mutex_lock(&server->lock);
+    }
+}
+
+/**
+ * @brief sets the answer of the given job to the statistics of the given server.
+ * @param server the given server.
+ * @param job the given job.
+ * @return SUCCESS_EXIT, or MALLOC_EXIT if allocation failed.
+ */
+static int answerStats(Server* server, Job* job)
+{
+    char text[MAX_STATS_BYTES];
+    pthread_mutex_lock(&server->lock);
+    const LatencyHistogram* latencies = &server->latencies;
+    int length = snprintf(text, MAX_STATS_BYTES, SERVER_STATS_FORMAT,
+                          (unsigned long)server->queued, (unsigned long)server->capacity,
+                          (unsigned long)server->solving, server->numConnections,
+                          server->requests, latencyPercentile(latencies, MEDIAN) * MICROS,
+                          latencyPercentile(latencies, HIGH) * MICROS,
+                          latencyPercentile(latencies, TAIL) * MICROS,
+                          latencies->maxLatency * MICROS);
+    pthread_mutex_unlock(&server->lock);
+    assert(length > 0 && length < MAX_STATS_BYTES);
+    return answerJob(job, text, (size_t)length);
+}
+
+/**
+ * @brief reads the next request of the given connection into a new job, answering it right away
+ * unless it is a puzzle.
+ * @param connection the given connection.
+ * @param reader the connection's reader.
+ * @param record the number of the request, for error messages.
+ * @param job for the result: the new job, or NULL if the connection has no more requests.
+ * @return SUCCESS_EXIT if a puzzle or a command was read; END_OF_INPUT if the connection has no
+ * more requests; otherwise an error code, in which case the job holds the answer to an invalid
+ * puzzle if it is not NULL.
+ */
+static int readJob(Connection* connection, InputReader* reader, unsigned long record, Job** job)
+{
+    *job = NULL;
+    int isStats;
+    int rc = scanCommand(reader, STATS_COMMAND, &isStats);
+    if (rc != SUCCESS_EXIT)
+    {
+        return rc;
+    }
+    Job* newJob = (Job*)calloc(1, sizeof(Job));
+    if (newJob == NULL)
+    {
+        fprintf(ERROR_DEST, MALLOC_ERROR);
+        return MALLOC_EXIT;
+    }
+    newJob->connection = connection;
+    clock_gettime(CLOCK_MONOTONIC, &newJob->received);
+    *job = newJob;
+    if (isStats)
+    {
+        return answerStats(connection->server, newJob);
+    }
+
+    rc = scanRecord(reader, connection->server->socketPath, record, &newJob->board,
+                    &newJob->format);
+    if (rc == END_OF_INPUT)
+    {
+        free(newJob);
+        *job = NULL;
+        return rc;
+    }
+    if (rc != SUCCESS_EXIT &&
+        answerJob(newJob, INVALID_REQUEST_ERROR, sizeof(INVALID_REQUEST_ERROR) - 1) != SUCCESS_EXIT)
+    {
+        free(newJob);
+        *job = NULL;
+    }
+    return rc;
+}
+
+/**
+ * @brief hands the given job to the given connection's writer, and to the pool's queue if it is a
+ * puzzle, waiting while the connection's window or the queue is full.
+ * @param connection the given connection.
+ * @param job the given job.
+ */
+static void submitJob(Connection* connection, Job* job)
+{
+    pthread_mutex_lock(&connection->lock);
+    while (connection->inFlight == CONNECTION_WINDOW)
+    {
+        pthread_cond_wait(&connection->cond, &connection->lock);
+    }
+    if (connection->tail != NULL)
+    {
+        connection->tail->next = job;
+    }
+    else
+    {
+        connection->head = job;
+    }
+    connection->tail = job;
+    connection->inFlight++;
+    pthread_cond_broadcast(&connection->cond);
+    pthread_mutex_unlock(&connection->lock);
+    if (job->done)
+    {
+        return;
+    }
+
+    Server* server = connection->server;
+    pthread_mutex_lock(&server->lock);
+    while (server->queued == server->capacity)
+    {
+        pthread_cond_wait(&server->spaceCond, &server->lock);
+    }
+    if (server->queueTail != NULL)
+    {
+        server->queueTail->nextQueued = job;
+    }
+    else
+    {
+        server->queueHead = job;
+    }
+    server->queueTail = job;
+    server->queued++;
+    pthread_cond_signal(&server->workCond);
+    pthread_mutex_unlock(&server->lock);
+}
+
+/**
+ * @brief writes the answers of the given connection, in order, as they are done, until its
+ * reader is done and every answer was written.
+ * @param arg the connection.
+ * @return NULL.
+ */
+static void* runWriter(void* arg)
+{
+    Connection* connection = (Connection*)arg;
+    pthread_mutex_lock(&connection->lock);
+    while (TRUE)
+    {
+        while (!(connection->head != NULL && connection->head->done) &&
+               !(connection->readDone && connection->head == NULL))
+        {
+            pthread_cond_wait(&connection->cond, &connection->lock);
+        }
+        Job* job = connection->head;
+        if (job == NULL)
+        {
+            pthread_mutex_unlock(&connection->lock);
+            return NULL;
+        }
+        pthread_mutex_unlock(&connection->lock);
+
+        if (!connection->writeFailed &&
+            !writeAll(connection->socket, job->text, job->length))
+        {
+            //the client stopped reading, so its remaining requests are not read either.
+            connection->writeFailed = TRUE;
+            shutdown(connection->socket, SHUT_RD);
+        }
+
+        pthread_mutex_lock(&connection->lock);
+        connection->head = job->next;
+        connection->tail = connection->head != NULL ? connection->tail : NULL;
+        connection->inFlight--;
+        pthread_cond_broadcast(&connection->cond);
+        free(job->text);
+        free(job);
+    }
+}
+
+/**
+ * @brief removes the given connection from its server and releases it.
+ * @param connection the given connection; its threads are done.
+ */
+static void closeConnection(Connection* connection)
+{
+    Server* server = connection->server;
+    pthread_mutex_lock(&server->lock);
+    Connection** link = &server->connections;
+    while (*link != connection)
+    {
+        link = &(*link)->next;
+    }
+    *link = connection->next;
+    server->numConnections--;
+    pthread_cond_broadcast(&server->closedCond);
+    pthread_mutex_unlock(&server->lock);
+
+    close(connection->socket);
+    pthread_mutex_destroy(&connection->lock);
+    pthread_cond_destroy(&connection->cond);
+    free(connection);
+}
+
+/**
+ * @brief reads the requests of the given connection and hands them on until the client closes
+ * its side or sends an invalid puzzle, then waits for the answers to be written and closes the
+ * connection.
+ * @param arg the connection.
+ * @return NULL.
+ */
+static void* runConnection(void* arg)
+{
+    Connection* connection = (Connection*)arg;
+    pthread_t writer;
+    int writing = pthread_create(&writer, NULL, runWriter, connection) == 0;
+    //the reader's stream is closed before the writer is done with the socket, so it reads a
+    //duplicate of the socket's descriptor.
+    int descriptor = writing ? dup(connection->socket) : -1;
+    FILE* stream = descriptor >= 0 ? fdopen(descriptor, "r") : NULL;
+    if (stream == NULL && descriptor >= 0)
+    {
+        close(descriptor);
+    }
+    InputReader* reader = stream != NULL ? openReader(stream) : NULL;
+    if (writing && reader == NULL)
+    {
+        fprintf(ERROR_DEST, MALLOC_ERROR);
+    }
+
+    int rc = reader != NULL ? SUCCESS_EXIT : MALLOC_EXIT;
+    for (unsigned long record = 1; rc == SUCCESS_EXIT; record++)
+    {
+        Job* job;
+        rc = readJob(connection, reader, record, &job);
+        if (job != NULL)
+        {
+            submitJob(connection, job);
+        }
+    }
+    closeReader(reader);
+    if (stream != NULL)
+    {
+        fclose(stream);
+    }
+
+    pthread_mutex_lock(&connection->lock);
+    connection->readDone = TRUE;
+    pthread_cond_broadcast(&connection->cond);
+    pthread_mutex_unlock(&connection->lock);
+    if (writing)
+    {
+        pthread_join(writer, NULL);
+    }
+    closeConnection(connection);
+    return NULL;
+}
+
+/**
+ * @brief starts serving the given accepted socket on a connection of its own.
+ * @param server the given server.
+ * @param socket the given socket; closed if the connection could not be started.
+ */
+static void openConnection(Server* server, int socket)
+{
+    Connection* connection = (Connection*)calloc(1, sizeof(Connection));
+    if (connection == NULL)
+    {
+        fprintf(ERROR_DEST, MALLOC_ERROR);
+        close(socket);
+        return;
+    }
+    connection->server = server;
+    connection->socket = socket;
+    pthread_mutex_init(&connection->lock, NULL);
+    pthread_cond_init(&connection->cond, NULL);
+
+    pthread_mutex_lock(&server->lock);
+    connection->next = server->connections;
+    server->connections = connection;
+    server->numConnections++;
+    pthread_mutex_unlock(&server->lock);
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, runConnection, connection) != 0)
+    {
+        closeConnection(connection);
+        return;
+    }
+    pthread_detach(thread);
+}
+
+/**
+ * @brief creates a socket listening at the given path, replacing a socket already there.
+ * @param socketPath the given path.
+ * @return the socket, or -1 if it could not be set up.
+ */
+static int listenAt(const char* socketPath)
+{
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(address.sun_path))
+    {
+        return -1;
+    }
+    strcpy(address.sun_path, socketPath);
+
+    struct stat info;
+    if (stat(socketPath, &info) == 0 && S_ISSOCK(info.st_mode))
+    {
+        unlink(socketPath);
+    }
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+    {
+        return -1;
+    }
+    if (bind(listener, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(listener, LISTEN_BACKLOG) != 0)
+    {
+        close(listener);
+        return -1;
+    }
+    return listener;
+}
+
+/**
+ * @brief accepts connections on the given socket until SIGINT or SIGTERM arrives. The signals
+ * must be blocked in every thread; they are only let through while waiting for a connection, so
+ * one arriving at any other time is taken before the next wait instead of being missed.
+ * @param server the given server.
+ * @param listener the given socket.
+ * @param waitMask the signal mask to wait with, in which the signals are not blocked.
+ */
+static void acceptConnections(Server* server, int listener, const sigset_t* waitMask)
+{
+    while (!stopRequested)
+    {
+        fd_set ready;
+        FD_ZERO(&ready);
+        FD_SET(listener, &ready);
+        int rc = pselect(listener + 1, &ready, NULL, NULL, NULL, waitMask);
+        if (rc < 0 && errno != EINTR)
+        {
+            break;
+        }
+        int socket = rc > 0 ? accept(listener, NULL, NULL) : -1;
+        if (socket >= 0)
+        {
+            openConnection(server, socket);
+        }
+    }
+}
+
+/**
+ * @brief stops reading every connection of the given server, and waits until their answers are
+ * written and they are closed.
+ * @param server the given server.
+ */
+static void drainConnections(Server* server)
+{
+    pthread_mutex_lock(&server->lock);
+    for (Connection* connection = server->connections; connection != NULL;
+         connection = connection->next)
+    {
+        shutdown(connection->socket, SHUT_RD);
+    }
+    while (server->numConnections > 0)
+    {
+        pthread_cond_wait(&server->closedCond, &server->lock);
+    }
+    pthread_mutex_unlock(&server->lock);
+}
+
+int runServer(const char* socketPath, const SolverOptions* options, unsigned int numThreads)
+{
+    assert(socketPath != NULL && options != NULL);
+
+    if (numThreads == 0)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        numThreads = online > 0 ? (unsigned int)online : 1;
+    }
+
+    Server server;
+    memset(&server, 0, sizeof(server));
+    server.socketPath = socketPath;
+    server.options = *options;
+    server.options.numThreads = 1;
+    server.capacity = (size_t)numThreads * JOBS_PER_WORKER;
+    pthread_t* threads = (pthread_t*)malloc(numThreads * sizeof(pthread_t));
+    if (threads == NULL)
+    {
+        fprintf(ERROR_DEST, MALLOC_ERROR);
+        return MALLOC_EXIT;
+    }
+    int listener = listenAt(socketPath);
+    if (listener < 0)
+    {
+        fprintf(ERROR_DEST, SOCKET_ERROR, socketPath);
+        free(threads);
+        return FOPEN_EXIT;
+    }
+    pthread_mutex_init(&server.lock, NULL);
+    pthread_cond_init(&server.workCond, NULL);
+    pthread_cond_init(&server.spaceCond, NULL);
+    pthread_cond_init(&server.closedCond, NULL);
+
+    //the stop signals are blocked before any thread starts, so every thread inherits the mask.
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = requestStop;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    sigset_t stopSignals, waitMask;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, &waitMask);
+    sigdelset(&waitMask, SIGINT);
+    sigdelset(&waitMask, SIGTERM);
+
+    unsigned int started = 0;
+    while (started < numThreads &&
+           pthread_create(&threads[started], NULL, runWorker, &server) == 0)
+    {
+        started++;
+    }
+    int rc = SUCCESS_EXIT;
+    if (started > 0)
+    {
+        acceptConnections(&server, listener, &waitMask);
+    }
+    else
+    {
+        rc = MALLOC_EXIT;
+    }
+    close(listener);
+    unlink(socketPath);
+    drainConnections(&server);
+
+    pthread_mutex_lock(&server.lock);
+    server.stopping = TRUE;
+    pthread_cond_broadcast(&server.workCond);
+    pthread_mutex_unlock(&server.lock);
+    for (unsigned int i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_sigmask(SIG_UNBLOCK, &stopSignals, NULL);
+    pthread_mutex_destroy(&server.lock);
+    pthread_cond_destroy(&server.workCond);
+    pthread_cond_destroy(&server.spaceCond);
+    pthread_cond_destroy(&server.closedCond);
+    free(threads);
+    return rc;
+}
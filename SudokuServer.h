@@ -0,0 +1,36 @@
+#ifndef EX3_SUDOKUSERVER_H
+#define EX3_SUDOKUSERVER_H
+
+#include "SudokuEngine.h"
+
+// -------------------------- macros -------------------------
+
+//request asking the server for its statistics instead of a solution.
+#define STATS_COMMAND "stats"
+//answer to an invalid puzzle.
+#define INVALID_REQUEST_ERROR "invalid request!\n"
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief Serves solutions over the Unix domain socket at the given path until the process gets
+ * SIGINT or SIGTERM. A client sends any number of puzzles on a connection, in the formats read
+ * by scanRecord(), without waiting for their solutions, and gets the solutions back in the same
+ * order and format, or the answer of formatFailure() if solving failed. The puzzles of all the
+ * connections are solved by a shared pool of worker threads. A connection is not read while it
+ * has a bounded number of puzzles waiting for their solutions, or while the pool's queue is full,
+ * so clients sending faster than the pool solves are held back by their socket.
+ * A line holding STATS_COMMAND in place of a puzzle is answered, in its turn, with tab separated
+ * lines of the server's queue depth, connections, served requests and the percentiles of their
+ * latencies, from being read to being solved, followed by an empty line. An invalid puzzle is
+ * answered with INVALID_REQUEST_ERROR and ends the connection.
+ * On the signal, the server stops accepting connections, answers every puzzle already read and
+ * removes the socket.
+ * @param socketPath the path of the socket; an existing socket at the path is replaced.
+ * @param options the settings each puzzle is solved with; a single thread solves each puzzle.
+ * @param numThreads the number of worker threads; 0 for one per online processor.
+ * @return SUCCESS_EXIT, or an error code if the socket could not be set up or allocation failed.
+ */
+int runServer(const char* socketPath, const SolverOptions* options, unsigned int numThreads);
+
+#endif //EX3_SUDOKUSERVER_H
@@ -1,245 +1,724 @@
 // -------------------------- includes -------------------------
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "SudokuTree.h"
-#include "GenericDFS.h"
+#include "SudokuIO.h"
+#include "SudokuEngine.h"
+#include "BatchSolver.h"
+#include "SudokuServer.h"
+#include "ToolUtils.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <math.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
 #include <assert.h>
 
 // -------------------------- macros -------------------------
 
+//-----parameters for reading the command line.
+//index of the first argument.
+#define FIRST_ARG_INDEX 1
+//flag selecting the minimum remaining values branching mode.
+#define MRV_FLAG "--mrv"
+//flag disabling constraint propagation.
+#define NO_PROPAGATION_FLAG "--no-propagation"
+//flags selecting the exact cover backend, and the depth first search one, whatever the board's
+//size.
+#define DLX_FLAG "--dlx"
+#define NO_DLX_FLAG "--no-dlx"
+//flag setting the number of search threads; followed by the number, 0 for all processors.
+#define THREADS_FLAG "--threads"
+//flag selecting batch mode.
+#define BATCH_FLAG "--batch"
+//flag selecting counting mode; followed by the number of solutions to stop at, 0 for no limit.
+#define COUNT_FLAG "--count"
+//flag selecting enumeration mode.
+#define ENUMERATE_FLAG "--enumerate"
+//flag printing the search statistics and the phase timings.
+#define STATS_FLAG "--stats"
+//flags limiting the search of a board; followed by the number of milliseconds, or of nodes.
+#define TIMEOUT_FLAG "--timeout-ms"
+#define MAX_NODES_FLAG "--max-nodes"
+//flag jumping back to the moves to blame for a dead end, and flag learning nogoods; the latter
+//followed by the number of nogoods to learn at most.
+#define BACKJUMP_FLAG "--backjump"
+#define NOGOODS_FLAG "--nogoods"
+//flags selecting the least constraining value ordering, and the random one; the latter followed
+//by the seed.
+#define LCV_FLAG "--lcv"
+#define RANDOM_FLAG "--random"
+//flags restarting the search on a schedule; followed by the number of nodes of the unit budget.
+#define LUBY_FLAG "--luby"
+#define GEOMETRIC_FLAG "--geometric"
+//flag caching solutions; followed by the name of the store file.
+#define CACHE_FLAG "--cache"
+//flag selecting server mode; followed by the path of the socket to listen on.
+#define SERVE_FLAG "--serve"
+//flag writing the solutions in BINARY_FORMAT.
+#define BINARY_FLAG "--binary"
+//number of bytes of cached solutions kept in memory.
+#define CACHE_CAPACITY (64UL << 20)
+//max number of search threads.
+#define MAX_THREADS 1024
+//prefix of command line flags.
+#define FLAG_PREFIX "--"
+//file name standing for the standard input.
+#define STDIN_NAME "-"
+
 //-----parameters for reading from file.
-//argument index for the input file.
-#define FILE_INDEX 1
 //format for opening the input file.
 #define FILE_FORMAT "r"
-//expected number of arguments.
-#define NUM_ARGS 2
-//size of buffer for reading lines from input file.
-#define BUFFER_SIZE 256
-
-//-----parameters for checking input
-//max size of board.
-#define MAX_BOARD_SIZE 100
-//board shape.
-#define SQUARED 2
-
-//-----parameters for printing board.
-//end-line delimiter
-#define END_LINE '\n'
-//mid-line delimiter
-#define SPACE ' '
-//printing format.
-#define PRINT_FORMAT "%u%c"
-//printing format for board size.
-#define PRINT_SIZE_FORMAT "%u\n"
-
-//-----exit codes
-//allocation error exit code.
-#define MALLOC_EXIT -2
-//invalid input error exit code
-#define INVALID_INPUT_EXIT -3
-//fclose error exit code.
-#define FCLOSE_EXIT -4
-//unexpected number of arguments exit code.
-#define ARGC_EXIT -5
-//fopen error exit code.
-#define FOPEN_EXIT -6
+
+//-----parameters for printing.
+//printing format for the number of solutions.
+#define PRINT_COUNT_FORMAT "%lu\n"
+//printing format for the phase timings, in milliseconds, and the search statistics.
+#define STATS_FORMAT "parse_ms\t%.3f\nsolve_ms\t%.3f\nprint_ms\t%.3f\nnodes\t%llu\n" \
+                     "backtracks\t%llu\nmax_depth\t%u\ngenerated\t%llu\nexplored\t%llu\n" \
+                     "copies\t%llu\nstack_bytes\t%llu\ntranspositions\t%llu\nbackjumps\t%llu\n" \
+                     "nogoods\t%llu\nrestarts\t%llu\n"
+//printing format for the cache counters.
+#define CACHE_STATS_FORMAT "cache_hits\t%lu\ncache_misses\t%lu\ncache_stored\t%lu\n"
+//milliseconds per second.
+#define MILLIS 1e3
 
 //-----messages.
-//invalid input error message.
-#define INVALID_FILE_ERROR "%s:not a valid sudoku file\n"
 //fopen error message,
 #define FOPEN_ERROR "%s:no such file\n"
-//unexpected number of arguments exit message
-#define ARGC_ERROR "please supply a file! usage: SudokuSolver<filename>\n"
-//no solution message.
-#define NO_SOLUTION_ERROR "no solution!\n"
+//usage message, printed after any error in the command line.
+#define ARGC_ERROR "usage: SudokuSolver [--mrv] [--no-propagation] [--dlx | --no-dlx] " \
+                   "[--threads <n>]\n" \
+                   "                    [--timeout-ms <ms>] [--max-nodes <n>] [--backjump] " \
+                   "[--nogoods <n>]\n" \
+                   "                    [--lcv | --random <seed>] " \
+                   "[--luby <n> | --geometric <n>] [--cache <file>]\n" \
+                   "                    [--stats] [--binary] " \
+                   "[--batch | --count <limit> | --enumerate] <filename> |\n" \
+                   "                    --serve <socket>\n"
+//printing format for the reason the command line is rejected; the usage message follows.
+#define COMMAND_LINE_ERROR "%s\n"
+//printing format for an unknown argument, or a flag missing its value.
+#define UNKNOWN_ARG_ERROR "%s:unexpected argument, or a missing or invalid value\n"
+//reasons the command line is rejected.
+#define MISSING_FILE_CONFLICT "please supply a file!"
+#define FILE_AND_SERVE_CONFLICT "--serve takes its puzzles from its clients, not from a file"
+#define SERVE_MODE_CONFLICT "--serve is not available with --batch, --count, --enumerate or " \
+                            "--binary"
+#define COUNT_MODE_CONFLICT "--count and --enumerate are not available with --batch, --dlx " \
+                            "or --cache"
+#define POOLED_STATS_CONFLICT "--stats is only available with --batch or --serve given --cache"
+#define NOGOODS_CONFLICT "--nogoods is only available with --backjump"
+#define BACKEND_CONFLICT "--dlx and --no-dlx may not be given together, or twice"
+#define ORDERING_CONFLICT "--lcv and --random may not be given together, or twice"
+#define SCHEDULE_CONFLICT "--luby and --geometric may not be given together, or twice"
+#define RESTART_ORDERING_CONFLICT "--luby and --geometric are only available with --random, " \
+                                  "as each run must try the values in another order"
+#define SINGLE_SEARCH_MODE_CONFLICT "--timeout-ms, --max-nodes, --backjump, --luby and " \
+                                    "--geometric are not available with --count, --enumerate " \
+                                    "or --dlx"
+#define SINGLE_SEARCH_THREADS_CONFLICT "--timeout-ms, --max-nodes, --backjump, --luby and " \
+                                       "--geometric need --threads 1, unless with --batch or " \
+                                       "--serve"
 //fclose error message.
 #define FCLOSE_ERROR "failed to close file\n"
+//message telling the budget ran out before the board was solved.
+#define BUDGET_WARNING "%s:search budget ran out; printed the best partial board found\n"
+//cache error message.
+#define CACHE_ERROR "%s:cannot open solution cache\n"
 
-// -------------------------- functions -------------------------
+// -------------------------- structs -------------------------
+
+/**
+ * @brief The command line the solver was run with.
+ */
+typedef struct CommandLine
+{
+    char* fileName;
+    char* cacheName;
+    char* socketName;
+    int batch;
+    int counting;
+    int enumerating;
+    int stats;
+    int binary;
+    unsigned long countLimit;
+    SolverOptions options;
+} CommandLine;
 
 /**
- * @brief scan the size of the sudoku board from the input file.
- * @param inputFile the given input file.
- * @param inputFileName the name of the given input file.
- * @param errorNum for the result: address for an int representing an error.
- * @return the size of the board.
+ * @brief The durations of the phases of a run, in milliseconds.
  */
-static unsigned int scanSize(FILE* inputFile, char* inputFileName, int *errorNum)
+typedef struct PhaseTimes
 {
-    assert(inputFile != NULL && inputFileName != NULL && errorNum != NULL);
+    double parse;
+    double solve;
+    double print;
+} PhaseTimes;
 
-    char buffer[BUFFER_SIZE], *pBuffer;
-    fgets(buffer, BUFFER_SIZE, inputFile);
-    pBuffer = buffer;
+// -------------------------- functions -------------------------
 
-    int scannedSize = (int)strtod(pBuffer, &pBuffer);
+/**
+ * @brief return the number of milliseconds from the given time to now, and sets the given time
+ * to now.
+ * @param start the given time; updated.
+ * @return the number of milliseconds.
+ */
+static double lap(struct timespec* start)
+{
+    double millis = secondsSince(start) * MILLIS;
+    clock_gettime(CLOCK_MONOTONIC, start);
+    return millis;
+}
 
-    if (*pBuffer != END_LINE || scannedSize <= 0 || scannedSize > MAX_BOARD_SIZE ||
-        pow(sqrt(scannedSize), SQUARED) != scannedSize)
+/**
+ * @brief prints the counters of the cache if the command line asks for them and has a cache.
+ * @param commandLine the parsed command line.
+ */
+static void printCacheStats(const CommandLine* commandLine)
+{
+    if (commandLine->stats && commandLine->options.cache != NULL)
     {
-        fprintf(ERROR_DEST, INVALID_FILE_ERROR, inputFileName);
-        *errorNum = INVALID_INPUT_EXIT;
-        return 0;
+        CacheStats stats;
+        getCacheStats(commandLine->options.cache, &stats);
+        fprintf(ERROR_DEST, CACHE_STATS_FORMAT, stats.hits, stats.misses, stats.stored);
     }
+}
 
-    *errorNum = SUCCESS_EXIT;
-    return (unsigned)scannedSize;
+/**
+ * @brief prints the given phase timings and search statistics if the command line asks for them.
+ * @param commandLine the parsed command line.
+ * @param times the given phase timings.
+ * @param stats the given search statistics.
+ */
+static void printStats(const CommandLine* commandLine, const PhaseTimes* times,
+                       const DfsStats* stats)
+{
+    if (commandLine->stats)
+    {
+        fprintf(ERROR_DEST, STATS_FORMAT, times->parse, times->solve, times->print, stats->nodes,
+                stats->backtracks, stats->maxDepth, stats->generated, stats->explored,
+                stats->copies, stats->stackBytes, stats->transpositions, stats->backjumps,
+                stats->nogoods, stats->restarts);
+    }
+    printCacheStats(commandLine);
 }
 
 /**
- * @brief scan a line from the input, representing a row in the sudoku board.
- * @param inputFile the given input file.
- * @param inputFileName the name of the given input file.
- * @param board the given board.
- * @param i the row index.
- * @return an error code in case of an error; SUCCESS_EXIT otherwise.
+ * @brief return the reason the given parsed command line is rejected, if it combines flags that
+ * cannot be used together.
+ * Counting searches every branch, which the batch pipeline and the exact cover backend do not;
+ * the batch pipeline runs its phases concurrently, so they cannot be timed apart, and only the
+ * cache counters are printed. A budget only limits a single threaded depth first search for one
+ * solution, which is also the only search that jumps back, and learns nogoods while it does so,
+ * and the only one that restarts, which only pays off when each run tries another order. A
+ * single backend, value ordering and restart schedule may be given. A server solves like the
+ * batch pipeline, and takes its puzzles from its clients, which get their solutions in the
+ * format they sent.
+ * @param commandLine the parsed command line.
+ * @param backendFlags the number of backend flags given.
+ * @param orderingFlags the number of value ordering flags given.
+ * @param scheduleFlags the number of restart schedule flags given.
+ * @return the reason, or NULL if the command line is valid.
  */
-static int scanLine(FILE* inputFile, char* inputFileName, pBoard board, unsigned int i)
+static const char* findConflict(const CommandLine* commandLine, int backendFlags,
+                                int orderingFlags, int scheduleFlags)
 {
-    assert(inputFile != NULL && inputFileName != NULL && board != NULL);
-    assert(i < getSize(board));
+    const SolverOptions* options = &commandLine->options;
+    int countingMode = commandLine->counting || commandLine->enumerating;
+    int budgeted = options->budget.timeoutMs > 0 || options->budget.maxNodes > 0;
+    int restarting = options->restartNodes > 0;
+    int singleSearch = budgeted || options->backjumping || restarting;
+    int serving = commandLine->socketName != NULL;
+    int pooled = commandLine->batch || serving;
+    if (commandLine->fileName == NULL && !serving)
+    {
+        return MISSING_FILE_CONFLICT;
+    }
+    if (commandLine->fileName != NULL && serving)
+    {
+        return FILE_AND_SERVE_CONFLICT;
+    }
+    if (serving && (commandLine->batch || countingMode || commandLine->binary))
+    {
+        return SERVE_MODE_CONFLICT;
+    }
+    if (countingMode && (commandLine->batch || options->backend == DLX_BACKEND ||
+                         commandLine->cacheName != NULL))
+    {
+        return COUNT_MODE_CONFLICT;
+    }
+    if (commandLine->stats && pooled && commandLine->cacheName == NULL)
+    {
+        return POOLED_STATS_CONFLICT;
+    }
+    if (options->nogoods > 0 && !options->backjumping)
+    {
+        return NOGOODS_CONFLICT;
+    }
+    if (backendFlags > 1)
+    {
+        return BACKEND_CONFLICT;
+    }
+    if (orderingFlags > 1)
+    {
+        return ORDERING_CONFLICT;
+    }
+    if (scheduleFlags > 1)
+    {
+        return SCHEDULE_CONFLICT;
+    }
+    if (restarting && options->ordering != RANDOM_ORDERING)
+    {
+        return RESTART_ORDERING_CONFLICT;
+    }
+    if (singleSearch && (countingMode || options->backend == DLX_BACKEND))
+    {
+        return SINGLE_SEARCH_MODE_CONFLICT;
+    }
+    if (singleSearch && options->numThreads != 1 && !pooled)
+    {
+        return SINGLE_SEARCH_THREADS_CONFLICT;
+    }
+    return NULL;
+}
 
-    char buffer[BUFFER_SIZE], *pBuffer;
-    fgets(buffer, BUFFER_SIZE, inputFile);
-    pBuffer = buffer;
-    unsigned int size = getSize(board);
+/**
+ * @brief parse the command line into the given struct.
+ * @param argc number of arguments.
+ * @param argv arguments.
+ * @param commandLine for the result: the parsed command line.
+ * @return SUCCESS_EXIT if the command line is valid; ARGC_EXIT otherwise, after printing why.
+ */
+static int parseArguments(int argc, char* argv[], CommandLine* commandLine)
+{
+    assert(argv != NULL && commandLine != NULL);
 
-    for (unsigned int j = 0; j < size; j++)
+    unsigned long long number;
+    //the number of backend flags, of value ordering flags, and of restart schedule flags, given.
+    int backendFlags = 0;
+    int orderingFlags = 0;
+    int scheduleFlags = 0;
+    SolverOptions* options = &commandLine->options;
+    commandLine->fileName = NULL;
+    commandLine->cacheName = NULL;
+    commandLine->socketName = NULL;
+    commandLine->batch = FALSE;
+    commandLine->counting = FALSE;
+    commandLine->enumerating = FALSE;
+    commandLine->stats = FALSE;
+    commandLine->binary = FALSE;
+    commandLine->countLimit = 0;
+    defaultSolverOptions(options);
+    for (int i = FIRST_ARG_INDEX; i < argc; i++)
     {
-        int val = (int)strtod(pBuffer, &pBuffer);
-        if (val < 0 || (unsigned)val > size || (j < size - 1 && *pBuffer != SPACE) ||
-            (j == size - 1 && i < size - 1 && *pBuffer != END_LINE))
+        if (strcmp(argv[i], MRV_FLAG) == 0)
         {
-            fprintf(ERROR_DEST, INVALID_FILE_ERROR, inputFileName);
-            return INVALID_INPUT_EXIT;
+            options->branching = MIN_REMAINING_BRANCHING;
         }
-
-        setCell(board, i, j, (unsigned int)val);
-        if (j < size - 1)
+        else if (strcmp(argv[i], NO_PROPAGATION_FLAG) == 0)
+        {
+            options->propagation = FALSE;
+        }
+        else if (strcmp(argv[i], DLX_FLAG) == 0 || strcmp(argv[i], NO_DLX_FLAG) == 0)
+        {
+            options->backend = strcmp(argv[i], DLX_FLAG) == 0 ? DLX_BACKEND : DFS_BACKEND;
+            backendFlags++;
+        }
+        else if (strcmp(argv[i], BATCH_FLAG) == 0)
+        {
+            commandLine->batch = TRUE;
+        }
+        else if (strcmp(argv[i], ENUMERATE_FLAG) == 0)
+        {
+            commandLine->enumerating = TRUE;
+        }
+        else if (strcmp(argv[i], STATS_FLAG) == 0)
+        {
+            commandLine->stats = TRUE;
+        }
+        else if (strcmp(argv[i], BINARY_FLAG) == 0)
+        {
+            commandLine->binary = TRUE;
+        }
+        else if (strcmp(argv[i], BACKJUMP_FLAG) == 0)
+        {
+            options->backjumping = TRUE;
+        }
+        else if (strcmp(argv[i], LCV_FLAG) == 0)
+        {
+            options->ordering = LEAST_CONSTRAINING_ORDERING;
+            orderingFlags++;
+        }
+        else if (strcmp(argv[i], COUNT_FLAG) == 0 &&
+                 parseNumber(argv[i + 1], ULONG_MAX, &number))
         {
-            pBuffer++;
+            commandLine->counting = TRUE;
+            commandLine->countLimit = (unsigned long)number;
+            i++;
+        }
+        else if (strcmp(argv[i], THREADS_FLAG) == 0 &&
+                 parseNumber(argv[i + 1], MAX_THREADS, &number))
+        {
+            options->numThreads = (unsigned int)number;
+            i++;
+        }
+        else if (strcmp(argv[i], TIMEOUT_FLAG) == 0 &&
+                 parseNumber(argv[i + 1], ULONG_MAX, &number))
+        {
+            options->budget.timeoutMs = (unsigned long)number;
+            i++;
+        }
+        else if (strcmp(argv[i], MAX_NODES_FLAG) == 0 &&
+                 parseNumber(argv[i + 1], ULONG_MAX, &number))
+        {
+            options->budget.maxNodes = number;
+            i++;
+        }
+        else if (strcmp(argv[i], NOGOODS_FLAG) == 0 &&
+                 parseNumber(argv[i + 1], ULONG_MAX, &number))
+        {
+            options->nogoods = (size_t)number;
+            i++;
+        }
+        else if (strcmp(argv[i], RANDOM_FLAG) == 0 &&
+                 parseNumber(argv[i + 1], ULONG_MAX, &number))
+        {
+            options->ordering = RANDOM_ORDERING;
+            options->seed = number;
+            orderingFlags++;
+            i++;
+        }
+        else if ((strcmp(argv[i], LUBY_FLAG) == 0 || strcmp(argv[i], GEOMETRIC_FLAG) == 0) &&
+                 parseNumber(argv[i + 1], ULONG_MAX, &number))
+        {
+            options->restarts = strcmp(argv[i], LUBY_FLAG) == 0 ? LUBY_RESTARTS :
+                                GEOMETRIC_RESTARTS;
+            options->restartNodes = number;
+            scheduleFlags++;
+            i++;
+        }
+        else if (strcmp(argv[i], CACHE_FLAG) == 0 && argv[i + 1] != NULL)
+        {
+            commandLine->cacheName = argv[++i];
+        }
+        else if (strcmp(argv[i], SERVE_FLAG) == 0 && argv[i + 1] != NULL)
+        {
+            commandLine->socketName = argv[++i];
+        }
+        else if (strncmp(argv[i], FLAG_PREFIX, strlen(FLAG_PREFIX)) != 0 &&
+                 commandLine->fileName == NULL)
+        {
+            commandLine->fileName = argv[i];
+        }
+        else
+        {
+            fprintf(ERROR_DEST, UNKNOWN_ARG_ERROR, argv[i]);
+            fprintf(ERROR_DEST, ARGC_ERROR);
+            return ARGC_EXIT;
         }
     }
+
+    const char* conflict = findConflict(commandLine, backendFlags, orderingFlags, scheduleFlags);
+    if (conflict != NULL)
+    {
+        fprintf(ERROR_DEST, COMMAND_LINE_ERROR, conflict);
+        fprintf(ERROR_DEST, ARGC_ERROR);
+        return ARGC_EXIT;
+    }
     return SUCCESS_EXIT;
 }
 
 /**
- * @brief scan the values of a sudoku board from the given input file.
- * @param inputFile the given input file.
- * @param inputFileName the name of the given input file.
- * @param errorNum for the result: address for an int representing an error.
- * @return the new sudoku board; NULL in case of error.
+ * @brief return the format the command line prints boards in.
+ * @param commandLine the parsed command line.
+ * @return BINARY_FORMAT, or GRID_FORMAT.
  */
-static pBoard scanBoard(FILE* inputFile, char* inputFileName, int* errorNum)
+static RecordFormat outputFormat(const CommandLine* commandLine)
 {
-    assert(inputFile != NULL && inputFileName != NULL && errorNum != NULL);
+    return commandLine->binary ? BINARY_FORMAT : GRID_FORMAT;
+}
 
-    unsigned int size = scanSize(inputFile, inputFileName, errorNum);
-    if (*errorNum != SUCCESS_EXIT)
+/**
+ * @brief prints the given board in the format of the command line.
+ * @param board the given board.
+ * @param commandLine the parsed command line.
+ */
+static void printResult(pBoard board, const CommandLine* commandLine)
+{
+    if (!commandLine->binary || writeBoard(board, BINARY_FORMAT, stdout) != SUCCESS_EXIT)
     {
-        return NULL;
+        printBoard(board);
     }
+}
 
-    pBoard board = newBoard(size);
+/**
+ * @brief solves the single board held by the given input file and prints the result.
+ * @param inputFile the given input file; closed by this function.
+ * @param commandLine the parsed command line.
+ * @param start the time the run started; used for the phase timings.
+ * @return SUCCESS_EXIT if the board was solved; an error code otherwise.
+ */
+static int solveFile(FILE* inputFile, const CommandLine* commandLine, struct timespec* start)
+{
+    int errNum;
+    PhaseTimes times;
+    DfsStats stats;
+    memset(&stats, 0, sizeof(DfsStats));
+    pBoard board = scanBoard(inputFile, commandLine->fileName, &errNum);
+
+    if (fclose(inputFile))
+    {
+        freeBoard(board);
+        fprintf(ERROR_DEST, FCLOSE_ERROR);
+        return FCLOSE_EXIT;
+    }
     if (board == NULL)
     {
-        *errorNum = MALLOC_EXIT;
-        return NULL;
+        return errNum;
     }
 
-    int rc;
-    for (unsigned int i = 0; i < size; i++)
+    times.parse = lap(start);
+
+    int finished;
+    DfsStats* previous = setDfsStats(commandLine->stats ? &stats : NULL);
+    pBoard bestBoard = solveBoard(board, &commandLine->options, &finished);
+    setDfsStats(previous);
+    times.solve = lap(start);
+
+    char failure[sizeof(NO_SOLUTION_ERROR)];
+    if (bestBoard == NULL)
     {
-        rc = scanLine(inputFile, inputFileName, board, i);
-        if (rc != SUCCESS_EXIT)
-        {
-            *errorNum = rc;
-            freeBoard(board);
-            return NULL;
-        }
+        fwrite(failure, 1, formatFailure(outputFormat(commandLine), failure), stdout);
+    }
+    else
+    {
+        printResult(bestBoard, commandLine);
+        freeBoard(bestBoard);
+    }
+    fflush(stdout);
+    times.print = lap(start);
+    if (bestBoard != NULL && !finished)
+    {
+        fprintf(ERROR_DEST, BUDGET_WARNING, commandLine->fileName);
     }
+    printStats(commandLine, &times, &stats);
 
-    int endFile;
-    if ((endFile = fgetc(inputFile)) != END_LINE && endFile != EOF)
+    freeBoard(board);
+    return SUCCESS_EXIT;
+}
+
+/**
+ * @brief prints the given solution; a visitNodeFunc for countSolutions().
+ * @param node the given solution.
+ * @param data the parsed command line.
+ * @return FALSE, so the count goes on.
+ */
+static int printSolution(pNode node, void* data)
+{
+    printResult((pBoard)node, (const CommandLine*)data);
+    return FALSE;
+}
+
+/**
+ * @brief counts the solutions of the single board held by the given input file, printing each of
+ * them when enumerating and their number when counting.
+ * @param inputFile the given input file; closed by this function.
+ * @param commandLine the parsed command line.
+ * @param start the time the run started; used for the phase timings.
+ * @return SUCCESS_EXIT if the solutions were counted; an error code otherwise.
+ */
+static int countFile(FILE* inputFile, const CommandLine* commandLine, struct timespec* start)
+{
+    int errNum;
+    PhaseTimes times;
+    DfsStats stats;
+    memset(&stats, 0, sizeof(DfsStats));
+    pBoard board = scanBoard(inputFile, commandLine->fileName, &errNum);
+
+    if (fclose(inputFile))
     {
-        fprintf(ERROR_DEST, INVALID_FILE_ERROR, inputFileName);
-        *errorNum = INVALID_INPUT_EXIT;
         freeBoard(board);
-        return NULL;
+        fprintf(ERROR_DEST, FCLOSE_ERROR);
+        return FCLOSE_EXIT;
     }
+    if (board == NULL)
+    {
+        return errNum;
+    }
+
+    times.parse = lap(start);
 
-    return board;
+    unsigned long count;
+    DfsStats* previous = setDfsStats(commandLine->stats ? &stats : NULL);
+    int rc = countSolutions(board, &commandLine->options, commandLine->countLimit,
+                            commandLine->enumerating ? printSolution : NULL, (void*)commandLine,
+                            &count);
+    setDfsStats(previous);
+    times.solve = lap(start);
+    freeBoard(board);
+    if (rc != SUCCESS_EXIT)
+    {
+        return MALLOC_EXIT;
+    }
+    if (commandLine->counting)
+    {
+        printf(PRINT_COUNT_FORMAT, count);
+    }
+    fflush(stdout);
+    times.print = lap(start);
+    printStats(commandLine, &times, &stats);
+    return SUCCESS_EXIT;
 }
 
 /**
- * @brief prints the given sudoku board.
- * @param board the given board.
+ * @brief solves every puzzle of the given input file and prints the results in input order.
+ * @param inputFile the given input file; closed by this function unless it is the standard input.
+ * @param commandLine the parsed command line; its thread count sizes the worker pool.
+ * @return SUCCESS_EXIT if every puzzle was solved; an error code otherwise.
  */
-static void printBoard(pBoard board) const
+static int solveStream(FILE* inputFile, const CommandLine* commandLine)
 {
-    assert(board != NULL);
-    unsigned int size = getSize(board);
-    printf(PRINT_SIZE_FORMAT, size);
-    for (unsigned int i = 0; i < size; i++)
+    int rc = solveBatch(inputFile, commandLine->fileName, stdout, &commandLine->options,
+                        commandLine->options.numThreads, commandLine->binary);
+    printCacheStats(commandLine);
+    if (inputFile != stdin && fclose(inputFile))
     {
-        for (unsigned int j = 0; j < size; j++)
-        {
-            printf(PRINT_FORMAT, getCellValue(board, i, j), j < size - 1 ? SPACE : END_LINE);
-        }
+        fprintf(ERROR_DEST, FCLOSE_ERROR);
+        return FCLOSE_EXIT;
     }
+    return rc;
 }
 
 /**
- * solves a sudoku puzzle.
+ * @brief serves solutions on the socket named by the command line until the process is stopped.
+ * @param commandLine the parsed command line; its thread count sizes the worker pool.
+ * @return SUCCESS_EXIT if the server ran; an error code otherwise.
+ */
+static int serve(const CommandLine* commandLine)
+{
+    int rc = runServer(commandLine->socketName, &commandLine->options,
+                       commandLine->options.numThreads);
+    printCacheStats(commandLine);
+    return rc;
+}
+
+/**
+ * solves a sudoku puzzle, or a batch of them, or counts the solutions of a puzzle, or serves
+ * solutions to clients.
+ * usage: SudokuSolver [--mrv] [--no-propagation] [--dlx | --no-dlx] [--threads <n>]
+ *                     [--timeout-ms <ms>] [--max-nodes <n>] [--backjump] [--nogoods <n>]
+ *                     [--lcv | --random <seed>] [--luby <n> | --geometric <n>] [--cache <file>]
+ *                     [--stats] [--binary] [--batch | --count <limit> | --enumerate] <filename> |
+ *                     --serve <socket>
+ * Boards of EXACT_COVER_MIN_SIZE and up are solved as exact cover problems, see --dlx, and
+ * smaller ones are searched, unless a flag sets the backend or only the search has a setting
+ * given: --mrv, --no-propagation, more than one thread searching a board, a budget, --backjump,
+ * --lcv, --random or a restart schedule; see AUTO_BACKEND. A board without a solution is
+ * answered with NO_SOLUTION_ERROR, whatever the backend, settings and mode, rather than with a
+ * partial board, whose filled cells would depend on how the backend prunes; see solveBoard().
+ * --mrv branches on the empty cell with the fewest legal values instead of the first empty cell.
+ * --no-propagation disables filling forced cells before branching.
+ * --dlx solves the board as an exact cover problem with Dancing Links instead of searching it,
+ * whatever its size; --no-dlx always searches it. The exact cover search visits no boards, so
+ * its node count is 0.
+ * --threads <n> searches the board with n threads, or with one per processor if n is 0. In batch
+ * and server modes, solves n puzzles at a time instead, each with a single thread.
+ * --timeout-ms <ms> and --max-nodes <n> stop the search of a board after ms milliseconds, or
+ * after visiting n nodes, and print the best partial board found instead of a solution, with a
+ * warning on the standard error; 0 for no limit. In batch mode, each puzzle has the budget, and
+ * no warning is printed; likewise for the puzzles of a server. Only available for a single
+ * threaded depth first search of a board.
+ * --backjump jumps back from a dead end straight to the last move to blame for it, skipping the
+ * moves in between, instead of backtracking one move at a time; see setDfsBackjumping(). With
+ * --nogoods <n>, it also learns up to n short sets of moves that lead to no solution, and never
+ * completes them again. Available where a budget is.
+ * --lcv tries the values of a cell starting with the ones ruling out the fewest candidates of the
+ * empty cells sharing a line with it, instead of in ascending order. --random <seed> tries them
+ * in a pseudo random order drawn from the board and the seed instead, so a seed always gives the
+ * same search; see setValueOrdering().
+ * --luby <n> and --geometric <n> restart the search from the puzzle, trying the values in another
+ * random order, whenever a run visited its number of nodes without finding the solution; the
+ * numbers follow the Luby sequence times n, or start at n and grow by half each run, see
+ * setDfsRestarts(). A budget covers all the runs. Only available with --random, and where a
+ * budget is.
+ * --cache <file> looks up the solution of each puzzle in a cache before solving it, and caches
+ * the solutions it finds. Puzzles are cached by a canonical form, so a puzzle hits the solution
+ * of any puzzle it can be turned into by relabeling digits, transposing, or reordering bands,
+ * stacks, and the rows and columns within them. The cache is kept in memory and appended to the
+ * given file, created if it does not exist, so later runs find the solutions too. Not available
+ * when counting.
+ * --stats prints the time spent parsing, solving and printing, and the counts of the search, see
+ * DfsStats, to the standard error, followed by the cache's hits, misses and stores with a cache.
+ * When enumerating, printing the solutions is part of solving. In batch and server modes, only
+ * available with a cache, and only prints its counters, when the run ends.
+ * --binary prints the solutions as binary frames, see BINARY_FORMAT, instead of in text. The
+ * board, or the puzzles of a batch, may be read from binary frames whether or not it is given.
+ * Not available in server mode, where solutions are sent in the format of their puzzles.
+ * --batch reads any number of puzzles, in the grid format, as 81 character lines or as binary
+ * frames, and prints their solutions in the same order and format, or as binary frames with
+ * --binary. A file name of - reads the standard input.
+ * --count <limit> prints the number of solutions of the board instead of one of them, stopping at
+ * limit solutions, or at none if limit is 0; a limit of 2 checks the solution is unique.
+ * --enumerate prints every solution of the board, up to the limit given by --count, which then
+ * also prints their number. With several threads, solutions are printed in no particular order.
+ * --serve <socket> listens on a Unix domain socket at the given path instead of reading a file,
+ * and solves the puzzles clients send on it until SIGINT or SIGTERM, see runServer(). A client
+ * may send any number of puzzles, in the batch formats, and gets their solutions back in the
+ * same order; a line holding "stats" gets the server's queue depth and latency percentiles.
  * @param argc number of arguments.
  * @param argv arguments.
  * @return SUCCESS_EXIT if the program ended successfully; an error code otherwise.
  */
 int main(int argc, char* argv[])
 {
-    if (argc != NUM_ARGS)
+    CommandLine commandLine;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int rc = parseArguments(argc, argv, &commandLine);
+    if (rc != SUCCESS_EXIT)
     {
-        fprintf(ERROR_DEST, ARGC_ERROR);
-        return ARGC_EXIT;
+        return rc;
     }
 
-    FILE* inputFile = fopen(argv[FILE_INDEX], FILE_FORMAT);
+    if (commandLine.cacheName != NULL)
+    {
+        commandLine.options.cache = openCache(commandLine.cacheName, CACHE_CAPACITY);
+        if (commandLine.options.cache == NULL)
+        {
+            fprintf(ERROR_DEST, CACHE_ERROR, commandLine.cacheName);
+            return FOPEN_EXIT;
+        }
+    }
+    if (commandLine.socketName != NULL)
+    {
+        rc = serve(&commandLine);
+        closeCache(commandLine.options.cache);
+        return rc;
+    }
+
+    FILE* inputFile = commandLine.batch && strcmp(commandLine.fileName, STDIN_NAME) == 0 ?
+                      stdin : fopen(commandLine.fileName, FILE_FORMAT);
     if (inputFile == NULL)
     {
-        fprintf(ERROR_DEST, FOPEN_ERROR, argv[FILE_INDEX]);
+        fprintf(ERROR_DEST, FOPEN_ERROR, commandLine.fileName);
+        closeCache(commandLine.options.cache);
         return FOPEN_EXIT;
     }
 
-    int errNum;
-    pBoard board = scanBoard(inputFile, argv[FILE_INDEX], &errNum);
-
-    if (fclose(inputFile))
+    if (commandLine.batch)
     {
-        freeBoard(board);
-        fprintf(ERROR_DEST, FCLOSE_ERROR);
-        return FCLOSE_EXIT;
+        rc = solveStream(inputFile, &commandLine);
     }
-    if (board == NULL)
+    else if (commandLine.counting || commandLine.enumerating)
     {
-        return errNum;
+        rc = countFile(inputFile, &commandLine, &start);
     }
-
-    unsigned int best = (unsigned int) pow(getSize(board), SQUARED);
-    pBoard bestBoard = getBest(board, getBoardChildren, getFilledCells, freeBoard, copyBoard, best);
-
-    if (bestBoard == NULL)
+    else
     {
-        freeBoard(board);
-        printf(NO_SOLUTION_ERROR);
-        return SUCCESS_EXIT;
+        rc = solveFile(inputFile, &commandLine, &start);
     }
-    printBoard(bestBoard);
-
-    freeBoard(board);
-    freeBoard(bestBoard);
-    return SUCCESS_EXIT;
-}
\ No newline at end of file
+    closeCache(commandLine.options.cache);
+    return rc;
+}
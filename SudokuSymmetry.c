@@ -0,0 +1,606 @@
+// -------------------------- includes -------------------------
+
+#include "SudokuSymmetry.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+// -------------------------- macros -------------------------
+
+//number of cells the canonical form search may relabel before it settles for the smallest image
+//found so far.
+#define CANONICAL_WORK_LIMIT (1UL << 20)
+//the bit the number of filled cells of a line starts at in its key, see lineKeys().
+#define COUNT_SHIFT 32
+
+// -------------------------- structs -------------------------
+
+/**
+ * @brief The state of a canonical form search, see canonicalForm().
+ */
+typedef struct CanonicalSearch
+{
+    unsigned int size;
+    unsigned int blockSize;
+    //the cells of the board, row by row, in the orientation being searched, and whether each of
+    //its rows and columns is empty.
+    unsigned char* cells;
+    unsigned char emptyRows[MAX_BOARD_SIZE];
+    unsigned char emptyCols[MAX_BOARD_SIZE];
+    //the keys of the rows, columns, bands and stacks of the board, see lineKeys().
+    unsigned long long rowKeys[MAX_BOARD_SIZE];
+    unsigned long long colKeys[MAX_BOARD_SIZE];
+    unsigned long long bandKeys[MAX_BOARD_SIZE];
+    unsigned long long stackKeys[MAX_BOARD_SIZE];
+    //the symmetry being built; its digits are 0 while unlabeled, and nextDigit is the next label.
+    Symmetry symmetry;
+    unsigned int nextDigit;
+    //the stack of the board at each stack of the image.
+    unsigned char stacks[MAX_BOARD_SIZE];
+    //the rows, columns and stacks of the board placed in the image so far.
+    unsigned char usedRows[MAX_BOARD_SIZE];
+    unsigned char usedCols[MAX_BOARD_SIZE];
+    unsigned char usedStacks[MAX_BOARD_SIZE];
+    //the image being built, and the smallest complete image found so far with its symmetry.
+    unsigned char* image;
+    unsigned char* best;
+    int hasBest;
+    Symmetry bestSymmetry;
+    //the number of times the best image was replaced.
+    unsigned long updates;
+    //the relabeled rows of the candidates for a row of the image, a row per row of the board.
+    unsigned char* candidates;
+    //the number of cells relabeled so far.
+    unsigned long work;
+} CanonicalSearch;
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief writes the given row of the board, with its columns in the order of the search's
+ * symmetry and its digits relabeled: labeled digits by their labels, and the others by the next
+ * labels, in the order they appear in the row.
+ * @param search the given search.
+ * @param row the given row.
+ * @param result for the result: the relabeled row.
+ */
+static void relabelRow(CanonicalSearch* search, unsigned int row, unsigned char* result)
+{
+    unsigned int size = search->size;
+    const unsigned char* cells = search->cells + row * size;
+    unsigned char* digits = search->symmetry.digits;
+    unsigned int next = search->nextDigit;
+    for (unsigned int c = 0; c < size; c++)
+    {
+        unsigned int val = cells[search->symmetry.cols[c]];
+        if (val != 0 && digits[val] == 0)
+        {
+            digits[val] = (unsigned char)next++;
+        }
+        result[c] = digits[val];
+    }
+    //the labels were only lent to the row.
+    for (unsigned int c = 0; c < size; c++)
+    {
+        unsigned int val = cells[search->symmetry.cols[c]];
+        if (digits[val] >= search->nextDigit)
+        {
+            digits[val] = 0;
+        }
+    }
+    search->work += size;
+}
+
+/**
+ * @brief labels the digits of the given row of the board that are not labeled yet, in the order
+ * they appear in the row.
+ * @param search the given search.
+ * @param row the given row.
+ */
+static void labelRow(CanonicalSearch* search, unsigned int row)
+{
+    const unsigned char* cells = search->cells + row * search->size;
+    for (unsigned int c = 0; c < search->size; c++)
+    {
+        unsigned int val = cells[search->symmetry.cols[c]];
+        if (val != 0 && search->symmetry.digits[val] == 0)
+        {
+            search->symmetry.digits[val] = (unsigned char)search->nextDigit++;
+        }
+    }
+}
+
+/**
+ * @brief removes the labels given at or after the given label from the digits of the given row.
+ * @param search the given search.
+ * @param row the given row.
+ * @param firstLabel the given label.
+ */
+static void unlabelRow(CanonicalSearch* search, unsigned int row, unsigned int firstLabel)
+{
+    const unsigned char* cells = search->cells + row * search->size;
+    for (unsigned int c = 0; c < search->size; c++)
+    {
+        unsigned int val = cells[search->symmetry.cols[c]];
+        if (search->symmetry.digits[val] >= firstLabel)
+        {
+            search->symmetry.digits[val] = 0;
+        }
+    }
+    search->nextDigit = firstLabel;
+}
+
+/**
+ * @brief keeps the complete image of the given search as its best image, labeling the digits the
+ * board does not use with the labels left, in increasing order.
+ * @param search the given search.
+ */
+static void keepImage(CanonicalSearch* search)
+{
+    unsigned int size = search->size;
+    memcpy(search->best, search->image, size * size);
+    search->bestSymmetry = search->symmetry;
+    unsigned int next = search->nextDigit;
+    for (unsigned int val = 1; val <= size; val++)
+    {
+        if (search->bestSymmetry.digits[val] == 0)
+        {
+            search->bestSymmetry.digits[val] = (unsigned char)next++;
+        }
+    }
+    search->hasBest = TRUE;
+    search->updates++;
+}
+
+/**
+ * @brief checks whether the given candidate for a row of the image is the same as an earlier one:
+ * two unused empty rows of the same band lead to the same images.
+ * @param search the given search.
+ * @param row the given candidate.
+ * @return TRUE if an earlier candidate is the same; FALSE otherwise.
+ */
+static int isRepeatedRow(const CanonicalSearch* search, unsigned int row)
+{
+    if (!search->emptyRows[row])
+    {
+        return FALSE;
+    }
+    for (unsigned int other = row - row % search->blockSize; other < row; other++)
+    {
+        if (!search->usedRows[other] && search->emptyRows[other])
+        {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/**
+ * @brief places the rows of the image from the given row on, with the columns of the search's
+ * symmetry, in every way that may lead to a smaller image than the best one, and keeps the
+ * smallest image found.
+ * @param search the given search; the rows before the given row are placed.
+ * @param r the given row.
+ * @param less TRUE if the rows before the given row are already smaller than those of the best
+ * image; FALSE if they are the same.
+ */
+static void placeRows(CanonicalSearch* search, unsigned int r, int less)
+{
+    unsigned int size = search->size;
+    if (r == size)
+    {
+        if (!search->hasBest || less)
+        {
+            keepImage(search);
+        }
+        return;
+    }
+    if (search->hasBest && search->work > CANONICAL_WORK_LIMIT)
+    {
+        return;
+    }
+
+    //a row inside a band comes from the band of the row before it, and a row starting a band from
+    //one of the unused bands with the largest key; either way, it is one of the rows of its band
+    //with the largest key.
+    unsigned int blockSize = search->blockSize;
+    unsigned int first = 0, last = size;
+    unsigned long long bandKey = 0;
+    if (r % blockSize != 0)
+    {
+        first = search->symmetry.rows[r - 1] - search->symmetry.rows[r - 1] % blockSize;
+        last = first + blockSize;
+    }
+    else
+    {
+        for (unsigned int band = 0; band < blockSize; band++)
+        {
+            if (!search->usedRows[band * blockSize] && search->bandKeys[band] > bandKey)
+            {
+                bandKey = search->bandKeys[band];
+            }
+        }
+    }
+    unsigned long long rowKeys[MAX_BOARD_SIZE];
+    for (unsigned int band = first / blockSize; band * blockSize < last; band++)
+    {
+        rowKeys[band] = 0;
+        for (unsigned int row = band * blockSize; row < (band + 1) * blockSize; row++)
+        {
+            if (!search->usedRows[row] && search->rowKeys[row] > rowKeys[band])
+            {
+                rowKeys[band] = search->rowKeys[row];
+            }
+        }
+    }
+    unsigned char candidates[MAX_BOARD_SIZE];
+    unsigned int numCandidates = 0;
+    for (unsigned int row = first; row < last; row++)
+    {
+        unsigned int band = row / blockSize;
+        if (!search->usedRows[row] && search->rowKeys[row] == rowKeys[band] &&
+            (r % blockSize != 0 || (!search->usedRows[band * blockSize] &&
+                                    search->bandKeys[band] == bandKey)))
+        {
+            candidates[numCandidates++] = (unsigned char)row;
+        }
+    }
+
+    //the row of the image is the smallest of the candidates.
+    const unsigned char* smallest = NULL;
+    for (unsigned int i = 0; i < numCandidates; i++)
+    {
+        unsigned char* candidate = search->candidates + candidates[i] * size;
+        relabelRow(search, candidates[i], candidate);
+        if (smallest == NULL || memcmp(candidate, smallest, size) < 0)
+        {
+            smallest = candidate;
+        }
+    }
+    assert(smallest != NULL);
+    if (search->hasBest && !less)
+    {
+        int order = memcmp(smallest, search->best + r * size, size);
+        if (order > 0)
+        {
+            return;
+        }
+        less = order < 0;
+    }
+
+    //every candidate tied for the smallest is tried; the candidates are listed first, since the
+    //rows below overwrite them.
+    unsigned char* smallestRow = search->image + r * size;
+    memcpy(smallestRow, smallest, size);
+    unsigned char ties[MAX_BOARD_SIZE];
+    unsigned int numTies = 0;
+    for (unsigned int i = 0; i < numCandidates; i++)
+    {
+        unsigned int row = candidates[i];
+        if (memcmp(search->candidates + row * size, smallestRow, size) == 0 &&
+            !isRepeatedRow(search, row))
+        {
+            ties[numTies++] = (unsigned char)row;
+        }
+    }
+    for (unsigned int i = 0; i < numTies; i++)
+    {
+        unsigned long updates = search->updates;
+        unsigned int firstLabel = search->nextDigit;
+        labelRow(search, ties[i]);
+        search->symmetry.rows[r] = ties[i];
+        search->usedRows[ties[i]] = TRUE;
+        placeRows(search, r + 1, less);
+        search->usedRows[ties[i]] = FALSE;
+        unlabelRow(search, ties[i], firstLabel);
+        //once the best image was replaced by one through this row, the rows so far are the same
+        //as the best image's.
+        less = less && updates == search->updates;
+    }
+}
+
+/**
+ * @brief places the columns of the image from the given column on, in every order that keeps the
+ * columns of each stack sorted by their keys, largest first. Places the rows for each order.
+ * @param search the given search; the stacks, and the columns before the given column, are
+ * placed.
+ * @param c the given column.
+ */
+static void placeCols(CanonicalSearch* search, unsigned int c)
+{
+    unsigned int size = search->size, blockSize = search->blockSize;
+    if (c == size)
+    {
+        placeRows(search, 0, FALSE);
+        return;
+    }
+    if (search->hasBest && search->work > CANONICAL_WORK_LIMIT)
+    {
+        return;
+    }
+
+    unsigned int start = search->stacks[c / blockSize] * blockSize;
+    unsigned long long key = 0;
+    for (unsigned int col = start; col < start + blockSize; col++)
+    {
+        if (!search->usedCols[col] && search->colKeys[col] > key)
+        {
+            key = search->colKeys[col];
+        }
+    }
+    int triedEmpty = FALSE;
+    for (unsigned int col = start; col < start + blockSize; col++)
+    {
+        //empty columns of a stack are interchangeable, so only the first of them is tried.
+        if (search->usedCols[col] || search->colKeys[col] != key ||
+            (search->emptyCols[col] && triedEmpty))
+        {
+            continue;
+        }
+        triedEmpty = triedEmpty || search->emptyCols[col];
+        search->symmetry.cols[c] = (unsigned char)col;
+        search->usedCols[col] = TRUE;
+        placeCols(search, c + 1);
+        search->usedCols[col] = FALSE;
+    }
+}
+
+/**
+ * @brief places the stacks of the image from the given stack on, in every order that keeps them
+ * sorted by their keys, largest first. Places the columns for each order.
+ * @param search the given search; the stacks before the given stack are placed.
+ * @param s the given stack.
+ */
+static void placeStacks(CanonicalSearch* search, unsigned int s)
+{
+    unsigned int blockSize = search->blockSize;
+    if (s == blockSize)
+    {
+        placeCols(search, 0);
+        return;
+    }
+
+    unsigned long long key = 0;
+    for (unsigned int stack = 0; stack < blockSize; stack++)
+    {
+        if (!search->usedStacks[stack] && search->stackKeys[stack] > key)
+        {
+            key = search->stackKeys[stack];
+        }
+    }
+    int triedEmpty = FALSE;
+    for (unsigned int stack = 0; stack < blockSize; stack++)
+    {
+        //empty stacks are interchangeable, so only the first of them is tried.
+        int emptyStack = search->stackKeys[stack] == 0;
+        if (search->usedStacks[stack] || search->stackKeys[stack] != key ||
+            (emptyStack && triedEmpty))
+        {
+            continue;
+        }
+        triedEmpty = triedEmpty || emptyStack;
+        search->stacks[s] = (unsigned char)stack;
+        search->usedStacks[stack] = TRUE;
+        placeStacks(search, s + 1);
+        search->usedStacks[stack] = FALSE;
+    }
+}
+
+/**
+ * @brief computes the keys of the rows, columns, bands and stacks of the board of the given
+ * search. A line's key is its number of filled cells, followed by the sum of the squares of the
+ * numbers of filled cells of the lines crossing it at them; a band's or stack's key is the sum of
+ * the keys of its lines. The keys of a board's lines are those of their images under any
+ * symmetry, except that a transposition swaps rows and columns, so only images whose lines are
+ * sorted by their keys are searched.
+ * @param search the given search.
+ */
+static void lineKeys(CanonicalSearch* search)
+{
+    unsigned int size = search->size, blockSize = search->blockSize;
+    unsigned long long rowCounts[MAX_BOARD_SIZE] = {0}, colCounts[MAX_BOARD_SIZE] = {0};
+    for (unsigned int i = 0; i < size; i++)
+    {
+        for (unsigned int j = 0; j < size; j++)
+        {
+            int filled = search->cells[i * size + j] != 0;
+            rowCounts[i] += filled;
+            colCounts[j] += filled;
+        }
+    }
+    for (unsigned int i = 0; i < size; i++)
+    {
+        search->rowKeys[i] = rowCounts[i] << COUNT_SHIFT;
+        search->colKeys[i] = colCounts[i] << COUNT_SHIFT;
+    }
+    for (unsigned int i = 0; i < size; i++)
+    {
+        for (unsigned int j = 0; j < size; j++)
+        {
+            if (search->cells[i * size + j] != 0)
+            {
+                search->rowKeys[i] += colCounts[j] * colCounts[j];
+                search->colKeys[j] += rowCounts[i] * rowCounts[i];
+            }
+        }
+    }
+    for (unsigned int b = 0; b < blockSize; b++)
+    {
+        search->bandKeys[b] = 0;
+        search->stackKeys[b] = 0;
+        for (unsigned int i = b * blockSize; i < (b + 1) * blockSize; i++)
+        {
+            search->bandKeys[b] += search->rowKeys[i];
+            search->stackKeys[b] += search->colKeys[i];
+        }
+    }
+}
+
+/**
+ * @brief compares the given keys of lines as sorted lists, largest first.
+ * @param keys the first keys; sorted by this function.
+ * @param otherKeys the second keys; sorted by this function.
+ * @param size the number of keys of each.
+ * @return a negative value, zero or a positive value as the first keys come before, are the same
+ * as, or come after the second keys.
+ */
+static int compareKeys(unsigned long long* keys, unsigned long long* otherKeys, unsigned int size)
+{
+    for (unsigned int i = 1; i < size; i++)
+    {
+        for (unsigned int j = i; j > 0 && keys[j] > keys[j - 1]; j--)
+        {
+            unsigned long long key = keys[j];
+            keys[j] = keys[j - 1];
+            keys[j - 1] = key;
+        }
+        for (unsigned int j = i; j > 0 && otherKeys[j] > otherKeys[j - 1]; j--)
+        {
+            unsigned long long key = otherKeys[j];
+            otherKeys[j] = otherKeys[j - 1];
+            otherKeys[j - 1] = key;
+        }
+    }
+    for (unsigned int i = 0; i < size; i++)
+    {
+        if (keys[i] != otherKeys[i])
+        {
+            return keys[i] < otherKeys[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief writes the cells of the given board, row by row, into the given search, transposed or
+ * not, and marks its empty rows and columns.
+ * @param search the given search.
+ * @param board the given board.
+ * @param transposed whether to transpose the board.
+ */
+static void loadBoard(CanonicalSearch* search, pBoard board, int transposed)
+{
+    unsigned int size = search->size;
+    memset(search->emptyRows, TRUE, size);
+    memset(search->emptyCols, TRUE, size);
+    for (unsigned int i = 0; i < size; i++)
+    {
+        for (unsigned int j = 0; j < size; j++)
+        {
+            unsigned int val = transposed ? getCellValue(board, j, i) : getCellValue(board, i, j);
+            search->cells[i * size + j] = (unsigned char)val;
+            if (val != 0)
+            {
+                search->emptyRows[i] = FALSE;
+                search->emptyCols[j] = FALSE;
+            }
+        }
+    }
+}
+
+int canonicalForm(pBoard board, unsigned char* cells, Symmetry* symmetry)
+{
+    assert(board != NULL && cells != NULL && symmetry != NULL);
+
+    static const CanonicalSearch emptySearch;
+    CanonicalSearch search = emptySearch;
+    unsigned int size = getSize(board);
+    search.size = size;
+    search.blockSize = (unsigned int)sqrt(size);
+    search.symmetry.size = size;
+    search.cells = (unsigned char*)malloc(4 * size * size);
+    if (search.cells == NULL)
+    {
+        return ERROR;
+    }
+    search.image = search.cells + size * size;
+    search.best = search.image + size * size;
+    search.candidates = search.best + size * size;
+
+    //the image's rows are the board's rows, or its columns if they have larger keys; both are
+    //searched if their keys are the same.
+    loadBoard(&search, board, FALSE);
+    lineKeys(&search);
+    unsigned long long rowKeys[MAX_BOARD_SIZE], colKeys[MAX_BOARD_SIZE];
+    memcpy(rowKeys, search.rowKeys, size * sizeof(unsigned long long));
+    memcpy(colKeys, search.colKeys, size * sizeof(unsigned long long));
+    int order = compareKeys(rowKeys, colKeys, size);
+    for (int transposed = FALSE; transposed <= TRUE; transposed++)
+    {
+        if ((transposed && order > 0) || (!transposed && order < 0))
+        {
+            continue;
+        }
+        loadBoard(&search, board, transposed);
+        lineKeys(&search);
+        search.symmetry.transposed = transposed;
+        search.nextDigit = 1;
+        placeStacks(&search, 0);
+    }
+
+    memcpy(cells, search.best, size * size);
+    *symmetry = search.bestSymmetry;
+    free(search.cells);
+    return SUCCESS_EXIT;
+}
+
+/**
+ * @brief return the cell of the board at the given cell of its image under the given symmetry.
+ * @param symmetry the given symmetry.
+ * @param r the row of the image's cell.
+ * @param c the column of the image's cell.
+ * @param i for the result: the row of the board's cell.
+ * @param j for the result: the column of the board's cell.
+ */
+static void boardCell(const Symmetry* symmetry, unsigned int r, unsigned int c, unsigned int* i,
+                      unsigned int* j)
+{
+    *i = symmetry->transposed ? symmetry->cols[c] : symmetry->rows[r];
+    *j = symmetry->transposed ? symmetry->rows[r] : symmetry->cols[c];
+}
+
+void mapToImage(const Symmetry* symmetry, pBoard board, unsigned char* cells)
+{
+    assert(symmetry != NULL && board != NULL && cells != NULL);
+
+    unsigned int size = symmetry->size, i, j;
+    for (unsigned int r = 0; r < size; r++)
+    {
+        for (unsigned int c = 0; c < size; c++)
+        {
+            boardCell(symmetry, r, c, &i, &j);
+            cells[r * size + c] = symmetry->digits[getCellValue(board, i, j)];
+        }
+    }
+}
+
+int mapFromImage(const Symmetry* symmetry, const unsigned char* cells, pBoard board)
+{
+    assert(symmetry != NULL && cells != NULL && board != NULL);
+
+    unsigned int size = symmetry->size, i, j;
+    unsigned char inverse[MAX_BOARD_SIZE + 1];
+    for (unsigned int val = 0; val <= size; val++)
+    {
+        inverse[symmetry->digits[val]] = (unsigned char)val;
+    }
+    for (unsigned int r = 0; r < size; r++)
+    {
+        for (unsigned int c = 0; c < size; c++)
+        {
+            boardCell(symmetry, r, c, &i, &j);
+            unsigned int val = inverse[cells[r * size + c]];
+            unsigned int current = getCellValue(board, i, j);
+            if (current == 0 && val != 0)
+            {
+                setCell(board, i, j, val);
+            }
+            else if (current != val)
+            {
+                return FALSE;
+            }
+        }
+    }
+    return TRUE;
+}
@@ -0,0 +1,61 @@
+#ifndef EX3_SUDOKUSYMMETRY_H
+#define EX3_SUDOKUSYMMETRY_H
+
+#include "SudokuTree.h"
+
+// -------------------------- structs & typedef -------------------------
+
+/**
+ * @brief A symmetry of sudoku boards: a transposition, a reordering of the bands and of the rows
+ * within each band, a reordering of the stacks and of the columns within each stack, and a
+ * relabeling of the digits. Each maps solutions of a board to solutions of its image.
+ */
+typedef struct Symmetry
+{
+    unsigned int size;
+    //whether the board is transposed before its rows and columns are reordered.
+    int transposed;
+    //row r of the image is row rows[r] of the (transposed) board, and column c is column cols[c].
+    unsigned char rows[MAX_BOARD_SIZE];
+    unsigned char cols[MAX_BOARD_SIZE];
+    //digit d of the board is digit digits[d] of the image; digits[0] is 0, for empty cells.
+    unsigned char digits[MAX_BOARD_SIZE + 1];
+} Symmetry;
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief computes the canonical form of the given board: the image of the board, over all the
+ * symmetries, that comes first when its cells are read row by row, after the digits are
+ * relabeled in the order they first appear. Boards that are images of each other have the same
+ * canonical form. The search for it is pruned as soon as a partial image is larger than the
+ * smallest one found, and is cut off after CANONICAL_WORK_LIMIT cell comparisons, which only
+ * boards with many symmetries of their own reach; the form is then the smallest image found,
+ * which depends on the board alone, but may differ between images of it.
+ * @param board the given board.
+ * @param cells for the result: the cells of the canonical form, row by row; size * size bytes.
+ * @param symmetry for the result: the symmetry mapping the board to its canonical form.
+ * @return SUCCESS_EXIT, or ERROR if allocation failed.
+ */
+int canonicalForm(pBoard board, unsigned char* cells, Symmetry* symmetry);
+
+/**
+ * @brief writes the cells of the image of the given board under the given symmetry.
+ * @param symmetry the given symmetry; of the board's size.
+ * @param board the given board.
+ * @param cells for the result: the cells of the image, row by row; size * size bytes.
+ */
+void mapToImage(const Symmetry* symmetry, pBoard board, unsigned char* cells);
+
+/**
+ * @brief fills the empty cells of the given board from the given image of it under the given
+ * symmetry, mapped back through the symmetry.
+ * @param symmetry the given symmetry; of the board's size.
+ * @param cells the cells of the image, row by row.
+ * @param board the given board; its filled cells must agree with the image.
+ * @return TRUE if the board agrees with the image; FALSE otherwise, in which case the board may
+ * be partly filled.
+ */
+int mapFromImage(const Symmetry* symmetry, const unsigned char* cells, pBoard board);
+
+#endif //EX3_SUDOKUSYMMETRY_H
@@ -1,320 +1,2084 @@
 // -------------------------- includes -------------------------
 
 #include "SudokuTree.h"
+#include "GenericDFS.h"
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
 #include <assert.h>
 
+//the SIMD kernels need x86 intrinsics and GCC's target attributes and CPU detection.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_KERNELS 1
+#include <immintrin.h>
+#else
+#define SIMD_KERNELS 0
+#endif
+
+// -------------------------- macros -------------------------
+
+//number of 64 bit words in a value mask; enough to hold MAX_BOARD_SIZE values.
+#define MASK_WORDS 2
+//number of bits in a value mask word.
+#define WORD_BITS 64
+
+#if MAX_BOARD_SIZE > MASK_WORDS * WORD_BITS
+#error "MASK_WORDS is too small to hold MAX_BOARD_SIZE values"
+#endif
+#if MASK_WORDS + 1 > CHILD_CURSOR_WORDS
+#error "CHILD_CURSOR_WORDS is too small to hold a cell and a ValueMask"
+#endif
+
+#if MAX_BOARD_SIZE > UINT8_MAX
+#error "Cell is too narrow to hold MAX_BOARD_SIZE"
+#endif
+
+#if MAX_BOARD_SIZE * MAX_BOARD_SIZE > UINT16_MAX
+#error "the board trail is too narrow to hold MAX_BOARD_SIZE * MAX_BOARD_SIZE cells"
+#endif
+
+//number of bits a move's value takes; the rest of the move holds the cell index.
+#define MOVE_VALUE_BITS 8
+
+//number of reasons of a forced cell that are not gathered yet, see ExplanationScratch.
+#define NOT_CACHED UINT8_MAX
+
+//number of used values masks per board line (row, column or block).
+#define MASK_KINDS 3
+
+//-----Zobrist keys, see zobristKey(), and random value orders, see nextRandom().
+//seed of the keys, and increment of the random generator.
+#define ZOBRIST_SEED 0x9e3779b97f4a7c15ULL
+//multipliers of the splitmix64 finalizer.
+#define ZOBRIST_MIX1 0xbf58476d1ce4e5b9ULL
+#define ZOBRIST_MIX2 0x94d049bb133111ebULL
+//multiplier spreading the runs of a restarting search over the seeds of random value orders.
+#define RUN_STRIDE 0xd1b54a32d192ed03ULL
+
+//number of cells the AVX2 kernel scans at a time.
+#define SIMD_LANES 4
+//count the AVX2 kernel gives filled cells, above any real count.
+#define SIMD_FILLED_COUNT 0xff
+//attributes compiling a function for the popcnt instruction.
+#define POPCNT_TARGET __attribute__((target("popcnt")))
+//attributes compiling a function for AVX2, and the popcnt instruction.
+#define AVX2_TARGET __attribute__((target("avx2,popcnt")))
+
 // -------------------------- structs -------------------------
 
+/**
+ * @brief A set of cell values; value v is represented by bit (v - 1).
+ */
+typedef struct ValueMask
+{
+    uint64_t words[MASK_WORDS];
+} ValueMask;
+
+/**
+ * @brief The value of a single cell; wide enough for any value up to MAX_BOARD_SIZE.
+ */
+typedef uint8_t Cell;
+
+/**
+ * @brief The cells set by the moves applied to a board during an in-place search.
+ * The indices of the set cells are kept in cells; marks[m] is the length of cells before the
+ * m'th applied move, so undoing a move clears the cells from its mark to the top. positions[k] is
+ * the index in cells the k'th cell was last recorded at, which is stale once the cell is cleared.
+ * The scratch space of explainBoardConflict() is only allocated once a dead end is explained, and
+ * the candidates table of propagateAny() once a board of another size than the sized kernels'
+ * is propagated.
+ */
+typedef struct BoardTrail
+{
+    unsigned int length;
+    unsigned int numMarks;
+    uint16_t* marks;
+    uint16_t* positions;
+    struct ExplanationScratch* scratch;
+    ValueMask* candidates;
+    uint16_t cells[];
+} BoardTrail;
+
+/**
+ * @brief Where propagation last found a board has no solution: the empty cell with no legal
+ * value, or, if val is not zero, the line with no place left for the value.
+ */
+typedef struct BoardConflict
+{
+    unsigned int cell;
+    unsigned int line;
+    unsigned int val;
+} BoardConflict;
+
+/**
+ * @brief The space explainBoardConflict() gathers the reasons of a dead end in, kept from one
+ * explanation to the next. A cell was added to the reasons of the current explanation, and a move
+ * blamed by it, if its entry of added, or of blamed, holds the explanation's stamp, so nothing
+ * needs clearing between explanations.
+ */
+typedef struct ExplanationScratch
+{
+    unsigned int stamp;
+    unsigned int* added;
+    unsigned int* blamed;
+    //the cells added whose own reasons are still to be gathered.
+    uint16_t* pending;
+    unsigned int numPending;
+    //the reasons of every forced cell, size entries per cell, of which it has numReasons, or
+    //NOT_CACHED until they are first gathered and again once the cell is cleared.
+    uint16_t* reasons;
+    uint8_t* numReasons;
+} ExplanationScratch;
+
+/**
+ * @brief A kernel scanning the empty cells of a row: it computes their candidates, counts them
+ * and finds the cell with the fewest. All kernels give the same results; they differ in the
+ * board sizes they are compiled for and the instructions they need, see selectKernels().
+ * @param board the given board.
+ * @param i the row index.
+ * @param candidates for the result: the candidates of every empty cell of the row, indexed by
+ * column; entries of filled cells are unspecified. May be NULL.
+ * @param clampSingles TRUE to count cells with no candidates as having one, so the cell found is
+ * the first one with at most one candidate.
+ * @param column for the result: the column of the first empty cell with the fewest candidates.
+ * @return the number of candidates of that cell, 0 meaning the board has no solution; the
+ * board's size plus one if the row has no empty cell.
+ */
+typedef unsigned int (*RowKernel)(pBoard board, unsigned int i, ValueMask* candidates,
+                                  int clampSingles, unsigned int* column);
+
+/**
+ * @brief The hot functions of the search, compiled for boards of a single size, or of any size if
+ * size is 0.
+ * propagate fills the cells forced by the board's values, repeating until no more cells are
+ * forced, and records them on the given trail, which may be NULL; it returns FALSE if the board
+ * was found to have no solution, TRUE otherwise.
+ */
+typedef struct BoardKernels
+{
+    unsigned int size;
+    RowKernel scanRow;
+    int (*propagate)(pBoard board, BoardTrail* trail);
+} BoardKernels;
+
 /**
  * @brief: A struct representing a sudoku board.
+ * The board is a single allocation of bytes bytes, made with dfsAlloc() so that searches draw
+ * boards from their arenas: the header is followed by the used values masks (size row masks,
+ * size column masks and size block masks) and then by the size * size cells in row-major order.
+ * Apart from the trail, which is only allocated once moves are applied to the board in place and
+ * is never shared with copies, and the kernels of its size, which are shared by all boards, the
+ * board holds no pointers, so it can be copied with memcpy().
+ * The hash is updated along with the cells, so it never needs rescanning either.
+ * The masks keep for every row, column and block the set of values already used in it. They are
+ * updated by setCell(), so checking a move or computing the candidates of a cell never rescans
+ * the grid.
  */
 struct SudokuBoard
 {
     unsigned int size;
-    unsigned int** grid;
+    unsigned int blockSize;
     unsigned int filledCells;
+    unsigned int bytes;
+    //the XOR of the Zobrist keys of the filled cells, see zobristKey().
+    uint64_t hash;
+    BranchingMode branching;
+    int propagation;
+    ValueOrdering ordering;
+    //the run of a restarting search, and the seed of RANDOM_ORDERING it is mixed into.
+    unsigned int run;
+    uint64_t seed;
+    ValueMask allValues;
+    const BoardKernels* kernels;
+    BoardTrail* trail;
+    BoardConflict conflict;
+    ValueMask used[];
 };
 
-// -------------------------- functions -------------------------
+// -------------------------- mask functions -------------------------
+
+/**
+ * @brief adds the given value to the given mask.
+ * @param mask the given mask.
+ * @param val the given value; must be positive.
+ */
+static inline void maskAdd(ValueMask* mask, unsigned int val)
+{
+    mask->words[(val - 1) / WORD_BITS] |= (uint64_t)1 << ((val - 1) % WORD_BITS);
+}
+
+/**
+ * @brief removes the given value from the given mask.
+ * @param mask the given mask.
+ * @param val the given value; must be positive.
+ */
+static inline void maskRemove(ValueMask* mask, unsigned int val)
+{
+    mask->words[(val - 1) / WORD_BITS] &= ~((uint64_t)1 << ((val - 1) % WORD_BITS));
+}
+
+/**
+ * @brief checks whether the given value is in the given mask.
+ * @param mask the given mask.
+ * @param val the given value; must be positive.
+ * @return TRUE if the value is in the mask; FALSE otherwise.
+ */
+static inline int maskHas(const ValueMask* mask, unsigned int val)
+{
+    return (int)((mask->words[(val - 1) / WORD_BITS] >> ((val - 1) % WORD_BITS)) & 1);
+}
+
+/**
+ * @brief checks whether the given mask is empty.
+ * @param mask the given mask.
+ * @return TRUE if the mask holds no values; FALSE otherwise.
+ */
+static inline int maskIsEmpty(const ValueMask* mask)
+{
+    for (unsigned int w = 0; w < MASK_WORDS; w++)
+    {
+        if (mask->words[w])
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/**
+ * @brief checks whether the given mask holds exactly one value.
+ * @param mask the given mask.
+ * @return TRUE if the mask holds a single value; FALSE otherwise.
+ */
+static inline int maskIsSingle(const ValueMask* mask)
+{
+    int found = FALSE;
+    for (unsigned int w = 0; w < MASK_WORDS; w++)
+    {
+        uint64_t word = mask->words[w];
+        if (word == 0)
+        {
+            continue;
+        }
+        if (found || (word & (word - 1)) != 0)
+        {
+            return FALSE;
+        }
+        found = TRUE;
+    }
+    return found;
+}
+
+/**
+ * @brief return the number of mask words holding the values of a board of the given size.
+ * @param size the board's size.
+ * @return the number of words.
+ */
+static inline unsigned int wordsOf(unsigned int size)
+{
+    return (size + WORD_BITS - 1) / WORD_BITS;
+}
+
+/**
+ * @brief return the number of values in the given mask.
+ * @param mask the given mask.
+ * @return the number of values.
+ */
+static inline unsigned int maskCount(const ValueMask* mask)
+{
+    unsigned int count = 0;
+    for (unsigned int w = 0; w < MASK_WORDS; w++)
+    {
+        count += (unsigned int)__builtin_popcountll(mask->words[w]);
+    }
+    return count;
+}
+
+/**
+ * @brief removes the smallest value from the given mask and returns it.
+ * @param mask the given mask; must not be empty.
+ * @return the removed value.
+ */
+static inline unsigned int maskPopFirst(ValueMask* mask)
+{
+    unsigned int w = 0;
+    while (mask->words[w] == 0)
+    {
+        w++;
+    }
+    assert(w < MASK_WORDS);
+    unsigned int bit = (unsigned int)__builtin_ctzll(mask->words[w]);
+    mask->words[w] &= mask->words[w] - 1;
+    return w * WORD_BITS + bit + 1;
+}
+
+// -------------------------- board functions -------------------------
+
+/**
+ * @brief return the used values mask of the i'th row.
+ * @param board the given board.
+ * @param i the row index.
+ * @return the mask.
+ */
+static inline ValueMask* rowUsed(pBoard board, unsigned int i)
+{
+    return &board->used[i];
+}
+
+/**
+ * @brief return the used values mask of the j'th column.
+ * @param board the given board.
+ * @param j the column index.
+ * @return the mask.
+ */
+static inline ValueMask* columnUsed(pBoard board, unsigned int j)
+{
+    return &board->used[board->size + j];
+}
+
+/**
+ * @brief return the used values mask of the k'th block.
+ * @param board the given board.
+ * @param k the block index.
+ * @return the mask.
+ */
+static inline ValueMask* blockUsed(pBoard board, unsigned int k)
+{
+    return &board->used[2 * board->size + k];
+}
+
+/**
+ * @brief return the cells of the given board, in row-major order.
+ * @param board the given board.
+ * @return the cells.
+ */
+static inline Cell* cellsOf(pBoard board)
+{
+    return (Cell*)&board->used[MASK_KINDS * board->size];
+}
+
+/**
+ * @brief return the index of the block holding the [i][j] cell.
+ * @param i the row index.
+ * @param j the column index.
+ * @param blockSize the board's block size.
+ * @return the block index.
+ */
+static inline unsigned int blockIndex(unsigned int i, unsigned int j, unsigned int blockSize)
+{
+    return (i / blockSize) * blockSize + j / blockSize;
+}
+
+/**
+ * @brief return the index of the block holding the [i][j] cell.
+ * @param board the given board.
+ * @param i the row index.
+ * @param j the column index.
+ * @return the block index.
+ */
+static inline unsigned int blockOf(pBoard board, unsigned int i, unsigned int j)
+{
+    return blockIndex(i, j, board->blockSize);
+}
+
+/**
+ * @brief computes the set of values that can legally be set to the empty [i][j] cell of a board
+ * of the given size.
+ * @param board the given board.
+ * @param i the row index.
+ * @param j the column index.
+ * @param candidates for the result: the set of legal values.
+ * @param size the board's size.
+ * @param blockSize the board's block size.
+ */
+static inline void candidatesOf(pBoard board, unsigned int i, unsigned int j,
+                                ValueMask* candidates, unsigned int size, unsigned int blockSize)
+{
+    const ValueMask* row = rowUsed(board, i);
+    const ValueMask* column = columnUsed(board, j);
+    const ValueMask* block = blockUsed(board, blockIndex(i, j, blockSize));
+    for (unsigned int w = 0; w < MASK_WORDS; w++)
+    {
+        candidates->words[w] = w < wordsOf(size) ?
+                               board->allValues.words[w] &
+                               ~(row->words[w] | column->words[w] | block->words[w]) : 0;
+    }
+}
+
+/**
+ * @brief computes the set of values that can legally be set to the empty [i][j] cell.
+ * @param board the given board.
+ * @param i the row index.
+ * @param j the column index.
+ * @param candidates for the result: the set of legal values.
+ */
+static void getCandidates(pBoard board, unsigned int i, unsigned int j, ValueMask* candidates)
+{
+    candidatesOf(board, i, j, candidates, board->size, board->blockSize);
+}
+
+// -------------------------- kernels -------------------------
+
+/*
+ * The hot functions of the search are written once, as bodies taking the board's size and block
+ * size as arguments, and instantiated for the common sizes with constant arguments, so the
+ * compiler unrolls their loops and turns their divisions into multiplications. Their masks only
+ * ever touch the words a board of their size needs: a single one for all of them.
+ * The row kernels are also instantiated for each instruction set; see selectKernelTable().
+ */
+
+/**
+ * @brief the body of the scalar row kernels, see RowKernel; inlined into each of them, so it is
+ * compiled for their sizes and instruction sets.
+ * @param size the board's size.
+ * @param blockSize the board's block size.
+ */
+static inline __attribute__((always_inline))
+unsigned int scanRowScalar(pBoard board, unsigned int i, ValueMask* candidates, int clampSingles,
+                           unsigned int* column, unsigned int size, unsigned int blockSize)
+{
+    const Cell* cells = cellsOf(board) + i * size;
+    const ValueMask* row = rowUsed(board, i);
+    const ValueMask* blocks = blockUsed(board, (i / blockSize) * blockSize);
+    unsigned int bestCount = size + 1;
+    for (unsigned int j = 0; j < size; j++)
+    {
+        if (cells[j] != 0)
+        {
+            continue;
+        }
+        const ValueMask* columnMask = columnUsed(board, j);
+        const ValueMask* block = &blocks[j / blockSize];
+        unsigned int count = 0;
+        ValueMask free = {{0}};
+        for (unsigned int w = 0; w < wordsOf(size); w++)
+        {
+            free.words[w] = board->allValues.words[w] &
+                            ~(row->words[w] | columnMask->words[w] | block->words[w]);
+            count += (unsigned int)__builtin_popcountll(free.words[w]);
+        }
+        if (candidates != NULL)
+        {
+            candidates[j] = free;
+        }
+        if (clampSingles && count == 0)
+        {
+            count = 1;
+        }
+        if (count < bestCount)
+        {
+            bestCount = count;
+            *column = j;
+        }
+    }
+    return bestCount;
+}
+
+#if SIMD_KERNELS
+
+/**
+ * @brief counts the set bits of each 64 bit lane of the given vector, looking the count of every
+ * nibble up in a shuffle table.
+ * @param v the given vector.
+ * @return the counts, one per lane.
+ */
+__attribute__((target("avx2")))
+static inline __m256i popcountLanes(__m256i v)
+{
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(v, nibble));
+    __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+    return _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256());
+}
+
+/**
+ * @brief the body of the AVX2 row kernels, see RowKernel; scans SIMD_LANES cells at a time.
+ * The board's values must fit in a single mask word.
+ * @param size the board's size.
+ * @param blockSize the board's block size.
+ */
+__attribute__((target("avx2,popcnt"))) static inline __attribute__((always_inline))
+unsigned int scanRowVector(pBoard board, unsigned int i, ValueMask* candidates, int clampSingles,
+                           unsigned int* column, unsigned int size, unsigned int blockSize)
+{
+    const Cell* cells = cellsOf(board) + i * size;
+    const ValueMask* blocks = blockUsed(board, (i / blockSize) * blockSize);
+    const uint64_t rowFree = board->allValues.words[0] & ~rowUsed(board, i)->words[0];
+    const __m256i laneIndices = _mm256_setr_epi64x(0, 1, 2, 3);
+    const __m256i filledCount = _mm256_set1_epi64x(SIMD_FILLED_COUNT);
+    const __m256i one = _mm256_set1_epi64x(1);
+    __m256i bestCounts = filledCount;
+    __m256i bestColumns = _mm256_setzero_si256();
+
+    //the free values of the row's blocks, one per column; padded for the last lanes.
+    uint64_t blockFree[WORD_BITS + SIMD_LANES];
+    for (unsigned int j = 0; j < size; j += blockSize)
+    {
+        uint64_t free = rowFree & ~blocks[j / blockSize].words[0];
+        for (unsigned int t = j; t < j + blockSize; t++)
+        {
+            blockFree[t] = free;
+        }
+    }
+
+    for (unsigned int j = 0; j < size; j += SIMD_LANES)
+    {
+        unsigned int numLanes = size - j < SIMD_LANES ? size - j : SIMD_LANES;
+
+        //the first words of the lanes' column masks, which are two words apart; the masks past
+        //the last column belong to the blocks, and the lanes holding them are dropped below.
+        const __m256i* columnMasks = (const __m256i*)columnUsed(board, j);
+        __m256i columnWords = _mm256_permute4x64_epi64(
+                _mm256_unpacklo_epi64(_mm256_loadu_si256(columnMasks),
+                                      _mm256_loadu_si256(columnMasks + 1)),
+                _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i free = _mm256_andnot_si256(columnWords,
+                                           _mm256_loadu_si256((const __m256i*)(blockFree + j)));
+
+        //lanes of filled cells, and of cells past the row, get a count above any other.
+        uint32_t laneCells = UINT32_MAX;
+        if (size * size - i * size - j >= SIMD_LANES)
+        {
+            memcpy(&laneCells, cells + j, SIMD_LANES);
+        }
+        else
+        {
+            memcpy(&laneCells, cells + j, numLanes);
+        }
+        __m256i empty = _mm256_and_si256(
+                _mm256_cmpeq_epi64(_mm256_cvtepu8_epi64(_mm_cvtsi32_si128((int)laneCells)),
+                                   _mm256_setzero_si256()),
+                _mm256_cmpgt_epi64(_mm256_set1_epi64x(numLanes), laneIndices));
+        __m256i counts = popcountLanes(free);
+        if (clampSingles)
+        {
+            counts = _mm256_max_epi32(counts, one);
+        }
+        counts = _mm256_blendv_epi8(filledCount, counts, empty);
+
+        //each lane keeps its first cell with the fewest candidates.
+        __m256i better = _mm256_cmpgt_epi64(bestCounts, counts);
+        bestCounts = _mm256_blendv_epi8(bestCounts, counts, better);
+        bestColumns = _mm256_blendv_epi8(
+                bestColumns, _mm256_add_epi64(_mm256_set1_epi64x(j), laneIndices), better);
+
+        if (candidates != NULL)
+        {
+            //spread the lanes into masks of two words, the second one empty.
+            __m256i ordered = _mm256_permute4x64_epi64(free, _MM_SHUFFLE(3, 1, 2, 0));
+            __m256i masks[2] = {_mm256_unpacklo_epi64(ordered, _mm256_setzero_si256()),
+                                _mm256_unpackhi_epi64(ordered, _mm256_setzero_si256())};
+            if (numLanes == SIMD_LANES)
+            {
+                _mm256_storeu_si256((__m256i*)&candidates[j], masks[0]);
+                _mm256_storeu_si256((__m256i*)&candidates[j + 2], masks[1]);
+            }
+            else
+            {
+                memcpy(&candidates[j], masks, numLanes * sizeof(ValueMask));
+            }
+        }
+    }
+
+    //the fewest candidates of all lanes, and the first column holding them.
+    long long laneCounts[SIMD_LANES], laneColumns[SIMD_LANES];
+    _mm256_storeu_si256((__m256i*)laneCounts, bestCounts);
+    _mm256_storeu_si256((__m256i*)laneColumns, bestColumns);
+    unsigned int bestCount = size + 1;
+    for (unsigned int l = 0; l < SIMD_LANES; l++)
+    {
+        if (laneCounts[l] == SIMD_FILLED_COUNT)
+        {
+            continue;
+        }
+        if ((unsigned int)laneCounts[l] < bestCount ||
+            ((unsigned int)laneCounts[l] == bestCount && (unsigned int)laneColumns[l] < *column))
+        {
+            bestCount = (unsigned int)laneCounts[l];
+            *column = (unsigned int)laneColumns[l];
+        }
+    }
+    return bestCount;
+}
+
+#endif //SIMD_KERNELS
+
+//defines a row kernel running the given body with the given size and block size, compiled with
+//the given attributes; see RowKernel.
+#define DEFINE_ROW_KERNEL(name, attributes, body, size, blockSize)                               \
+    attributes static unsigned int name(pBoard board, unsigned int i, ValueMask* candidates,      \
+                                        int clampSingles, unsigned int* column)                   \
+    {                                                                                             \
+        return body(board, i, candidates, clampSingles, column, size, blockSize);                 \
+    }
+
+DEFINE_ROW_KERNEL(scanRow4, , scanRowScalar, 4, 2)
+DEFINE_ROW_KERNEL(scanRow9, , scanRowScalar, 9, 3)
+DEFINE_ROW_KERNEL(scanRow16, , scanRowScalar, 16, 4)
+DEFINE_ROW_KERNEL(scanRow25, , scanRowScalar, 25, 5)
+DEFINE_ROW_KERNEL(scanRowAny, , scanRowScalar, board->size, board->blockSize)
+
+#if SIMD_KERNELS
+
+DEFINE_ROW_KERNEL(scanRow4Popcnt, POPCNT_TARGET, scanRowScalar, 4, 2)
+DEFINE_ROW_KERNEL(scanRow9Popcnt, POPCNT_TARGET, scanRowScalar, 9, 3)
+DEFINE_ROW_KERNEL(scanRow16Popcnt, POPCNT_TARGET, scanRowScalar, 16, 4)
+DEFINE_ROW_KERNEL(scanRow25Popcnt, POPCNT_TARGET, scanRowScalar, 25, 5)
+DEFINE_ROW_KERNEL(scanRowAnyPopcnt, POPCNT_TARGET, scanRowScalar, board->size, board->blockSize)
+
+DEFINE_ROW_KERNEL(scanRow16Avx2, AVX2_TARGET, scanRowVector, 16, 4)
+DEFINE_ROW_KERNEL(scanRow25Avx2, AVX2_TARGET, scanRowVector, 25, 5)
+
+/**
+ * @brief the AVX2 kernel of boards of any size, see RowKernel; falls back to the popcnt kernel on
+ * boards whose values do not fit in a single mask word.
+ */
+AVX2_TARGET
+static unsigned int scanRowAnyAvx2(pBoard board, unsigned int i, ValueMask* candidates,
+                                   int clampSingles, unsigned int* column)
+{
+    if (board->size > WORD_BITS)
+    {
+        return scanRowAnyPopcnt(board, i, candidates, clampSingles, column);
+    }
+    return scanRowVector(board, i, candidates, clampSingles, column, board->size,
+                         board->blockSize);
+}
+
+#endif //SIMD_KERNELS
+
+/**
+ * @brief return the Zobrist key of the k'th cell holding the given value: a pseudo random word,
+ * computed by mixing the pair rather than looked up, since a table of the keys of every cell and
+ * value of MAX_BOARD_SIZE boards would take megabytes.
+ * @param k the row-major index of the cell.
+ * @param val the cell's value.
+ * @return the key.
+ */
+static inline uint64_t zobristKey(unsigned int k, unsigned int val)
+{
+    uint64_t key = (((uint64_t)k << MOVE_VALUE_BITS) | val) + ZOBRIST_SEED;
+    key = (key ^ (key >> 30)) * ZOBRIST_MIX1;
+    key = (key ^ (key >> 27)) * ZOBRIST_MIX2;
+    return key ^ (key >> 31);
+}
+
+/**
+ * @brief return the index of the t'th cell of the given line, where lines 0..size-1 are the rows,
+ * lines size..2*size-1 are the columns and lines 2*size..3*size-1 are the blocks.
+ * @param line the line index.
+ * @param t the index of the cell within the line.
+ * @param size the board's size.
+ * @param blockSize the board's block size.
+ * @return the row-major index of the cell.
+ */
+static inline unsigned int lineCell(unsigned int line, unsigned int t, unsigned int size,
+                                    unsigned int blockSize)
+{
+    if (line < size)
+    {
+        return line * size + t;
+    }
+    if (line < 2 * size)
+    {
+        return t * size + (line - size);
+    }
+    unsigned int k = line - 2 * size;
+    return ((k / blockSize) * blockSize + t / blockSize) * size +
+           (k % blockSize) * blockSize + t % blockSize;
+}
+
+/**
+ * @brief sets the empty k'th cell of the board to the given value and records it on the given
+ * trail; setCell() for a board of the given size.
+ * @param board the given board.
+ * @param trail the given trail; NULL if the cell should not be recorded.
+ * @param k the row-major index of the cell.
+ * @param val the given value; must be positive.
+ * @param size the board's size.
+ * @param blockSize the board's block size.
+ */
+static inline void deduceCell(pBoard board, BoardTrail* trail, unsigned int k, unsigned int val,
+                              unsigned int size, unsigned int blockSize)
+{
+    unsigned int i = k / size, j = k % size;
+    assert(cellsOf(board)[k] == 0 && val > 0 && val <= size);
+
+    cellsOf(board)[k] = (Cell)val;
+    board->filledCells++;
+    board->hash ^= zobristKey(k, val);
+    maskAdd(rowUsed(board, i), val);
+    maskAdd(columnUsed(board, j), val);
+    maskAdd(blockUsed(board, blockIndex(i, j, blockSize)), val);
+    if (trail != NULL)
+    {
+        trail->positions[k] = (uint16_t)trail->length;
+        trail->cells[trail->length++] = (uint16_t)k;
+    }
+}
+
+/**
+ * @brief records where propagation found the board has no solution, see BoardConflict.
+ * @param board the given board.
+ * @param cell the empty cell with no legal value, if val is zero.
+ * @param line the line with no place left for val, if val is not zero.
+ * @param val the given value, or zero.
+ */
+static inline void recordConflict(pBoard board, unsigned int cell, unsigned int line,
+                                  unsigned int val)
+{
+    board->conflict.cell = cell;
+    board->conflict.line = line;
+    board->conflict.val = val;
+}
+
+/**
+ * @brief removes the value of the k'th cell from the candidates of the cells sharing a line with
+ * it.
+ * @param candidates the candidates of the board's cells, in row-major order.
+ * @param k the row-major index of the cell.
+ * @param val the cell's value.
+ * @param size the board's size.
+ * @param blockSize the board's block size.
+ */
+static inline void removeCandidate(ValueMask* candidates, unsigned int k, unsigned int val,
+                                   unsigned int size, unsigned int blockSize)
+{
+    unsigned int i = k / size, j = k % size;
+    unsigned int lines[MASK_KINDS] = {i, size + j, 2 * size + blockIndex(i, j, blockSize)};
+    for (unsigned int l = 0; l < MASK_KINDS; l++)
+    {
+        for (unsigned int t = 0; t < size; t++)
+        {
+            maskRemove(&candidates[lineCell(lines[l], t, size, blockSize)], val);
+        }
+    }
+}
+
+/**
+ * @brief fills every empty cell that has a single legal value (naked singles).
+ * @param board the given board.
+ * @param trail the trail to record the filled cells on; may be NULL.
+ * @param changed for the result: set to TRUE if a cell was filled.
+ * @param size the board's size.
+ * @param blockSize the board's block size.
+ * @return FALSE if an empty cell has no legal value; TRUE otherwise.
+ */
+static inline __attribute__((always_inline))
+int fillNakedSingles(pBoard board, BoardTrail* trail, int* changed, unsigned int size,
+                     unsigned int blockSize)
+{
+    RowKernel scanRow = board->kernels->scanRow;
+    const Cell* cells = cellsOf(board);
+    ValueMask rowCandidates[MAX_BOARD_SIZE];
+    for (unsigned int i = 0; i < size; i++)
+    {
+        unsigned int column;
+        unsigned int fewest = scanRow(board, i, rowCandidates, FALSE, &column);
+        if (fewest == 0)
+        {
+            recordConflict(board, i * size + column, 0, 0);
+            return FALSE;
+        }
+        if (fewest != 1)
+        {
+            continue;
+        }
+        //filling a single may take the last value of another single of the row, so recheck them.
+        for (unsigned int j = column; j < size; j++)
+        {
+            if (cells[i * size + j] != 0 || !maskIsSingle(&rowCandidates[j]))
+            {
+                continue;
+            }
+            ValueMask candidates;
+            candidatesOf(board, i, j, &candidates, size, blockSize);
+            if (maskIsEmpty(&candidates))
+            {
+                recordConflict(board, i * size + j, 0, 0);
+                return FALSE;
+            }
+            deduceCell(board, trail, i * size + j, maskPopFirst(&candidates), size, blockSize);
+            *changed = TRUE;
+        }
+    }
+    return TRUE;
+}
+
+/**
+ * @brief fills every cell that is the only place left for a value in one of its lines
+ * (hidden singles).
+ * @param board the given board.
+ * @param trail the trail to record the filled cells on; may be NULL.
+ * @param changed for the result: set to TRUE if a cell was filled.
+ * @param candidates scratch space for the candidates of every cell of the board.
+ * @param size the board's size.
+ * @param blockSize the board's block size.
+ * @return FALSE if a missing value has no place left in a line; TRUE otherwise.
+ */
+static inline __attribute__((always_inline))
+int fillHiddenSingles(pBoard board, BoardTrail* trail, int* changed, ValueMask* candidates,
+                      unsigned int size, unsigned int blockSize)
+{
+    RowKernel scanRow = board->kernels->scanRow;
+    const Cell* cells = cellsOf(board);
+    for (unsigned int i = 0; i < size; i++)
+    {
+        unsigned int column;
+        scanRow(board, i, &candidates[i * size], FALSE, &column);
+    }
+
+    for (unsigned int line = 0; line < MASK_KINDS * size; line++)
+    {
+        //once holds the values possible in at least one empty cell, twice in at least two.
+        ValueMask once = {{0}}, twice = {{0}}, used = {{0}};
+        for (unsigned int t = 0; t < size; t++)
+        {
+            unsigned int k = lineCell(line, t, size, blockSize);
+            if (cells[k] != 0)
+            {
+                maskAdd(&used, cells[k]);
+                continue;
+            }
+            for (unsigned int w = 0; w < wordsOf(size); w++)
+            {
+                twice.words[w] |= once.words[w] & candidates[k].words[w];
+                once.words[w] |= candidates[k].words[w];
+            }
+        }
+
+        ValueMask hidden = {{0}};
+        for (unsigned int w = 0; w < wordsOf(size); w++)
+        {
+            uint64_t missing = board->allValues.words[w] & ~(once.words[w] | used.words[w]);
+            if (missing)
+            {
+                recordConflict(board, 0, line,
+                               w * WORD_BITS + (unsigned int)__builtin_ctzll(missing) + 1);
+                return FALSE;
+            }
+            hidden.words[w] = once.words[w] & ~twice.words[w];
+        }
+
+        while (!maskIsEmpty(&hidden))
+        {
+            unsigned int val = maskPopFirst(&hidden);
+            unsigned int t = 0, k = 0;
+            for (; t < size; t++)
+            {
+                k = lineCell(line, t, size, blockSize);
+                if (cells[k] == 0 && maskHas(&candidates[k], val))
+                {
+                    break;
+                }
+            }
+            //the value's only place was taken by another hidden single of the line.
+            if (t == size)
+            {
+                recordConflict(board, 0, line, val);
+                return FALSE;
+            }
+            deduceCell(board, trail, k, val, size, blockSize);
+            removeCandidate(candidates, k, val, size, blockSize);
+            *changed = TRUE;
+        }
+    }
+    return TRUE;
+}
+
+/**
+ * @brief fills the cells forced by the board's values, repeating until no more cells are forced.
+ * @param board the given board.
+ * @param trail the trail to record the filled cells on; may be NULL.
+ * @param candidates scratch space for the candidates of every cell of the board; if NULL, hidden
+ * singles are not looked for.
+ * @param size the board's size.
+ * @param blockSize the board's block size.
+ * @return FALSE if the board was found to have no solution; TRUE otherwise.
+ */
+static inline __attribute__((always_inline))
+int propagateSized(pBoard board, BoardTrail* trail, ValueMask* candidates, unsigned int size,
+                   unsigned int blockSize)
+{
+    int changed = TRUE;
+    while (changed && board->filledCells < size * size)
+    {
+        changed = FALSE;
+        if (!fillNakedSingles(board, trail, &changed, size, blockSize))
+        {
+            return FALSE;
+        }
+        if (!changed && candidates != NULL &&
+            !fillHiddenSingles(board, trail, &changed, candidates, size, blockSize))
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+//defines a propagation kernel for the given size and block size, whose candidates fit on the
+//thread's stack; see BoardKernels.
+#define DEFINE_PROPAGATION(name, size, blockSize)                                                \
+    static int name(pBoard board, BoardTrail* trail)                                              \
+    {                                                                                             \
+        ValueMask candidates[(size) * (size)];                                                    \
+        return propagateSized(board, trail, candidates, size, blockSize);                         \
+    }
+
+DEFINE_PROPAGATION(propagate4, 4, 2)
+DEFINE_PROPAGATION(propagate9, 9, 3)
+DEFINE_PROPAGATION(propagate16, 16, 4)
+DEFINE_PROPAGATION(propagate25, 25, 5)
+
+/**
+ * @brief the propagation kernel of any other size. The candidates of larger boards are kept on
+ * the heap, so searching them needs little of the thread's stack: in the trail of a board
+ * searched in place, allocated once, and otherwise drawn from the search's arena with dfsAlloc().
+ * If there is no room for them, the board is propagated without looking for hidden singles.
+ */
+static int propagateAny(pBoard board, BoardTrail* trail)
+{
+    size_t bytes = board->size * board->size * sizeof(ValueMask);
+    if (trail != NULL && trail->candidates == NULL)
+    {
+        trail->candidates = (ValueMask*)malloc(bytes);
+    }
+    ValueMask* candidates = trail != NULL ? trail->candidates : (ValueMask*)dfsAlloc(bytes);
+    int rc = propagateSized(board, trail, candidates, board->size, board->blockSize);
+    if (trail == NULL)
+    {
+        dfsFree(candidates);
+    }
+    return rc;
+}
+
+//the kernels of each board size for each instruction set; the last entry of every table serves
+//any other size.
+static const BoardKernels portableKernels[] = {
+        {4, scanRow4, propagate4},
+        {9, scanRow9, propagate9},
+        {16, scanRow16, propagate16},
+        {25, scanRow25, propagate25},
+        {0, scanRowAny, propagateAny}
+};
+
+#if SIMD_KERNELS
+
+static const BoardKernels popcntKernels[] = {
+        {4, scanRow4Popcnt, propagate4},
+        {9, scanRow9Popcnt, propagate9},
+        {16, scanRow16Popcnt, propagate16},
+        {25, scanRow25Popcnt, propagate25},
+        {0, scanRowAnyPopcnt, propagateAny}
+};
+
+//a vector scans whole 4x4 and 9x9 rows in one or three steps, which is no faster than popcnt.
+static const BoardKernels avx2Kernels[] = {
+        {4, scanRow4Popcnt, propagate4},
+        {9, scanRow9Popcnt, propagate9},
+        {16, scanRow16Avx2, propagate16},
+        {25, scanRow25Avx2, propagate25},
+        {0, scanRowAnyAvx2, propagateAny}
+};
+
+#endif //SIMD_KERNELS
+
+/**
+ * @brief return the kernel table of the fastest instruction set the processor supports; chosen
+ * on the first call.
+ * @return the table.
+ */
+static const BoardKernels* selectKernelTable(void)
+{
+    static const BoardKernels* table = NULL;
+    const BoardKernels* selected = __atomic_load_n(&table, __ATOMIC_RELAXED);
+    if (selected != NULL)
+    {
+        return selected;
+    }
+    selected = portableKernels;
+#if SIMD_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+    {
+        selected = avx2Kernels;
+    }
+    else if (__builtin_cpu_supports("popcnt"))
+    {
+        selected = popcntKernels;
+    }
+#endif
+    __atomic_store_n(&table, selected, __ATOMIC_RELAXED);
+    return selected;
+}
+
+/**
+ * @brief return the kernels of boards of the given size.
+ * @param size the given size.
+ * @return the kernels.
+ */
+static const BoardKernels* selectKernels(unsigned int size)
+{
+    const BoardKernels* kernels = selectKernelTable();
+    while (kernels->size != 0 && kernels->size != size)
+    {
+        kernels++;
+    }
+    return kernels;
+}
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief Constructs a new sudoku board of the given size and sets all it cells to zero.
+ * @param size the given size.
+ * @return the new board.
+ */
+pNode newBoard(unsigned int size)
+{
+    assert(size <= MAX_BOARD_SIZE);
+    size_t bytes = sizeof(Board) + MASK_KINDS * size * sizeof(ValueMask) +
+                   size * size * sizeof(Cell);
+    pBoard board = (pBoard)dfsAlloc(bytes);
+    if (board == NULL)
+    {
+        fprintf(ERROR_DEST, MALLOC_ERROR);
+        return NULL;
+    }
+    memset(board, 0, bytes);
+
+    board->size = size;
+    board->blockSize = (unsigned int)sqrt(size);
+    board->bytes = (unsigned int)bytes;
+    board->branching = FIRST_EMPTY_BRANCHING;
+    board->propagation = TRUE;
+    board->kernels = selectKernels(size);
+    for (unsigned int val = 1; val <= size; val++)
+    {
+        maskAdd(&board->allValues, val);
+    }
+    return board;
+}
+
+/**
+ * @brief Sets the [i][j] cell of the board to the given value.
+ * @param board the given board.
+ * @param i the row index.
+ * @param j the column index.
+ * @param val the given value.
+ */
+void setCell(pBoard board, unsigned int i, unsigned int j, unsigned int val)
+{
+    assert(board != NULL);
+    assert(i >= 0 && i < board->size);
+    assert(j >= 0 && j < board->size);
+    assert(val >= 0 && val <= board->size);
+    assert(cellsOf(board)[i * board->size + j] == 0);
+
+    cellsOf(board)[i * board->size + j] = (Cell)val;
+    if (val)
+    {
+        board->filledCells++;
+        board->hash ^= zobristKey(i * board->size + j, val);
+        maskAdd(rowUsed(board, i), val);
+        maskAdd(columnUsed(board, j), val);
+        maskAdd(blockUsed(board, blockOf(board, i, j)), val);
+    }
+}
+
+/**
+ * @brief Sets the filled [i][j] cell of the board back to zero; the reverse of setCell().
+ * @param board the given board.
+ * @param i the row index.
+ * @param j the column index.
+ */
+static void clearCell(pBoard board, unsigned int i, unsigned int j)
+{
+    Cell* cell = &cellsOf(board)[i * board->size + j];
+    assert(*cell != 0);
+
+    maskRemove(rowUsed(board, i), *cell);
+    maskRemove(columnUsed(board, j), *cell);
+    maskRemove(blockUsed(board, blockOf(board, i, j)), *cell);
+    board->filledCells--;
+    board->hash ^= zobristKey(i * board->size + j, *cell);
+    *cell = 0;
+}
+
+/**
+ * @brief Creates a deep copy of the given board.
+ * @param node the given board.
+ * @return the new board.
+ */
+pNode copyBoard(pNode node)
+{
+    pBoard board = (pBoard)node;
+    if (board == NULL)
+    {
+        fprintf(ERROR_DEST, POINTER_ERROR);
+        return NULL;
+    }
+    pBoard copyBoard = (pBoard)dfsAlloc(board->bytes);
+    if (copyBoard == NULL)
+    {
+        fprintf(ERROR_DEST, MALLOC_ERROR);
+        return NULL;
+    }
+    memcpy(copyBoard, board, board->bytes);
+    copyBoard->trail = NULL;
+    return copyBoard;
+}
+
+/**
+ * @brief free the given board from the heap.
+ * @param node the given board.
+ */
+void freeBoard(pNode node)
+{
+    pBoard board = (pBoard)node;
+    if (board != NULL && board->trail != NULL)
+    {
+        free(board->trail->scratch);
+        free(board->trail->candidates);
+        free(board->trail);
+    }
+    dfsFree(board);
+}
+
+/**
+ * @brief return the Zobrist hash of the given board: the XOR of the keys of its filled cells,
+ * kept up to date by setCell() and the moves.
+ * @param node the given board.
+ * @return the hash.
+ */
+unsigned long long hashBoard(pNode node)
+{
+    assert(node != NULL);
+    return ((pBoard)node)->hash;
+}
+
+/**
+ * @brief return whether the given boards have the same size and cells.
+ * @param node the given board.
+ * @param other the other board.
+ * @return TRUE if the boards are equal; FALSE otherwise.
+ */
+int equalBoards(pNode node, pNode other)
+{
+    pBoard board = (pBoard)node, otherBoard = (pBoard)other;
+    assert(board != NULL && otherBoard != NULL);
+    if (board->size != otherBoard->size || board->filledCells != otherBoard->filledCells)
+    {
+        return FALSE;
+    }
+    return memcmp(cellsOf(board), cellsOf(otherBoard),
+                  board->size * board->size * sizeof(Cell)) == 0;
+}
+
+/**
+ * return the number of filled (not zero) cells on the board.
+ * @param node the given board.
+ * @return the number of cells.
+ */
+unsigned int getFilledCells(pNode node)
+{
+    pBoard board = (pBoard)node;
+    if (board == NULL)
+    {
+        fprintf(ERROR_DEST, POINTER_ERROR);
+        return 0;
+    }
+    return board->filledCells;
+}
+
+/**
+ * @brief fills the cells forced by the board's values, repeating until no more cells are forced.
+ * @param board the given board.
+ * @param trail the trail to record the filled cells on; may be NULL.
+ * @return FALSE if the board was found to have no solution; TRUE otherwise.
+ */
+static int propagate(pBoard board, BoardTrail* trail)
+{
+    return board->kernels->propagate(board, trail);
+}
+
+/**
+ * @brief find the next empty cell on the board, going left to right from the top,
+ * @param board the given board.
+ * @param row address for the empty cell's row index.
+ * @param column address for the empty cell's column index.
+ * @return TRUE if found an empty cell; FALSE otherwise;
+ */
+static int nextEmptyBlock(pBoard board, unsigned int* row, unsigned int* column)
+{
+    assert(board != NULL);
+    assert(row != NULL && column != NULL);
+
+    const Cell* cells = cellsOf(board);
+    const Cell* empty = (const Cell*)memchr(cells, 0, board->size * board->size);
+    if (empty == NULL)
+    {
+        return FALSE;
+    }
+    *row = (unsigned int)(empty - cells) / board->size;
+    *column = (unsigned int)(empty - cells) % board->size;
+    return TRUE;
+}
+
+/**
+ * @brief find the empty cell with the fewest legal values on the board. The scan stops early at a
+ * cell with at most one legal value, since no other cell can be a better choice.
+ * @param board the given board.
+ * @param row address for the empty cell's row index.
+ * @param column address for the empty cell's column index.
+ * @return TRUE if found an empty cell; FALSE otherwise;
+ */
+static int minRemainingBlock(pBoard board, unsigned int* row, unsigned int* column)
+{
+    assert(board != NULL);
+    assert(row != NULL && column != NULL);
+
+    RowKernel scanRow = board->kernels->scanRow;
+    unsigned int bestCount = board->size + 1;
+    for (unsigned int i = 0; i < board->size && bestCount > 1; i++)
+    {
+        unsigned int j;
+        unsigned int count = scanRow(board, i, NULL, TRUE, &j);
+        if (count < bestCount)
+        {
+            bestCount = count;
+            *row = i;
+            *column = j;
+        }
+    }
+    return bestCount <= board->size;
+}
+
+/**
+ * @brief find the empty cell to branch on, according to the board's branching mode.
+ * @param board the given board.
+ * @param row address for the empty cell's row index.
+ * @param column address for the empty cell's column index.
+ * @return TRUE if found an empty cell; FALSE otherwise;
+ */
+static int selectBlock(pBoard board, unsigned int* row, unsigned int* column)
+{
+    if (board->branching == MIN_REMAINING_BRANCHING)
+    {
+        return minRemainingBlock(board, row, column);
+    }
+    return nextEmptyBlock(board, row, column);
+}
+
+/**
+ * @brief return the next number of the given random generator, see splitmix64.
+ * @param state the generator's state.
+ * @return the number.
+ */
+static inline uint64_t nextRandom(uint64_t* state)
+{
+    uint64_t z = (*state += ZOBRIST_SEED);
+    z = (z ^ (z >> 30)) * ZOBRIST_MIX1;
+    z = (z ^ (z >> 27)) * ZOBRIST_MIX2;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief counts, for every given candidate of the empty [i][j] cell, the empty cells sharing a
+ * line with the cell that have it as a candidate too: the candidates setting it would rule out.
+ * @param board the given board.
+ * @param i the row index.
+ * @param j the column index.
+ * @param candidates the given candidates.
+ * @param ruledOut for the result: the counts, indexed by value; must be zeroed.
+ */
+static void countRuledOut(pBoard board, unsigned int i, unsigned int j,
+                          const ValueMask* candidates, unsigned int* ruledOut)
+{
+    unsigned int size = board->size, blockSize = board->blockSize;
+    unsigned int lines[MASK_KINDS] = {i, size + j, 2 * size + blockOf(board, i, j)};
+    const Cell* cells = cellsOf(board);
+    for (unsigned int l = 0; l < MASK_KINDS; l++)
+    {
+        for (unsigned int t = 0; t < size; t++)
+        {
+            unsigned int k = lineCell(lines[l], t, size, blockSize);
+            //the cells of the block in the row or the column were counted with them.
+            if (cells[k] != 0 || (l != 1 && k % size == j) || (l != 0 && k / size == i))
+            {
+                continue;
+            }
+            ValueMask shared;
+            candidatesOf(board, k / size, k % size, &shared, size, blockSize);
+            for (unsigned int w = 0; w < MASK_WORDS; w++)
+            {
+                shared.words[w] &= candidates->words[w];
+            }
+            while (!maskIsEmpty(&shared))
+            {
+                ruledOut[maskPopFirst(&shared)]++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief writes the legal values of the empty [i][j] cell into the given array, in the order of
+ * the board's value ordering.
+ * @param board the given board.
+ * @param i the row index.
+ * @param j the column index.
+ * @param values for the result: the values; must have room for the board's size values.
+ * @return the number of values.
+ */
+static unsigned int orderValues(pBoard board, unsigned int i, unsigned int j, Cell* values)
+{
+    ValueMask candidates;
+    getCandidates(board, i, j, &candidates);
+    unsigned int count = 0;
+    for (ValueMask rest = candidates; !maskIsEmpty(&rest);)
+    {
+        values[count++] = (Cell)maskPopFirst(&rest);
+    }
+
+    if (board->ordering == LEAST_CONSTRAINING_ORDERING)
+    {
+        unsigned int ruledOut[MAX_BOARD_SIZE + 1] = {0};
+        countRuledOut(board, i, j, &candidates, ruledOut);
+        //an insertion sort, which is stable, so ties stay in ascending order.
+        for (unsigned int t = 1; t < count; t++)
+        {
+            Cell val = values[t];
+            unsigned int u = t;
+            for (; u > 0 && ruledOut[values[u - 1]] > ruledOut[val]; u--)
+            {
+                values[u] = values[u - 1];
+            }
+            values[u] = val;
+        }
+    }
+    else if (board->ordering == RANDOM_ORDERING)
+    {
+        uint64_t state = board->hash ^ board->seed ^ (uint64_t)board->run * RUN_STRIDE;
+        for (unsigned int t = count; t > 1; t--)
+        {
+            unsigned int u = (unsigned int)(nextRandom(&state) % t);
+            Cell val = values[t - 1];
+            values[t - 1] = values[u];
+            values[u] = val;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief removes the first of the given remaining values of the empty [i][j] cell in the order
+ * of the board's value ordering from them.
+ * @param board the given board.
+ * @param i the row index.
+ * @param j the column index.
+ * @param remaining the given values; must not be empty, and only hold legal values of the cell.
+ * @return the removed value.
+ */
+static unsigned int popNextValue(pBoard board, unsigned int i, unsigned int j,
+                                 ValueMask* remaining)
+{
+    if (board->ordering == ASCENDING_ORDERING)
+    {
+        return maskPopFirst(remaining);
+    }
+    Cell values[MAX_BOARD_SIZE];
+    unsigned int count = orderValues(board, i, j, values);
+    unsigned int t = 0;
+    while (!maskHas(remaining, values[t]))
+    {
+        t++;
+    }
+    assert(t < count);
+    (void)count;
+    maskRemove(remaining, values[t]);
+    return values[t];
+}
+
+/**
+ * @brief constructs all legal permutations of the given board created by setting a value to
+ * the given [i][j] cell, and saves them into the given address of an array, in the order of the
+ * board's value ordering.
+ * @param board the given board.
+ * @param children the address of an array; used for the result.
+ * @param i the row index
+ * @param j the column index
+ * @return the number of permutations created; ERROR if allocation failed.
+ */
+static int assignBoardChildren(pBoard board, pBoard** children, unsigned int i, unsigned int j)
+{
+    assert(*children != NULL);
+    unsigned int count = 0;
+
+    Cell values[MAX_BOARD_SIZE];
+    unsigned int numValues = orderValues(board, i, j, values);
+    for (unsigned int t = 0; t < numValues; t++)
+    {
+        unsigned int val = values[t];
+        (*children)[count] = copyBoard(board);
+        if ((*children)[count] == NULL)
+        {
+            fprintf(ERROR_DEST, MALLOC_ERROR);
+            for (unsigned int k = 0; k < count; k++)
+            {
+                freeBoard((*children)[k]);
+            }
+            dfsFree(*children);
+            return ERROR;
+        }
+        setCell((*children)[count], i, j, val);
+        if (board->propagation && !propagate((*children)[count], NULL))
+        {
+            freeBoard((*children)[count]);
+            continue;
+        }
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief constructs all legal permutations of the given board created by setting a value to
+ * the empty cell selected by the board's branching mode, and saves them into the given address
+ * of an array.
+ * @param node the given board
+ * @param nodeChildren the address of an array; used for the result.
+ * @return the number of permutations created or ERROR.
+ */
+int getBoardChildren(pNode node, pNode** nodeChildren /*for the result*/)
+{
+
+    pBoard board = (pBoard)node;
+    pBoard** children = (pBoard**)nodeChildren;
+    if (board == NULL || children == NULL)
+    {
+        fprintf(ERROR_DEST, POINTER_ERROR);
+        return ERROR;
+    }
+
+    unsigned int i, j;
+    int result = selectBlock(board, &i, &j);
+    if (!result)
+    {
+        return 0;
+    }
+
+    *children = (pBoard*)dfsAlloc(board->size * sizeof(pBoard));
+    if (*children == NULL)
+    {
+        fprintf(ERROR_DEST, MALLOC_ERROR);
+        return ERROR;
+    }
+
+    return assignBoardChildren(board, children, i, j);
+}
 
 /**
- * @brief allocates and sets to zero the cells of the i'th row in the given board's grid.
- * @param board the given board.
- * @param i the row index.
- * @param size the size of the grid.
- * @return success if the allocation and assignment were successful; error otherwise.
+ * @brief constructs the next legal permutation of the given board created by setting a value to
+ * the empty cell selected by the board's branching mode. The cursor holds the selected cell,
+ * plus one, followed by the values not tried yet.
+ * @param node the given board.
+ * @param cursor the given cursor, see getNextChildFunc.
+ * @param child for the result: the new board.
+ * @return TRUE if a board was created; FALSE if no values are left; ERROR if allocation failed.
  */
-static int assignCells(pBoard board, unsigned int i, unsigned int size)
+int getNextBoardChild(pNode node, unsigned long long* cursor, pNode* child /*for the result*/)
 {
-    board->grid[i] = (unsigned int*)malloc(size * sizeof(unsigned int));
-    if (board->grid[i] == NULL)
+    pBoard board = (pBoard)node;
+    if (board == NULL || cursor == NULL || child == NULL)
     {
-        fprintf(ERROR_DEST, MALLOC_ERROR);
-        for (unsigned int j = 0; j < i; j++)
+        fprintf(ERROR_DEST, POINTER_ERROR);
+        return ERROR;
+    }
+
+    ValueMask candidates;
+    unsigned int i, j;
+    if (cursor[0] == 0)
+    {
+        if (!selectBlock(board, &i, &j))
         {
-            free(board->grid[j]);
+            return FALSE;
         }
-        free(board->grid);
-        free(board);
-        return ERROR;
+        cursor[0] = i * board->size + j + 1;
+        getCandidates(board, i, j, &candidates);
+    }
+    else
+    {
+        i = (unsigned int)(cursor[0] - 1) / board->size;
+        j = (unsigned int)(cursor[0] - 1) % board->size;
+        memcpy(candidates.words, cursor + 1, sizeof(candidates.words));
     }
 
-    for (unsigned j = 0; j < size; j++)
+    pBoard next = NULL;
+    while (next == NULL && !maskIsEmpty(&candidates))
     {
-        board->grid[i][j] = 0;
+        unsigned int val = popNextValue(board, i, j, &candidates);
+        next = (pBoard)copyBoard(board);
+        if (next == NULL)
+        {
+            return ERROR;
+        }
+        setCell(next, i, j, val);
+        if (board->propagation && !propagate(next, NULL))
+        {
+            freeBoard(next);
+            next = NULL;
+        }
     }
-    return SUCCESS_EXIT;
+    memcpy(cursor + 1, candidates.words, sizeof(candidates.words));
+    *child = next;
+    return next != NULL;
 }
 
 /**
- * @brief Constructs a new sudoku board of the given size and sets all it cells to zero.
- * @param size the given size.
- * @return the new board.
+ * @brief writes the moves setting each legal value to the empty cell selected by the board's
+ * branching mode into the given array, which must have room for the board's size moves.
+ * @param node the given board.
+ * @param moves the given array; used for the result.
+ * @return the number of moves or ERROR.
  */
-pNode newBoard(unsigned int size)
+int getBoardMoves(pNode node, Move* moves /*for the result*/)
 {
-    pBoard board = (pBoard)malloc(sizeof(Board));
-    if (board == NULL)
+    pBoard board = (pBoard)node;
+    if (board == NULL || moves == NULL)
     {
-        fprintf(ERROR_DEST, MALLOC_ERROR);
-        return NULL;
+        fprintf(ERROR_DEST, POINTER_ERROR);
+        return ERROR;
     }
 
-    board->grid = (unsigned int**)malloc(size * sizeof(unsigned int*));
-    if (board->grid == NULL)
+    unsigned int i, j;
+    if (!selectBlock(board, &i, &j))
     {
-        fprintf(ERROR_DEST, MALLOC_ERROR);
-        free(board);
-        return NULL;
+        return 0;
     }
 
-    int rc;
-    for (unsigned int i = 0; i < size; i++)
+    int count = 0;
+    Move cell = (Move)(i * board->size + j) << MOVE_VALUE_BITS;
+    if (board->ordering == ASCENDING_ORDERING)
     {
-        rc = assignCells(board, i, size);
-        if (rc == ERROR)
+        ValueMask candidates;
+        getCandidates(board, i, j, &candidates);
+        while (!maskIsEmpty(&candidates))
         {
-            return NULL;
+            moves[count++] = cell | maskPopFirst(&candidates);
         }
+        return count;
     }
-
-    board->size = size;
-    board->filledCells = 0;
-    return board;
+    Cell values[MAX_BOARD_SIZE];
+    count = (int)orderValues(board, i, j, values);
+    for (int t = 0; t < count; t++)
+    {
+        moves[t] = cell | values[t];
+    }
+    return count;
 }
 
 /**
- * @brief Sets the [i][j] cell of the board to the given value.
- * @param board the given board.
- * @param i the row index.
- * @param j the column index.
- * @param val the given value.
+ * @brief applies the given move, created by getBoardMoves(), to the given board and records the
+ * cells it set, including the cells forced by it if propagation is enabled, on the board's trail.
+ * @param node the given board.
+ * @param move the given move.
+ * @return TRUE if the move was applied; FALSE if propagation found it leads to no solution, in
+ * which case the board is unchanged; ERROR if allocation failed.
  */
-void setCell(pBoard board, unsigned int i, unsigned int j, unsigned int val)
+int applyBoardMove(pNode node, Move move)
 {
+    pBoard board = (pBoard)node;
     assert(board != NULL);
-    assert(i >= 0 && i < board->size);
-    assert(j >= 0 && j < board->size);
-    assert(val >= 0 && val <= board->size);
-    assert(board->grid[i][j] == 0);
 
-    board->grid[i][j] = val;
-    if (val)
+    unsigned int numCells = board->size * board->size;
+    if (board->trail == NULL)
     {
-        board->filledCells++;
+        board->trail = (BoardTrail*)malloc(sizeof(BoardTrail) + 3 * numCells * sizeof(uint16_t));
+        if (board->trail == NULL)
+        {
+            fprintf(ERROR_DEST, MALLOC_ERROR);
+            return ERROR;
+        }
+        board->trail->length = 0;
+        board->trail->numMarks = 0;
+        board->trail->marks = board->trail->cells + numCells;
+        board->trail->positions = board->trail->marks + numCells;
+        board->trail->scratch = NULL;
+        board->trail->candidates = NULL;
+        memset(board->trail->positions, 0xff, numCells * sizeof(uint16_t));
+    }
+
+    BoardTrail* trail = board->trail;
+    unsigned int k = (unsigned int)(move >> MOVE_VALUE_BITS);
+    unsigned int val = (unsigned int)(move & ((1u << MOVE_VALUE_BITS) - 1));
+    assert(k < numCells && trail->numMarks < numCells);
+
+    trail->marks[trail->numMarks++] = (uint16_t)trail->length;
+    deduceCell(board, trail, k, val, board->size, board->blockSize);
+    if (board->propagation && !propagate(board, trail))
+    {
+        undoBoardMove(board, move);
+        return FALSE;
     }
+    return TRUE;
 }
 
 /**
- * @brief Checks whether setting the [i][j] cell of the board to the given value would be a legal
- * move.
- * @param board the given board.
- * @param i the row index.
- * @param j the column index.
- * @param val the given value.
- * @return TRUE if the move is legal; FALSE otherwise.
+ * @brief reverts the last move applied to the given board by clearing the cells it set.
+ * @param node the given board.
+ * @param move the given move.
  */
-static int checkCell(pBoard board, unsigned int i, unsigned int j, unsigned int val)
+void undoBoardMove(pNode node, Move move)
 {
-    assert(board != NULL);
-    assert(i >= 0 && i < board->size);
-    assert(j >= 0 && j < board->size);
-    assert(val >= 0 && val <= board->size);
-    assert(board->grid[i][j] == 0);
+    pBoard board = (pBoard)node;
+    assert(board != NULL && board->trail != NULL && board->trail->numMarks > 0);
+    (void)move;
 
-    for (unsigned int k = 0; k < board->size; k++)
+    BoardTrail* trail = board->trail;
+    unsigned int mark = trail->marks[--trail->numMarks];
+    while (trail->length > mark)
     {
-        if (board->grid[i][k] == val)
+        unsigned int k = trail->cells[--trail->length];
+        clearCell(board, k / board->size, k % board->size);
+        if (trail->scratch != NULL)
         {
-            return FALSE;
-        }
-        if (board->grid[k][j] == val)
-        {
-            return FALSE;
+            trail->scratch->numReasons[k] = NOT_CACHED;
         }
     }
+}
+
+/**
+ * @brief return when the given filled cell was set: 0 if it was set before any move was applied,
+ * as the puzzle's clues are, and otherwise its index on the board's trail plus one.
+ * @param board the given board; must have a trail.
+ * @param k the row-major index of the cell.
+ * @return the time.
+ */
+static unsigned int cellTime(pBoard board, unsigned int k)
+{
+    const BoardTrail* trail = board->trail;
+    unsigned int position = trail->positions[k];
+    return position < trail->length && trail->cells[position] == k ? position + 1 : 0;
+}
 
-    unsigned int blockSize = (unsigned int)sqrt(board->size);
-    i -= i % blockSize;
-    j -= j % blockSize;
-    for (unsigned int k = i; k < i + blockSize; k++)
+/**
+ * @brief finds the cells that rule the given values out of the given cell: for each value, the
+ * earliest cell sharing a line with it that holds the value, among the cells set before the
+ * given time.
+ * @param board the given board.
+ * @param k the row-major index of the given cell.
+ * @param values the given values.
+ * @param before the given time, see cellTime().
+ * @param holders for the result: the row-major indices of the cells, with room for the board's
+ * size of them.
+ * @return the number of cells, or ERROR if a value is not ruled out.
+ */
+static int valueHolders(pBoard board, unsigned int k, ValueMask values, unsigned int before,
+                        uint16_t* holders)
+{
+    unsigned int size = board->size, blockSize = board->blockSize;
+    unsigned int i = k / size, j = k % size;
+    unsigned int lines[MASK_KINDS] = {i, size + j, 2 * size + blockIndex(i, j, blockSize)};
+    const Cell* cells = cellsOf(board);
+    //the earliest holder of each value found so far, and its time; a value may be held once in
+    //each of the lines.
+    unsigned int holder[MAX_BOARD_SIZE + 1], earliest[MAX_BOARD_SIZE + 1];
+    for (unsigned int val = 1; val <= size; val++)
+    {
+        earliest[val] = before;
+    }
+    for (unsigned int l = 0; l < MASK_KINDS; l++)
     {
-        for (unsigned int l = j; l < j + blockSize; l++)
+        for (unsigned int t = 0; t < size; t++)
         {
-            if (board->grid[k][l] == val)
+            unsigned int other = lineCell(lines[l], t, size, blockSize);
+            unsigned int val = cells[other];
+            if (val == 0 || !maskHas(&values, val) || other == k)
             {
-                return FALSE;
+                continue;
+            }
+            unsigned int time = cellTime(board, other);
+            if (time < earliest[val])
+            {
+                earliest[val] = time;
+                holder[val] = other;
             }
         }
     }
-    return TRUE;
+
+    int count = 0;
+    while (!maskIsEmpty(&values))
+    {
+        unsigned int val = maskPopFirst(&values);
+        if (earliest[val] == before)
+        {
+            return ERROR;
+        }
+        holders[count++] = (uint16_t)holder[val];
+    }
+    return count;
 }
 
 /**
- * @brief Creates a deep copy of the given board.
- * @param node the given board.
- * @return the new board.
+ * @brief finds the cell that rules the given value out of the given cell: the earliest cell
+ * sharing a line with it that holds the value, among the cells set before the given time;
+ * valueHolders() for a single value, which only scans the lines the value is used in.
+ * @param board the given board.
+ * @param k the row-major index of the given cell.
+ * @param val the given value.
+ * @param before the given time, see cellTime().
+ * @param holder for the result: the row-major index of the cell.
+ * @return TRUE if a cell was found; FALSE otherwise.
  */
-pNode copyBoard(pNode node) const
+static int findHolder(pBoard board, unsigned int k, unsigned int val, unsigned int before,
+                      uint16_t* holder)
 {
-    pBoard board = (pBoard)node;
-    if (board == NULL)
-    {
-        fprintf(ERROR_DEST, POINTER_ERROR);
-        return NULL;
-    }
-    pBoard copyBoard = newBoard(board->size);
-    if (copyBoard == NULL)
-    {
-        return NULL;
-    }
-
-    for (unsigned int i = 0; i < board->size; i++)
+    unsigned int size = board->size, blockSize = board->blockSize;
+    unsigned int i = k / size, j = k % size;
+    unsigned int lines[MASK_KINDS] = {i, size + j, 2 * size + blockIndex(i, j, blockSize)};
+    //the rows', columns' and blocks' masks follow each other, in the order of the lines.
+    const ValueMask* used = rowUsed(board, 0);
+    const Cell* cells = cellsOf(board);
+    unsigned int earliest = before;
+    for (unsigned int l = 0; l < MASK_KINDS; l++)
     {
-        for (unsigned int j = 0; j < board->size; j++)
+        if (!maskHas(&used[lines[l]], val))
+        {
+            continue;
+        }
+        unsigned int t = 0, other = lineCell(lines[l], 0, size, blockSize);
+        while (cells[other] != val)
         {
-            setCell(copyBoard, i, j, board->grid[i][j]);
+            other = lineCell(lines[l], ++t, size, blockSize);
+        }
+        unsigned int time = cellTime(board, other);
+        if (time < earliest)
+        {
+            earliest = time;
+            *holder = (uint16_t)other;
         }
     }
-    return copyBoard;
+    return earliest < before;
 }
 
 /**
- * @brief free the given board from the heap.
- * @param node the given board.
+ * @brief finds the cells that leave the given value no place in the given line but the given
+ * cell: the cells of the line set before the given time, and for each other cell of the line,
+ * a cell ruling the value out of it, see valueHolders().
+ * @param board the given board.
+ * @param line the given line: a row, a column or a block, numbered as by lineCell().
+ * @param k the row-major index of the given cell; UINT_MAX if the value has no place at all.
+ * @param val the given value.
+ * @param before the given time, see cellTime().
+ * @param holders for the result: the row-major indices of the cells, with room for the board's
+ * size of them.
+ * @return the number of cells, or ERROR if the value has another place in the line.
  */
-void freeBoard(pNode node)
+static int lineHolders(pBoard board, unsigned int line, unsigned int k, unsigned int val,
+                       unsigned int before, uint16_t* holders)
 {
-    pBoard board = (pBoard)node;
-    if (board != NULL)
+    const Cell* cells = cellsOf(board);
+    int count = 0;
+    for (unsigned int t = 0; t < board->size; t++)
     {
-        if (board->grid != NULL)
+        unsigned int other = lineCell(line, t, board->size, board->blockSize);
+        if (other == k)
         {
-            for (unsigned int i = 0; i < board-> size; i++)
-            {
-                free(board->grid[i]);
-            }
+            continue;
+        }
+        if (cells[other] != 0 && cellTime(board, other) < before)
+        {
+            holders[count++] = (uint16_t)other;
+        }
+        else if (!findHolder(board, other, val, before, &holders[count++]))
+        {
+            return ERROR;
         }
-        free(board->grid);
     }
-    free(board);
+    return count;
 }
 
 /**
- * return the number of filled (not zero) cells on the board.
- * @param node the given board.
- * @return the number of cells.
+ * @brief adds the given cells to the reasons of the current explanation of the given board.
+ * Cells set before any move was applied are to nobody's blame, and are left out.
+ * @param board the given board; has an explanation scratch.
+ * @param cells the row-major indices of the cells.
+ * @param count the number of cells.
  */
-unsigned int getFilledCells(pNode node)
+static void addReasons(pBoard board, const uint16_t* cells, int count)
 {
-    pBoard board = (pBoard)node;
-    if (board == NULL)
+    ExplanationScratch* scratch = board->trail->scratch;
+    for (int c = 0; c < count; c++)
     {
-        fprintf(ERROR_DEST, POINTER_ERROR);
-        return 0;
+        unsigned int k = cells[c];
+        if (scratch->added[k] != scratch->stamp && cellTime(board, k) > 0)
+        {
+            scratch->added[k] = scratch->stamp;
+            scratch->pending[scratch->numPending++] = (uint16_t)k;
+        }
     }
-    return board->filledCells;
 }
 
 /**
- * @brief find the next empty cell on the board, going left to right from the top,
- * @param board the given board.
- * @param row address for the empty cell's row index.
- * @param column address for the empty cell's column index.
- * @return TRUE if found an empty cell; FALSE otherwise;
+ * @brief replaces the given reason by the reasons it was set for: the move that set it, if it is
+ * the move's own cell, and otherwise the cells that forced it, as a naked single if they rule
+ * out its other values, or as a hidden single of one of its lines.
+ * @param board the given board; has an explanation scratch.
+ * @param k the row-major index of the given reason; a cell set by a move.
+ * @return SUCCESS_EXIT, or ERROR if no reasons were found.
  */
-static int nextEmptyBlock(pBoard board, unsigned int* row, unsigned int* column)
+static int explainReason(pBoard board, unsigned int k)
 {
-    assert(board != NULL);
-    assert(row != NULL && column != NULL);
+    const BoardTrail* trail = board->trail;
+    unsigned int time = cellTime(board, k);
+    //the move that set the cell is the last one whose mark is not after the cell's position.
+    unsigned int low = 0, high = trail->numMarks;
+    while (high - low > 1)
+    {
+        unsigned int middle = (low + high) / 2;
+        if (trail->marks[middle] < time)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    ExplanationScratch* scratch = trail->scratch;
+    if (trail->marks[low] == time - 1)
+    {
+        scratch->blamed[low] = scratch->stamp;
+        return SUCCESS_EXIT;
+    }
+    uint16_t* reasons = scratch->reasons + k * board->size;
+    if (scratch->numReasons[k] != NOT_CACHED)
+    {
+        addReasons(board, reasons, scratch->numReasons[k]);
+        return SUCCESS_EXIT;
+    }
 
-    for (unsigned int i = 0; i < board->size; i++)
+    unsigned int val = cellsOf(board)[k];
+    uint16_t holders[MAX_BOARD_SIZE];
+    ValueMask others = board->allValues;
+    maskRemove(&others, val);
+    int count = valueHolders(board, k, others, time, holders);
+    unsigned int i = k / board->size, j = k % board->size;
+    unsigned int lines[MASK_KINDS] = {i, board->size + j,
+                                      2 * board->size + blockIndex(i, j, board->blockSize)};
+    for (unsigned int l = 0; l < MASK_KINDS && count < 0; l++)
+    {
+        count = lineHolders(board, lines[l], k, val, time, holders);
+    }
+    if (count < 0)
+    {
+        return ERROR;
+    }
+    //the reasons of a cell hold until it is cleared; clues are to nobody's blame, and are dropped.
+    int numReasons = 0;
+    for (int c = 0; c < count; c++)
     {
-        for (unsigned int j = 0; j < board-> size; j++)
+        if (cellTime(board, holders[c]) > 0)
         {
-            if (board->grid[i][j] == 0)
-            {
-                *row = i;
-                *column = j;
-                return TRUE;
-            }
+            reasons[numReasons++] = holders[c];
         }
     }
-    return FALSE;
+    scratch->numReasons[k] = (uint8_t)numReasons;
+    addReasons(board, reasons, numReasons);
+    return SUCCESS_EXIT;
 }
 
 /**
- * @brief constructs all legal permutations of the given board created by setting a value to
- * the given [i][j] cell, and saves them into the given address of an array.
- * @param board the given board.
- * @param children the address of an array; used for the result.
- * @param i the row index
- * @param j the column index
- * @return the number of permutations created; ERROR if allocation failed.
+ * @brief gathers the first reasons of a dead end of the given board: the cells that rule out the
+ * values missing from the cell selected by the branching mode, if rejected is NULL, and
+ * otherwise the cells behind the contradiction propagation finds once the rejected move is
+ * applied again, which is then left applied.
+ * @param board the given board; has an explanation scratch.
+ * @param rejected the rejected move, or NULL.
+ * @return SUCCESS_EXIT, or ERROR if no reasons were found.
  */
-static int assignBoardChildren(pBoard board, pBoard** children, unsigned int i, unsigned int j)
+static int explainDeadEnd(pBoard board, const Move* rejected)
 {
-    assert(*children != NULL);
-    unsigned int count = 0;
-
-    for (unsigned int val = 1; val <= board->size; val++)
+    uint16_t holders[MAX_BOARD_SIZE];
+    int count = 0;
+    if (rejected == NULL)
     {
-        if(checkCell(board, i, j, val))
+        unsigned int i, j;
+        if (selectBlock(board, &i, &j))
         {
-            (*children)[count] = copyBoard(board);
-            if ((*children)[count] == NULL)
+            ValueMask candidates, missing = board->allValues;
+            getCandidates(board, i, j, &candidates);
+            for (unsigned int w = 0; w < MASK_WORDS; w++)
             {
-                fprintf(ERROR_DEST, MALLOC_ERROR);
-                for (unsigned int k = 0; k < count; k++)
-                {
-                    freeBoard((*children)[k]);
-                }
-                free(*children);
-                return ERROR;
+                missing.words[w] &= ~candidates.words[w];
             }
-            setCell((*children)[count], i, j, val);
-            count++;
+            count = valueHolders(board, i * board->size + j, missing, UINT_MAX, holders);
         }
     }
-    return count;
+    else
+    {
+        BoardTrail* trail = board->trail;
+        unsigned int k = (unsigned int)(*rejected >> MOVE_VALUE_BITS);
+        unsigned int val = (unsigned int)(*rejected & ((1u << MOVE_VALUE_BITS) - 1));
+        trail->marks[trail->numMarks++] = (uint16_t)trail->length;
+        deduceCell(board, trail, k, val, board->size, board->blockSize);
+        //propagation repeats itself, unless it ran out of memory the first time.
+        if (!board->propagation || propagate(board, trail))
+        {
+            return ERROR;
+        }
+        const BoardConflict* conflict = &board->conflict;
+        count = conflict->val == 0 ?
+                valueHolders(board, conflict->cell, board->allValues, UINT_MAX, holders) :
+                lineHolders(board, conflict->line, UINT_MAX, conflict->val, UINT_MAX, holders);
+    }
+    if (count < 0)
+    {
+        return ERROR;
+    }
+    addReasons(board, holders, count);
+    return SUCCESS_EXIT;
 }
 
 /**
- * @brief constructs all legal permutations of the given board created by setting a value to
- * the next empty cell, and saves them into the given address of an array.
- * @param node the given board
- * @param nodeChildren the address of an array; used for the result.
- * @return the number of permutations created or ERROR.
+ * @brief starts a new explanation of the given board, allocating its scratch space the first
+ * time.
+ * @param board the given board; has a trail.
+ * @return the scratch space, or NULL if allocation failed.
  */
-int getBoardChildren(pNode node, pNode** nodeChildren /*for the result*/)
+static ExplanationScratch* startExplanation(pBoard board)
 {
+    unsigned int numCells = board->size * board->size;
+    ExplanationScratch* scratch = board->trail->scratch;
+    if (scratch == NULL)
+    {
+        scratch = (ExplanationScratch*)calloc(1, sizeof(ExplanationScratch) +
+                                              2 * numCells * sizeof(unsigned int) +
+                                              (1 + board->size) * numCells * sizeof(uint16_t) +
+                                              numCells * sizeof(uint8_t));
+        if (scratch == NULL)
+        {
+            return NULL;
+        }
+        scratch->added = (unsigned int*)(scratch + 1);
+        scratch->blamed = scratch->added + numCells;
+        scratch->pending = (uint16_t*)(scratch->blamed + numCells);
+        scratch->reasons = scratch->pending + numCells;
+        scratch->numReasons = (uint8_t*)(scratch->reasons + board->size * numCells);
+        memset(scratch->numReasons, NOT_CACHED, numCells * sizeof(uint8_t));
+        board->trail->scratch = scratch;
+    }
+    //once the stamps wrap around, the entries left with old stamps are cleared.
+    if (++scratch->stamp == 0)
+    {
+        memset(scratch->added, 0, 2 * numCells * sizeof(unsigned int));
+        scratch->stamp = 1;
+    }
+    scratch->numPending = 0;
+    return scratch;
+}
 
+int explainBoardConflict(pNode node, const Move* rejected, unsigned int* ages
+                         /*for the result*/, unsigned int maxAge)
+{
     pBoard board = (pBoard)node;
-    pBoard** children = (pBoard**)nodeChildren;
-    if (board == NULL || children == NULL)
+    if (board == NULL || ages == NULL)
     {
         fprintf(ERROR_DEST, POINTER_ERROR);
         return ERROR;
     }
-
-    unsigned int i, j;
-    int result = nextEmptyBlock(board, &i, &j);
-    if (!result)
+    //a board no move was applied to, in place, has nobody to blame.
+    if (board->trail == NULL)
     {
         return 0;
     }
-
-    *children = (pBoard*)malloc(board->size * sizeof(pBoard));
-    if (*children == NULL)
+    ExplanationScratch* scratch = startExplanation(board);
+    if (scratch == NULL)
     {
         fprintf(ERROR_DEST, MALLOC_ERROR);
         return ERROR;
     }
 
-    return assignBoardChildren(board, children, i, j);
+    unsigned int numMarks = board->trail->numMarks;
+    int rc = explainDeadEnd(board, rejected);
+    while (rc == SUCCESS_EXIT && scratch->numPending > 0)
+    {
+        rc = explainReason(board, scratch->pending[--scratch->numPending]);
+    }
+    if (rejected != NULL && board->trail->numMarks > numMarks)
+    {
+        undoBoardMove(board, *rejected);
+    }
+
+    //the rejected move itself, if any, is the one after the last applied move.
+    int count = 0;
+    for (unsigned int m = numMarks > maxAge ? numMarks - maxAge : 0;
+         rc == SUCCESS_EXIT && m < numMarks; m++)
+    {
+        if (scratch->blamed[m] == scratch->stamp)
+        {
+            ages[count++] = numMarks - m;
+        }
+    }
+    return rc == SUCCESS_EXIT ? count : ERROR;
+}
+
+/**
+ * @brief sets the rule choosing the cell to branch on for the given board and the boards
+ * constructed from it.
+ * @param board the given board.
+ * @param mode the given branching mode.
+ */
+void setBranchingMode(pBoard board, BranchingMode mode)
+{
+    assert(board != NULL);
+    board->branching = mode;
+}
+
+/**
+ * @brief sets whether the children of the given board, and of the boards constructed from it,
+ * get their forced cells filled before they are returned.
+ * @param board the given board.
+ * @param enabled TRUE to enable propagation; FALSE to disable it.
+ */
+void setPropagation(pBoard board, int enabled)
+{
+    assert(board != NULL);
+    board->propagation = enabled;
+}
+
+/**
+ * @brief sets the order the children of the given board, and of the boards constructed from it,
+ * try the values of the cell they branch on in.
+ * @param board the given board.
+ * @param ordering the given value ordering.
+ * @param seed the seed of RANDOM_ORDERING.
+ */
+void setValueOrdering(pBoard board, ValueOrdering ordering, unsigned long long seed)
+{
+    assert(board != NULL);
+    board->ordering = ordering;
+    board->seed = seed;
+    board->run = 0;
+}
+
+/**
+ * @brief mixes the given run of a restarting search into the random value order of the given
+ * board and of the boards constructed from it.
+ * @param node the given board.
+ * @param run the given run.
+ */
+void restartBoard(pNode node, unsigned int run)
+{
+    assert(node != NULL);
+    ((pBoard)node)->run = run;
 }
 
 /**
@@ -336,5 +2100,5 @@ unsigned int getSize(pBoard board)
  */
 unsigned int getCellValue(pBoard board, unsigned int i, unsigned int j)
 {
-    return board->grid[i][j];
+    return cellsOf(board)[i * board->size + j];
 }
@@ -1,6 +1,8 @@
 #ifndef EX3_SUDOKUTREE_H
 #define EX3_SUDOKUTREE_H
 
+#include "GenericDFS.h"
+
 // -------------------------- macros -------------------------
 
 //-----boolean values
@@ -20,6 +22,9 @@
 //error message destination
 #define ERROR_DEST stderr
 
+//max size of board.
+#define MAX_BOARD_SIZE 100
+
 // -------------------------- structs & typedef -------------------------
 
 /**
@@ -33,9 +38,29 @@ typedef struct SudokuBoard Board;
 typedef Board* pBoard;
 
 /**
- * @brief a void pointer
+ * @brief The rule choosing the empty cell whose values a board's children assign.
+ */
+typedef enum BranchingMode
+{
+    //the first empty cell, going left to right from the top.
+    FIRST_EMPTY_BRANCHING,
+    //the empty cell with the fewest legal values.
+    MIN_REMAINING_BRANCHING
+} BranchingMode;
+
+/**
+ * @brief The order a board's children try the values of the cell they branch on in.
  */
-typedef void* pNode;
+typedef enum ValueOrdering
+{
+    //ascending values.
+    ASCENDING_ORDERING,
+    //the values ruling out the fewest candidates of the empty cells sharing a line with the cell
+    //first; ties in ascending order.
+    LEAST_CONSTRAINING_ORDERING,
+    //a pseudo random order, drawn from the board's cells and a seed.
+    RANDOM_ORDERING
+} ValueOrdering;
 
 // -------------------------- functions -------------------------
 
@@ -71,15 +96,130 @@ unsigned int getSize(pBoard board);
  */
 unsigned int getCellValue(pBoard board, unsigned int i, unsigned int j);
 
+/**
+ * @brief sets the rule choosing the cell to branch on for the given board and the boards
+ * constructed from it. New boards use FIRST_EMPTY_BRANCHING.
+ * @param board the given board.
+ * @param mode the given branching mode.
+ */
+void setBranchingMode(pBoard board, BranchingMode mode);
+
+/**
+ * @brief sets whether the children of the given board, and of the boards constructed from it,
+ * get their forced cells filled before they are returned: cells with a single legal value and
+ * cells that are the only place left for a value in their row, column or block are filled until
+ * none are left, and children found to have no solution on the way are dropped.
+ * New boards have propagation enabled.
+ * @param board the given board.
+ * @param enabled TRUE to enable propagation; FALSE to disable it.
+ */
+void setPropagation(pBoard board, int enabled);
+
+/**
+ * @brief sets the order the children of the given board, and of the boards constructed from it,
+ * try the values of the cell they branch on in. A random order depends on the board's cells, the
+ * seed and the run set by restartBoard() alone, so a search visits the same boards in the same
+ * order every time, whether it applies moves in place or constructs children. New boards use
+ * ASCENDING_ORDERING.
+ * @param board the given board.
+ * @param ordering the given value ordering.
+ * @param seed the seed of RANDOM_ORDERING; ignored by the other orderings.
+ */
+void setValueOrdering(pBoard board, ValueOrdering ordering, unsigned long long seed);
+
+/**
+ * @brief mixes the given run of a restarting search into the random value order of the given
+ * board and of the boards constructed from it, so that every run tries the values in another
+ * order; a restartNodeFunc for setDfsRestarts(). Run 0 gives the order of the seed alone.
+ * @param node the given board.
+ * @param run the given run.
+ */
+void restartBoard(pNode node, unsigned int run);
+
 /**
  * @brief constructs all legal permutations of the given board created by setting a value to
- * the next empty cell, and saves them into the given address of an array.
+ * the empty cell selected by the board's branching mode, and saves them into the given address
+ * of an array, in the order of the board's value ordering. If propagation is enabled, the
+ * permutations it finds have no solution are left out, so on a board without a solution the
+ * fullest board a search finds depends on the propagation; only a full board is meaningful.
  * @param node the given board
  * @param nodeChildren the address of an array; used for the result.
  * @return the number of permutations created or ERROR.
  */
 int getBoardChildren(pNode node, pNode** nodeChildren /*for the result*/);
 
+/**
+ * @brief constructs the next legal permutation of the given board created by setting a value to
+ * the empty cell selected by the board's branching mode, in the order getBoardChildren() returns
+ * them; a getNextChildFunc for getBestLazy().
+ * @param node the given board.
+ * @param cursor the given cursor, zeroed before the first call for the board.
+ * @param child for the result: the new board.
+ * @return TRUE if a board was created; FALSE if no values are left; ERROR if allocation failed.
+ */
+int getNextBoardChild(pNode node, unsigned long long* cursor, pNode* child /*for the result*/);
+
+/**
+ * @brief writes the moves setting each legal value to the empty cell selected by the board's
+ * branching mode into the given array, which must have room for the board's size moves, in the
+ * order of the board's value ordering. A move holds the cell's row-major index and the value.
+ * @param node the given board.
+ * @param moves the given array; used for the result.
+ * @return the number of moves or ERROR.
+ */
+int getBoardMoves(pNode node, Move* moves /*for the result*/);
+
+/**
+ * @brief applies the given move, created by getBoardMoves(), to the given board in place, along
+ * with the cells it forces if propagation is enabled. Moves propagation finds have no solution
+ * are rejected, like the permutations getBoardChildren() leaves out.
+ * @param node the given board.
+ * @param move the given move.
+ * @return TRUE if the move was applied; FALSE if propagation found it leads to no solution, in
+ * which case the board is unchanged; ERROR if allocation failed.
+ */
+int applyBoardMove(pNode node, Move move);
+
+/**
+ * @brief reverts the last move applied to the given board.
+ * @param node the given board.
+ * @param move the given move.
+ */
+void undoBoardMove(pNode node, Move move);
+
+/**
+ * @brief explains a dead end of an in-place search of the given board, see explainConflictFunc:
+ * the moves to blame for the values the cell selected by the board's branching mode cannot take,
+ * if rejected is NULL, or for the contradiction propagation finds after the rejected move. Cells
+ * forced by propagation are traced back to the moves that forced them, through the cells that
+ * ruled out their other values, or the other places of their value in a line.
+ * @param node the given board; back in its current state when the function returns.
+ * @param rejected the move applyBoardMove() just rejected, or NULL.
+ * @param ages for the result: the ages of the moves.
+ * @param maxAge the number of moves applied to the board by the search.
+ * @return the number of ages written, or ERROR if the dead end cannot be explained or allocation
+ * failed.
+ */
+int explainBoardConflict(pNode node, const Move* rejected, unsigned int* ages
+                         /*for the result*/, unsigned int maxAge);
+
+/**
+ * @brief return the Zobrist hash of the given board, which depends on its cells alone; a
+ * hashNodeFunc for setDfsHashing(). It is updated as cells are set, so it takes constant time.
+ * @param node the given board.
+ * @return the hash.
+ */
+unsigned long long hashBoard(pNode node);
+
+/**
+ * @brief return whether the given boards have the same size and cells; an equalNodeFunc for
+ * setDfsHashing().
+ * @param node the given board.
+ * @param other the other board.
+ * @return TRUE if the boards are equal; FALSE otherwise.
+ */
+int equalBoards(pNode node, pNode other);
+
 /**
  * return the number of filled (not zero) cells on the board.
  * @param node the given board.
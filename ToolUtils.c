@@ -0,0 +1,61 @@
+// -------------------------- includes -------------------------
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "ToolUtils.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+
+// -------------------------- macros -------------------------
+
+//true.
+#define TRUE 1
+//false.
+#define FALSE 0
+
+//base of numeric arguments.
+#define DECIMAL 10
+//nanoseconds per second.
+#define NANOS 1e9
+
+// -------------------------- functions -------------------------
+
+int parseNumber(const char* arg, unsigned long long max, unsigned long long* result)
+{
+    if (arg == NULL || *arg < '0' || *arg > '9')
+    {
+        return FALSE;
+    }
+    char* end;
+    errno = 0;
+    *result = strtoull(arg, &end, DECIMAL);
+    //a number past ULLONG_MAX is read as ULLONG_MAX, with errno set to tell them apart.
+    return *end == '\0' && errno != ERANGE && *result <= max;
+}
+
+double secondsSince(const struct timespec* start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / NANOS;
+}
+
+int writeAll(int socket, const char* text, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t written = send(socket, text, length, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written <= 0)
+        {
+            return FALSE;
+        }
+        text += written;
+        length -= (size_t)written;
+    }
+    return TRUE;
+}
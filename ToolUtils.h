@@ -0,0 +1,36 @@
+#ifndef EX3_TOOLUTILS_H
+#define EX3_TOOLUTILS_H
+
+#include <stddef.h>
+#include <time.h>
+
+// -------------------------- functions -------------------------
+
+/**
+ * @brief parse the given argument as a whole number no larger than the given maximum; numbers
+ * too large for an unsigned long long are rejected.
+ * @param arg the given argument; may be NULL.
+ * @param max the largest allowed value.
+ * @param result for the result: the parsed number.
+ * @return TRUE if the argument is a valid number; FALSE otherwise.
+ */
+int parseNumber(const char* arg, unsigned long long max, unsigned long long* result);
+
+/**
+ * @brief return the number of seconds from the given CLOCK_MONOTONIC time to now.
+ * @param start the given time.
+ * @return the number of seconds.
+ */
+double secondsSince(const struct timespec* start);
+
+/**
+ * @brief writes the given bytes to the given socket. A peer gone away fails the write rather than
+ * raising SIGPIPE.
+ * @param socket the given socket.
+ * @param text the given bytes.
+ * @param length the number of bytes.
+ * @return TRUE if every byte was written; FALSE otherwise.
+ */
+int writeAll(int socket, const char* text, size_t length);
+
+#endif //EX3_TOOLUTILS_H
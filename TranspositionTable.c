@@ -0,0 +1,171 @@
+// -------------------------- includes -------------------------
+
+#include "GenericDFSInternal.h"
+#include <stdlib.h>
+
+// -------------------------- macros -------------------------
+
+//number of consecutive slots, starting at the one its hash points to, a subtree may take.
+#define TABLE_PROBES 8
+
+// -------------------------- structs -------------------------
+
+/**
+ * @brief A subtree recorded in a table: a copy of its root, and the root's hash.
+ */
+typedef struct TableEntry
+{
+    unsigned long long hash;
+    pNode node;
+} TableEntry;
+
+/**
+ * @brief An open addressing table of recorded subtrees. A slot is empty until an entry is
+ * published into it with an atomic compare and swap, after which it never changes, so readers
+ * need no locks; the entries are only released with the table.
+ */
+struct TranspositionTable
+{
+    hashNodeFunc hashNode;
+    equalNodeFunc equalNode;
+    copyNodeFunc copy;
+    freeNodeFunc freeNode;
+    //the number of slots, a power of two, minus one.
+    size_t mask;
+    TableEntry** slots;
+};
+
+// -------------------------- functions -------------------------
+
+int newTable(copyNodeFunc copy, freeNodeFunc freeNode, TranspositionTable** table)
+{
+    const DfsHashing* hashing = getActiveHashing();
+    *table = NULL;
+    if (hashing == NULL || hashing->hashNode == NULL || hashing->equalNode == NULL ||
+        hashing->capacity == 0)
+    {
+        return SUCCESS_EXIT;
+    }
+
+    size_t slots = 1;
+    while (slots < hashing->capacity)
+    {
+        slots *= 2;
+    }
+    TranspositionTable* created = (TranspositionTable*)malloc(sizeof(TranspositionTable));
+    TableEntry** entries = (TableEntry**)calloc(slots, sizeof(TableEntry*));
+    if (created == NULL || entries == NULL)
+    {
+        free(created);
+        free(entries);
+        return ERROR;
+    }
+    created->hashNode = hashing->hashNode;
+    created->equalNode = hashing->equalNode;
+    created->copy = copy;
+    created->freeNode = freeNode;
+    created->mask = slots - 1;
+    created->slots = entries;
+    *table = created;
+    return SUCCESS_EXIT;
+}
+
+void freeTable(TranspositionTable* table)
+{
+    if (table == NULL)
+    {
+        return;
+    }
+    for (size_t i = 0; i <= table->mask; i++)
+    {
+        if (table->slots[i] != NULL)
+        {
+            table->freeNode(table->slots[i]->node);
+            free(table->slots[i]);
+        }
+    }
+    free(table->slots);
+    free(table);
+}
+
+/**
+ * @brief return the entry in the given slot of the given table.
+ * @param table the given table.
+ * @param index the slot's index, taken modulo the number of slots.
+ * @return the entry, or NULL if the slot is empty.
+ */
+static inline TableEntry* loadSlot(TranspositionTable* table, size_t index)
+{
+    return __atomic_load_n(&table->slots[index & table->mask], __ATOMIC_ACQUIRE);
+}
+
+int isDeadNode(TranspositionTable* table, pNode node)
+{
+    if (table == NULL)
+    {
+        return FALSE;
+    }
+    unsigned long long hash = table->hashNode(node);
+    for (size_t probe = 0; probe < TABLE_PROBES; probe++)
+    {
+        TableEntry* entry = loadSlot(table, (size_t)hash + probe);
+        if (entry == NULL)
+        {
+            //slots are filled in probing order, so the node would have been found before.
+            return FALSE;
+        }
+        if (entry->hash == hash && table->equalNode(entry->node, node))
+        {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+void addDeadNode(TranspositionTable* table, pNode node)
+{
+    if (table == NULL)
+    {
+        return;
+    }
+    unsigned long long hash = table->hashNode(node);
+    TableEntry* added = NULL;
+    for (size_t probe = 0; probe < TABLE_PROBES; probe++)
+    {
+        size_t index = ((size_t)hash + probe) & table->mask;
+        TableEntry* entry = loadSlot(table, index);
+        if (entry == NULL)
+        {
+            if (added == NULL)
+            {
+                //the copy outlives the arenas of the search's threads, so it is made outside them.
+                added = (TableEntry*)malloc(sizeof(TableEntry));
+                NodeArena* arena = swapActiveArena(NULL);
+                pNode copy = added != NULL ? table->copy(node) : NULL;
+                swapActiveArena(arena);
+                if (copy == NULL)
+                {
+                    free(added);
+                    return;
+                }
+                added->hash = hash;
+                added->node = copy;
+            }
+            if (__atomic_compare_exchange_n(&table->slots[index], &entry, added, FALSE,
+                                            __ATOMIC_RELEASE, __ATOMIC_ACQUIRE))
+            {
+                return;
+            }
+            //another thread filled the slot first; entry now holds its entry.
+        }
+        if (entry->hash == hash && table->equalNode(entry->node, node))
+        {
+            break;
+        }
+    }
+    if (added != NULL)
+    {
+        table->freeNode(added->node);
+        free(added);
+    }
+}